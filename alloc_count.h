@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocation counting for the per-frame paths.
+//
+// alloc_count.cpp replaces the global operator new/delete, aligned overloads included,
+// with malloc/free plus a thread-local counter, so a thread can measure what it
+// allocated itself between two points. Only C++ allocations are seen; GLib/GStreamer
+// and hiredis use malloc directly.
+
+uint64_t thread_alloc_count();
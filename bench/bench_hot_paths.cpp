@@ -0,0 +1,355 @@
+// Micro-benchmarks for the per-frame work in appsrc_feeder (feeder_core).
+//
+// Run:     ./feeder_microbench --benchmark_out=bench/baseline_hot_paths.json --benchmark_out_format=json
+//              "--benchmark_context=build_type=Release,compiler=g++ 12.2.0,cxx_flags=-O3 -DNDEBUG -Wall -Wextra -Wpedantic,feeder_core=static,filesystem=tmpfs"
+//          The whole suite in one run; the baseline is never spliced from separate runs.
+// Compare: tools/compare.py benchmarks bench/baseline_hot_paths.json new.json   (from google/benchmark)
+
+#include <benchmark/benchmark.h>
+
+#include "feeder_core.h"
+#include "frame_arena.h"
+#include "frame_stats.h"
+#include "trace_ring.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Temp folder with one frame file per benchmarked size, created once
+struct FrameFiles {
+    fs::path dir;
+    FrameFiles() {
+        dir = fs::temp_directory_path() / "feeder_microbench";
+        fs::create_directories(dir);
+        std::mt19937 rng(1);
+        for (size_t kb : {16, 150, 300}) {
+            std::vector<char> data(kb * 1024);
+            for (auto& c : data) c = static_cast<char>(rng());
+            std::ofstream(path(kb), std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+    }
+    ~FrameFiles() {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+    fs::path path(size_t kb) const { return dir / make_frame_filename("camera01", kb); }
+};
+
+const FrameFiles& files() {
+    static FrameFiles f;
+    return f;
+}
+
+// Metadata as stored in DragonflyDB for one frame
+const std::string SAMPLE_JSON =
+    "{\"ball\":4,\"frame_name\":\"frame_camera01_002379123\",\"innings\":1,\"isStart\":false,"
+    "\"matchID\":\"M20240817\",\"over\":12,\"ptp_timestamp\":\"1723890123.123456789\","
+    "\"received_at\":\"2024-08-17T10:22:03.123Z\"}";
+
+// Keyframe laid out like the cameras send it: VPS, SPS, PPS, IDR slice
+std::vector<uint8_t> sample_keyframe(size_t size) {
+    const uint8_t head[] = {
+        0, 0, 0, 1, 0x40, 0x01, 0x0c, 0x01, 0xff, 0xff, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0x90,
+        0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x78, 0x95, 0x98, 0x09,
+        0, 0, 0, 1, 0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0x90, 0x00, 0x00, 0x03,
+        0x00, 0x00, 0x03, 0x00, 0x78, 0xa0, 0x03, 0xc0, 0x80, 0x10, 0xe5, 0x96, 0x66, 0x69, 0x24,
+        0xca, 0xe0, 0x10, 0x00, 0x00, 0x03, 0x00, 0x10, 0x00, 0x00, 0x03, 0x01, 0xe0, 0x80,
+        0, 0, 0, 1, 0x44, 0x01, 0xc1, 0x72, 0xb4, 0x62, 0x40,
+        0, 0, 0, 1, 0x26, 0x01, 0xaf};
+    std::vector<uint8_t> f(head, head + sizeof(head));
+    std::mt19937 rng(2);
+    while (f.size() < size) f.push_back(static_cast<uint8_t>(0x80 | (rng() & 0x7f)));
+    return f;
+}
+
+} // namespace
+
+static void BM_MakeFrameFilename(benchmark::State& state) {
+    uint64_t idx = 2379000;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(make_frame_filename("camera01", idx++));
+    }
+}
+BENCHMARK(BM_MakeFrameFilename);
+
+// What feed_frames does now: rewrite the index digits of a prebuilt path
+static void BM_FramePathTemplate(benchmark::State& state) {
+    FramePathTemplate paths(files().dir.string(), "camera01");
+    uint64_t idx = 2379000;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(paths.at(idx++).data());
+    }
+}
+BENCHMARK(BM_FramePathTemplate);
+
+// Default arguments sleep at least one 2 ms poll; delay 0 isolates the stat calls
+static void BM_IsFileReady(benchmark::State& state) {
+    fs::path p = files().path(150);
+    int delay_ms = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(is_file_ready(p, 5, delay_ms));
+    }
+}
+BENCHMARK(BM_IsFileReady)->Arg(0)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+static void BM_IsIframe(benchmark::State& state) {
+    fs::path p = files().path(150);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(is_iframe(p));
+    }
+}
+BENCHMARK(BM_IsIframe)->Unit(benchmark::kMicrosecond);
+
+static void BM_IsIframeStat(benchmark::State& state) {
+    std::string p = files().path(150).string();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(is_iframe(p.c_str()));
+    }
+}
+BENCHMARK(BM_IsIframeStat)->Unit(benchmark::kMicrosecond);
+
+// read_frame_file + the memcpy into the (here: plain) output buffer, per frame size in KB
+static void BM_ReadFrameAndCopy(benchmark::State& state) {
+    size_t kb = static_cast<size_t>(state.range(0));
+    fs::path p = files().path(kb);
+    std::vector<uint8_t> out(kb * 1024);
+    for (auto _ : state) {
+        std::vector<uint8_t> data;
+        if (read_frame_file(p, data) != FRAME_READ_OK) state.SkipWithError("read failed");
+        memcpy(out.data(), data.data(), data.size());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(kb * 1024));
+}
+BENCHMARK(BM_ReadFrameAndCopy)->Arg(16)->Arg(150)->Arg(300)->Unit(benchmark::kMicrosecond);
+
+// What feed_frames does now: read straight into the (pooled) output buffer
+static void BM_ReadFrameInto(benchmark::State& state) {
+    size_t kb = static_cast<size_t>(state.range(0));
+    std::string p = files().path(kb).string();
+    std::vector<uint8_t> out(512 * 1024);
+    for (auto _ : state) {
+        size_t size = 0;
+        if (read_frame_into(p.c_str(), out.data(), out.size(), size) != FRAME_READ_OK) state.SkipWithError("read failed");
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(kb * 1024));
+}
+BENCHMARK(BM_ReadFrameInto)->Arg(16)->Arg(150)->Arg(300)->Unit(benchmark::kMicrosecond);
+
+// --huge-pages: the same read cycling through 128 arena chunks (range 1) vs 128 plain
+// heap chunks of the same size (range 0), as frames cycle through the pool in the feeder
+static void BM_ReadFrameIntoChunks(benchmark::State& state) {
+    std::string p = files().path(300).string();
+    const size_t chunk = 512 * 1024, count = 128;
+    FrameArena arena;
+    std::vector<std::vector<uint8_t>> heap;
+    std::vector<uint8_t*> chunks;
+    if (state.range(0)) {
+        arena.init(chunk, count);
+        for (size_t i = 0; i < count; ++i) chunks.push_back(arena.acquire());
+        state.SetLabel(arena.report());
+    } else {
+        for (size_t i = 0; i < count; ++i) chunks.push_back(heap.emplace_back(chunk).data());
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        size_t size = 0;
+        if (read_frame_into(p.c_str(), chunks[i++ % count], chunk, size) != FRAME_READ_OK) state.SkipWithError("read failed");
+        benchmark::ClobberMemory();
+    }
+    for (uint8_t* c : chunks) if (state.range(0)) arena.release(c);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * 300 * 1024);
+}
+BENCHMARK(BM_ReadFrameIntoChunks)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void BM_JsonExtractOne(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(json_extract(SAMPLE_JSON, "received_at"));
+    }
+}
+BENCHMARK(BM_JsonExtractOne);
+
+// All eight fields, as video_probe does per frame (reused FrameMetadata)
+static void BM_ParseFrameMetadata(benchmark::State& state) {
+    FrameMetadata md;
+    for (auto _ : state) {
+        md.reset();
+        parse_frame_metadata(SAMPLE_JSON, md);
+        benchmark::DoNotOptimize(md);
+    }
+}
+BENCHMARK(BM_ParseFrameMetadata);
+
+static void BM_VideoCsvRow(benchmark::State& state) {
+    FrameMetadata md;
+    parse_frame_metadata(SAMPLE_JSON, md);
+    std::string fname = make_frame_filename("camera01", 2379123);
+    std::ostringstream os;
+    uint64_t seq = 0;
+    for (auto _ : state) {
+        write_video_csv_row(os, seq, true, seq * 300, fname, md);
+        if (++seq % 4096 == 0) os.str(std::string());   // keep the stream small
+    }
+}
+BENCHMARK(BM_VideoCsvRow);
+
+static void BM_SummaryCsvRow(benchmark::State& state) {
+    FrameMetadata md;
+    parse_frame_metadata(SAMPLE_JSON, md);
+    std::ostringstream os;
+    uint64_t seq = 0;
+    for (auto _ : state) {
+        write_summary_csv_row(os, seq, seq * 300, md);
+        if (++seq % 4096 == 0) os.str(std::string());
+    }
+}
+BENCHMARK(BM_SummaryCsvRow);
+
+static void BM_AudioCsvRow(benchmark::State& state) {
+    std::ostringstream os;
+    uint64_t idx = 0;
+    for (auto _ : state) {
+        write_audio_csv_row(os, idx, idx * 225);
+        if (++idx % 4096 == 0) os.str(std::string());
+    }
+}
+BENCHMARK(BM_AudioCsvRow);
+
+// --no-parse fast path: header scan of one access unit
+static void BM_ScanHevcAu(benchmark::State& state) {
+    std::vector<uint8_t> f = sample_keyframe(static_cast<size_t>(state.range(0)) * 1024);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(scan_hevc_au(f.data(), f.size()));
+    }
+}
+BENCHMARK(BM_ScanHevcAu)->Arg(150);
+
+// --crc: CRC32C of one frame, the AU tail check and the duplicate lookup; bytes/s should be near memory bandwidth
+static void BM_Crc32cFrame(benchmark::State& state) {
+    std::vector<uint8_t> f = sample_keyframe(static_cast<size_t>(state.range(0)) * 1024);
+    RecentPayloads recent;
+    uint64_t idx = 0, first = 0;
+    for (auto _ : state) {
+        uint32_t crc = crc32c(f.data(), f.size());
+        benchmark::DoNotOptimize(hevc_au_tail(f.data(), f.size()));
+        benchmark::DoNotOptimize(recent.seen(crc, f.size() + idx, idx, first));
+        ++idx;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(f.size()));
+    state.SetLabel(crc32c_impl());
+}
+BENCHMARK(BM_Crc32cFrame)->Arg(150)->Arg(300)->Unit(benchmark::kMicrosecond);
+
+// Stream analytics per frame; one call in fps also rolls the window (mean / p99 over the rings)
+static void BM_FrameStatsObserve(benchmark::State& state) {
+    FrameStats stats;
+    stats.configure(25, FrameStatsConfig{}, nullptr);
+    uint64_t idx = 0;
+    int64_t t = 0;
+    for (auto _ : state) {
+        stats.observe(idx, 150 * 1024 + (idx & 1023), idx % 5 == 0, t);
+        ++idx;
+        t += 40000000;
+    }
+}
+BENCHMARK(BM_FrameStatsObserve);
+
+// --trace: every mark one frame gets from file to disk, plus its histogram update.
+// Target < 1% of the frame interval, i.e. < 33 us per frame at 300 fps; the GstMeta
+// lookup in the queue1 probe is not included
+static void BM_TraceFrame(benchmark::State& state) {
+    trace_enable(true);
+    uint64_t seq = 0;
+    for (auto _ : state) {
+        trace_mark(seq, STAGE_APPEAR);
+        trace_mark(seq, STAGE_READY);
+        trace_mark(seq, STAGE_READ);
+        trace_mark(seq, STAGE_PUSHED);
+        trace_mark(seq, STAGE_PARSED);
+        trace_mux_input(seq);
+        trace_mux_output(1);
+        trace_written();
+        ++seq;
+    }
+    trace_enable(false);
+}
+BENCHMARK(BM_TraceFrame);
+
+// --trace: the mux output probe looks for video PES starts in every TS packet; one
+// 150 KB frame is ~820 packets, the first starting the PES
+static void BM_TraceMuxScan(benchmark::State& state) {
+    std::vector<uint8_t> ts(820 * 188, 0xff);
+    for (size_t at = 0; at < ts.size(); at += 188) {
+        ts[at] = 0x47;
+        ts[at + 1] = at ? 0x00 : 0x40;
+        ts[at + 2] = 0x41;
+        ts[at + 3] = 0x10;
+    }
+    const uint8_t pes[] = {0, 0, 1, 0xe0};
+    std::memcpy(&ts[4], pes, sizeof(pes));
+    for (auto _ : state) benchmark::DoNotOptimize(ts_video_pes_starts(ts.data(), ts.size()));
+}
+BENCHMARK(BM_TraceMuxScan);
+
+// Frames/s ceiling of the file path outside GStreamer: everything the feeder thread and
+// the video probe do for one 150 KB keyframe, back to back and unpaced, in wall time.
+// Range 0: --crc on; range 1: is_file_ready's delay in ms (2, the feeder's, sleeps once
+// per frame). The pipeline (h265parse, mpegtsmux, filesink) comes on top;
+// bench/run_ceiling.sh measures the whole feeder.
+static void BM_FeedPathFrame(benchmark::State& state) {
+    const bool crc = state.range(0) != 0;
+    const int ready_delay_ms = static_cast<int>(state.range(1));
+    fs::path dir = files().dir / "feed_path";
+    fs::create_directories(dir);
+    std::vector<uint8_t> f = sample_keyframe(150 * 1024);
+    const uint64_t first = 2379000, count = 64;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::ofstream(dir / make_frame_filename("camera01", first + i), std::ios::binary)
+            .write(reinterpret_cast<const char*>(f.data()), static_cast<std::streamsize>(f.size()));
+    }
+    FramePathTemplate paths(dir.string(), "camera01");
+    std::vector<uint8_t> buffer(512 * 1024);
+    FrameMetadata md;
+    RecentPayloads recent;
+    std::ofstream csv(dir / "out.csv"), summary(dir / "summary.csv");
+    uint64_t seq = 0, dup = 0;
+    for (auto _ : state) {
+        const std::string& path = paths.at(first + seq % count);
+        size_t size = 0;
+        if (!is_file_ready(path.c_str(), 5, ready_delay_ms) ||
+            read_frame_into(path.c_str(), buffer.data(), buffer.size(), size) != FRAME_READ_OK) {
+            state.SkipWithError("read failed");
+            break;
+        }
+        AuInfo au = scan_hevc_au(buffer.data(), size);
+        benchmark::DoNotOptimize(au);
+        if (crc) {
+            uint32_t c32 = crc32c(buffer.data(), size);
+            benchmark::DoNotOptimize(hevc_au_tail(buffer.data(), size));
+            benchmark::DoNotOptimize(recent.seen(c32, size + seq, seq, dup));
+        }
+        md.reset();
+        parse_frame_metadata(SAMPLE_JSON, md);
+        write_video_csv_row(csv, seq, true, seq * 300, paths.name(), md);
+        csv.flush();
+        if (seq % 1800 == 0) {
+            write_summary_csv_row(summary, seq, seq * 300, md);
+            summary.flush();
+        }
+        ++seq;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetLabel(std::string(crc ? "--crc, " : "") + "ready delay " + std::to_string(ready_delay_ms) + " ms");
+}
+BENCHMARK(BM_FeedPathFrame)->Args({0, 2})->Args({1, 2})->Args({0, 0})->Args({1, 0})
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
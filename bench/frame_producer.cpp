@@ -0,0 +1,258 @@
+// Synthetic stand-in for the NetBeam receiver: writes frame_<cam>_<idx>.hevc files
+// into a folder at a fixed rate so appsrc_feeder can be benchmarked without a
+// camera, the ingestion stack or the network link.
+//
+// Frames are either cycled from a folder of real captured .hevc frames (--sample-dir,
+// decodable) or synthesised: real VPS/SPS/PPS (1920x1080 Main) in front of an IDR
+// slice, or a TRAIL_R slice for P-frames, padded with filler payload. Synthetic
+// frames go through h265parse and mpegtsmux but are not meant to be decoded.
+//
+// With --shm-ring=NAME the frames go into a shared-memory ring (frame_ring.h) for
+// appsrc_feeder --shm-ring=NAME instead of files, and with --send=HOST:PORT they are
+// sent to appsrc_feeder --listen over TCP (or --udp); the folder argument is then unused.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "feeder_core.h"
+#include "frame_net.h"
+#include "frame_ring.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string dir;
+    std::string camera = "camera01";
+    double fps = 300.0;
+    unsigned long long start = 1;
+    unsigned long long count = 0;        // 0 = run until killed
+    double i_kb = 150.0;                 // mean I-frame size
+    double p_kb = 15.0;                  // mean P-frame size
+    double size_jitter = 0.2;            // relative stddev of frame sizes
+    unsigned gop = 1;                    // I-frame every N frames (1 = all I, as the cameras send today)
+    double jitter_ms = 0.0;              // stddev of write time around the slot
+    double hole_rate = 0.0;              // fraction of indices never written
+    unsigned keep = 0;                   // delete frames older than this many indices (0 = keep all)
+    std::string sample_dir;
+    std::string shm_ring;                // publish into this ring instead of writing files
+    unsigned ring_slots = 64;
+    unsigned ring_slot_kb = 1024;
+    std::string send_to;                 // send to appsrc_feeder --listen instead of writing files
+    bool udp = false;
+    int connections = 1;
+};
+
+const uint8_t START_CODE[] = {0x00, 0x00, 0x00, 0x01};
+// Parameter sets as produced by x265 for 1920x1080 Main, level 4
+const uint8_t VPS[] = {0x40, 0x01, 0x0c, 0x01, 0xff, 0xff, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0x90,
+                       0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x78, 0x95, 0x98, 0x09};
+const uint8_t SPS[] = {0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0x90, 0x00, 0x00, 0x03,
+                       0x00, 0x00, 0x03, 0x00, 0x78, 0xa0, 0x03, 0xc0, 0x80, 0x10, 0xe5, 0x96, 0x66,
+                       0x69, 0x24, 0xca, 0xe0, 0x10, 0x00, 0x00, 0x03, 0x00, 0x10, 0x00, 0x00, 0x03,
+                       0x01, 0xe0, 0x80};
+const uint8_t PPS[] = {0x44, 0x01, 0xc1, 0x72, 0xb4, 0x62, 0x40};
+const uint8_t IDR_SLICE_HDR[] = {0x26, 0x01, 0xaf};     // IDR_W_RADL, first_slice_segment_in_pic_flag=1
+const uint8_t TRAIL_SLICE_HDR[] = {0x02, 0x01, 0xd0};   // TRAIL_R, first_slice_segment_in_pic_flag=1
+
+void append(std::vector<uint8_t>& v, const uint8_t* p, size_t n) { v.insert(v.end(), p, p + n); }
+
+std::vector<uint8_t> synth_frame(bool key, size_t size, std::mt19937_64& rng) {
+    std::vector<uint8_t> f;
+    f.reserve(size + 128);
+    if (key) {
+        append(f, START_CODE, 4); append(f, VPS, sizeof(VPS));
+        append(f, START_CODE, 4); append(f, SPS, sizeof(SPS));
+        append(f, START_CODE, 4); append(f, PPS, sizeof(PPS));
+    }
+    append(f, START_CODE, 4);
+    if (key) append(f, IDR_SLICE_HDR, sizeof(IDR_SLICE_HDR));
+    else append(f, TRAIL_SLICE_HDR, sizeof(TRAIL_SLICE_HDR));
+    // Filler never contains 00 00 so no start code can be emulated
+    while (f.size() < size) f.push_back(static_cast<uint8_t>(0x80 | (rng() & 0x7f)));
+    return f;
+}
+
+std::vector<std::vector<uint8_t>> load_samples(const std::string& dir) {
+    std::vector<fs::path> files;
+    for (const auto& e : fs::directory_iterator(dir))
+        if (e.is_regular_file() && e.path().extension() == ".hevc") files.push_back(e.path());
+    std::sort(files.begin(), files.end());
+    std::vector<std::vector<uint8_t>> out;
+    for (const auto& p : files) {
+        std::ifstream ifs(p, std::ios::binary);
+        out.emplace_back(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    return out;
+}
+
+std::string frame_name(const std::string& cam, unsigned long long idx) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "frame_%s_%09llu.hevc", cam.c_str(), idx);
+    return buf;
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " <output_folder> [--camera=camera01] [--fps=300] [--start=1]"
+              << " [--count=N] [--i-kb=150] [--p-kb=15] [--size-jitter=0.2] [--gop=1]"
+              << " [--jitter-ms=0] [--hole-rate=0] [--keep=N] [--sample-dir=DIR]"
+              << " [--shm-ring=NAME [--ring-slots=64] [--ring-slot-kb=1024]]"
+              << " [--send=HOST:PORT [--udp] [--connections=1]]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    Options o;
+    o.dir = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        auto val = [&](const char* key) -> const char* {
+            size_t n = strlen(key);
+            return a.compare(0, n, key) == 0 ? a.c_str() + n : nullptr;
+        };
+        if (const char* v = val("--camera=")) o.camera = v;
+        else if (const char* v = val("--fps=")) o.fps = std::stod(v);
+        else if (const char* v = val("--start=")) o.start = std::stoull(v);
+        else if (const char* v = val("--count=")) o.count = std::stoull(v);
+        else if (const char* v = val("--i-kb=")) o.i_kb = std::stod(v);
+        else if (const char* v = val("--p-kb=")) o.p_kb = std::stod(v);
+        else if (const char* v = val("--size-jitter=")) o.size_jitter = std::stod(v);
+        else if (const char* v = val("--gop=")) o.gop = std::max(1, std::stoi(v));
+        else if (const char* v = val("--jitter-ms=")) o.jitter_ms = std::stod(v);
+        else if (const char* v = val("--hole-rate=")) o.hole_rate = std::stod(v);
+        else if (const char* v = val("--keep=")) o.keep = static_cast<unsigned>(std::stoul(v));
+        else if (const char* v = val("--sample-dir=")) o.sample_dir = v;
+        else if (const char* v = val("--shm-ring=")) o.shm_ring = v;
+        else if (const char* v = val("--ring-slots=")) o.ring_slots = static_cast<unsigned>(std::stoul(v));
+        else if (const char* v = val("--ring-slot-kb=")) o.ring_slot_kb = static_cast<unsigned>(std::stoul(v));
+        else if (const char* v = val("--send=")) o.send_to = v;
+        else if (a == "--udp") o.udp = true;
+        else if (const char* v = val("--connections=")) o.connections = std::max(1, std::stoi(v));
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    // The pacing interval and the once-a-second progress line both divide by it (NaN fails too)
+    if (!(o.fps >= 1.0)) {
+        std::cerr << "[producer] --fps must be at least 1\n";
+        return 1;
+    }
+    if (!(o.size_jitter >= 0.0) || !(o.jitter_ms >= 0.0)) {
+        std::cerr << "[producer] --size-jitter and --jitter-ms cannot be negative\n";
+        return 1;
+    }
+
+    FrameRing ring;
+    FrameSender sender;
+    const bool sending = !o.send_to.empty();
+    if (sending) {
+        if (!sender.connect(o.send_to, o.udp, o.connections)) {
+            std::cerr << "[producer] Cannot connect to " << o.send_to << "\n";
+            return 1;
+        }
+        std::cerr << "[producer] Sending to " << o.send_to << (o.udp ? " over udp" : " over tcp, ")
+                  << (o.udp ? "" : std::to_string(o.connections) + " connection(s)") << "\n";
+    } else if (!o.shm_ring.empty()) {
+        if (!ring.create(o.shm_ring, o.ring_slots, o.ring_slot_kb * 1024)) {
+            std::cerr << "[producer] Cannot create shared-memory ring " << o.shm_ring << "\n";
+            return 1;
+        }
+        std::cerr << "[producer] Ring " << o.shm_ring << ": " << o.ring_slots << " x " << o.ring_slot_kb << " KB\n";
+    } else {
+        fs::create_directories(o.dir);
+    }
+    std::vector<std::vector<uint8_t>> samples;
+    if (!o.sample_dir.empty()) {
+        samples = load_samples(o.sample_dir);
+        if (samples.empty()) {
+            std::cerr << "[producer] No .hevc samples in " << o.sample_dir << "\n";
+            return 1;
+        }
+    }
+
+    std::mt19937_64 rng(12345);   // fixed seed: runs are comparable
+    // A normal distribution needs a stddev above 0: with jitter off it is never drawn from
+    std::normal_distribution<double> size_noise(1.0, o.size_jitter > 0 ? o.size_jitter : 1.0);
+    std::normal_distribution<double> time_noise(0.0, o.jitter_ms > 0 ? o.jitter_ms : 1.0);
+    auto size_factor = [&] { return o.size_jitter > 0 ? size_noise(rng) : 1.0; };
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Pre-generate a small pool per frame type so the producer itself stays cheap
+    std::vector<std::vector<uint8_t>> i_pool, p_pool;
+    if (samples.empty()) {
+        for (int k = 0; k < 16; ++k) {
+            i_pool.push_back(synth_frame(true, static_cast<size_t>(std::max(1.0, o.i_kb * size_factor()) * 1024), rng));
+            p_pool.push_back(synth_frame(false, static_cast<size_t>(std::max(1.0, o.p_kb * size_factor()) * 1024), rng));
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration<double>(1.0 / o.fps);
+    const auto t0 = clock::now();
+    unsigned long long written = 0, holes = 0, bytes = 0, dropped = 0;
+
+    for (unsigned long long n = 0; o.count == 0 || n < o.count; ++n) {
+        unsigned long long idx = o.start + n;
+        double jitter = o.jitter_ms > 0 ? time_noise(rng) / 1000.0 : 0.0;
+        auto due = t0 + std::chrono::duration_cast<clock::duration>(interval * static_cast<double>(n) +
+                                                                    std::chrono::duration<double>(jitter));
+        std::this_thread::sleep_until(due);
+
+        if (o.keep && !ring.is_open() && !sending && idx >= o.start + o.keep) {
+            std::error_code ec;
+            fs::remove(fs::path(o.dir) / frame_name(o.camera, idx - o.keep), ec);
+        }
+        if (o.hole_rate > 0 && unit(rng) < o.hole_rate) {
+            holes++;
+            continue;
+        }
+
+        bool key = samples.empty() && n % o.gop == 0;
+        const std::vector<uint8_t>& f = !samples.empty() ? samples[n % samples.size()]
+                                      : key ? i_pool[n % i_pool.size()]
+                                            : p_pool[n % p_pool.size()];
+        if (!samples.empty() && (ring.is_open() || sending)) key = scan_hevc_au(f.data(), f.size()).keyframe;
+        const uint32_t flags = key ? 0u : static_cast<uint32_t>(FRAME_FLAG_DELTA);
+        if (sending) {
+            if (!sender.send(idx, f.data(), f.size(), flags)) {
+                std::cerr << "[producer] Connection lost after " << written << " frames\n";
+                return 1;
+            }
+        } else if (ring.is_open()) {
+            // Never block the (simulated) network side: a full ring drops the frame
+            if (!ring.publish(idx, f.data(), f.size(), flags)) {
+                dropped++;
+                continue;
+            }
+        } else {
+            std::ofstream ofs(fs::path(o.dir) / frame_name(o.camera, idx), std::ios::binary);
+            ofs.write(reinterpret_cast<const char*>(f.data()), static_cast<std::streamsize>(f.size()));
+        }
+        written++;
+        bytes += f.size();
+
+        if (written % static_cast<unsigned long long>(o.fps) == 0) {
+            double secs = std::chrono::duration<double>(clock::now() - t0).count();
+            std::cerr << "[producer] " << written << " frames (" << holes << " holes, " << dropped << " dropped), "
+                      << bytes / (1024 * 1024) << " MB in " << secs << " s\n";
+        }
+    }
+    return 0;
+}
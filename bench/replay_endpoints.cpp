@@ -0,0 +1,405 @@
+// Off-site stand-in for the two network endpoints appsrc_feeder talks to:
+//
+//  * DragonflyDB: --record-from dumps the per-frame metadata of a live server into a
+//    "key<TAB>value" file (tab, newline, CR and backslash escaped as \t \n \r \\);
+//    --metadata loads such a dump into a local redis-server
+//    (or dragonfly) with pipelined SETs.
+//  * Audio bridge: --pcm serves a recorded S16LE capture on http://HOST:PORT/audio at
+//    real-time rate, looping, like the bridge on the BT machine does.
+//
+// Speaks RESP and HTTP/1.0 over plain sockets so it builds without hiredis or GStreamer.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+static void close_socket(socket_t s) { closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+static constexpr socket_t INVALID_SOCKET = -1;
+static void close_socket(socket_t s) { close(s); }
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+struct Options {
+    std::string redis = "127.0.0.1:6379";    // where --metadata is loaded
+    std::string record_from;                 // live server to dump from
+    std::string pattern = "frame_*";
+    std::string metadata;                    // dump file (read or written)
+    std::string pcm;                         // raw S16LE capture
+    std::string http = "127.0.0.1:53354";
+    int rate = 48000;
+    int channels = 2;
+};
+
+void split_host_port(const std::string& addr, const std::string& def_host, std::string& host, std::string& port) {
+    size_t colon = addr.rfind(':');
+    if (colon == std::string::npos) {
+        host = def_host;
+        port = addr;
+    } else {
+        host = colon ? addr.substr(0, colon) : def_host;
+        port = addr.substr(colon + 1);
+    }
+}
+
+bool send_all(socket_t fd, const char* p, size_t n) {
+    while (n) {
+        int sent = send(fd, p, static_cast<int>(n), MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        p += sent;
+        n -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// === Minimal RESP client ===
+struct Reply {
+    char type = 0;                      // '+', '-', ':', '$', '*'
+    bool nil = false;
+    std::string str;
+    long long num = 0;
+    std::vector<Reply> elements;
+};
+
+class RespConn {
+public:
+    ~RespConn() { if (fd_ != INVALID_SOCKET) close_socket(fd_); }
+
+    bool connect_to(const std::string& addr) {
+        std::string host, port;
+        split_host_port(addr, "127.0.0.1", host, port);
+        addrinfo hints{}, *res = nullptr;
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res) return false;
+        fd_ = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        bool ok = fd_ != INVALID_SOCKET && connect(fd_, res->ai_addr, static_cast<int>(res->ai_addrlen)) == 0;
+        freeaddrinfo(res);
+        return ok;
+    }
+
+    // Queue one command; flush() sends everything queued
+    void append(const std::vector<std::string>& args) {
+        out_ += "*" + std::to_string(args.size()) + "\r\n";
+        for (const auto& a : args) {
+            out_ += "$" + std::to_string(a.size()) + "\r\n";
+            out_ += a;
+            out_ += "\r\n";
+        }
+    }
+    bool flush() {
+        bool ok = send_all(fd_, out_.data(), out_.size());
+        out_.clear();
+        return ok;
+    }
+
+    bool read_reply(Reply& r) {
+        std::string line;
+        if (!read_line(line) || line.empty()) return false;
+        r = Reply{};
+        r.type = line[0];
+        std::string rest = line.substr(1);
+        switch (r.type) {
+        case '+': case '-': r.str = rest; return true;
+        case ':': r.num = std::stoll(rest); return true;
+        case '$': {
+            long long n = std::stoll(rest);
+            if (n < 0) { r.nil = true; return true; }
+            if (!read_bytes(static_cast<size_t>(n) + 2, r.str)) return false;
+            r.str.resize(static_cast<size_t>(n));
+            return true;
+        }
+        case '*': {
+            long long n = std::stoll(rest);
+            if (n < 0) { r.nil = true; return true; }
+            r.elements.resize(static_cast<size_t>(n));
+            for (auto& e : r.elements)
+                if (!read_reply(e)) return false;
+            return true;
+        }
+        default: return false;
+        }
+    }
+
+private:
+    bool fill() {
+        char tmp[64 * 1024];
+        int n = recv(fd_, tmp, sizeof(tmp), 0);
+        if (n <= 0) return false;
+        in_.append(tmp, static_cast<size_t>(n));
+        return true;
+    }
+    bool read_line(std::string& line) {
+        size_t eol;
+        while ((eol = in_.find("\r\n", pos_)) == std::string::npos)
+            if (!fill()) return false;
+        line = in_.substr(pos_, eol - pos_);
+        pos_ = eol + 2;
+        compact();
+        return true;
+    }
+    bool read_bytes(size_t n, std::string& out) {
+        while (in_.size() - pos_ < n)
+            if (!fill()) return false;
+        out = in_.substr(pos_, n);
+        pos_ += n;
+        compact();
+        return true;
+    }
+    void compact() {
+        if (pos_ > 1024 * 1024) { in_.erase(0, pos_); pos_ = 0; }
+    }
+
+    socket_t fd_ = INVALID_SOCKET;
+    std::string out_, in_;
+    size_t pos_ = 0;
+};
+
+// === Metadata dump / load ===
+// One "key<TAB>value" line per key; values are arbitrary bytes, so the four characters
+// that would break a line are written as backslash escapes
+std::string escape_field(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char ch : s) {
+        switch (ch) {
+        case '\t': out += "\\t"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\\': out += "\\\\"; break;
+        default: out += ch;
+        }
+    }
+    return out;
+}
+
+std::string unescape_field(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] != '\\' || i + 1 == s.size()) {
+            out += s[i];
+            continue;
+        }
+        switch (s[++i]) {
+        case 't': out += '\t'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        default: out += s[i];
+        }
+    }
+    return out;
+}
+
+int record_metadata(const Options& o) {
+    RespConn c;
+    if (!c.connect_to(o.record_from)) {
+        std::cerr << "[replay] Cannot connect to " << o.record_from << "\n";
+        return 1;
+    }
+    std::ofstream out(o.metadata, std::ios::binary);
+    if (!out) {
+        std::cerr << "[replay] Cannot write " << o.metadata << "\n";
+        return 1;
+    }
+    std::string cursor = "0";
+    size_t n = 0;
+    do {
+        c.append({"SCAN", cursor, "MATCH", o.pattern, "COUNT", "1000"});
+        Reply scan;
+        if (!c.flush() || !c.read_reply(scan) || scan.type != '*' || scan.elements.size() != 2) {
+            std::cerr << "[replay] SCAN failed\n";
+            return 1;
+        }
+        cursor = scan.elements[0].str;
+        const auto& keys = scan.elements[1].elements;
+        for (const auto& k : keys) c.append({"GET", k.str});
+        if (!c.flush()) return 1;
+        for (const auto& k : keys) {
+            Reply v;
+            if (!c.read_reply(v)) return 1;
+            if (v.type != '$' || v.nil) continue;     // expired between SCAN and GET
+            out << escape_field(k.str) << '\t' << escape_field(v.str) << '\n';
+            n++;
+        }
+    } while (cursor != "0");
+    std::cout << "[replay] Recorded " << n << " keys matching " << o.pattern << " into " << o.metadata << "\n";
+    return 0;
+}
+
+bool load_metadata(const Options& o) {
+    std::ifstream in(o.metadata, std::ios::binary);
+    if (!in) {
+        std::cerr << "[replay] Cannot read " << o.metadata << "\n";
+        return false;
+    }
+    RespConn c;
+    if (!c.connect_to(o.redis)) {
+        std::cerr << "[replay] Cannot connect to redis at " << o.redis << "\n";
+        return false;
+    }
+    const size_t PIPELINE = 1000;
+    size_t queued = 0, loaded = 0, errors = 0;
+    auto drain = [&]() {
+        if (!c.flush()) return false;
+        for (; queued; --queued) {
+            Reply r;
+            if (!c.read_reply(r)) return false;
+            if (r.type == '-') errors++;
+            else loaded++;
+        }
+        return true;
+    };
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        c.append({"SET", unescape_field(line.substr(0, tab)), unescape_field(line.substr(tab + 1))});
+        if (++queued == PIPELINE && !drain()) return false;
+    }
+    if (!drain()) return false;
+    std::cout << "[replay] Loaded " << loaded << " keys into " << o.redis
+              << (errors ? " (" + std::to_string(errors) + " errors)" : "") << "\n";
+    return errors == 0;
+}
+
+// === PCM over HTTP ===
+void stream_pcm(socket_t client, std::shared_ptr<const std::vector<char>> pcm, const Options& o) {
+    char req[2048];
+    recv(client, req, sizeof(req), 0);      // request line and headers; path is not checked
+    const char* hdr = "HTTP/1.0 200 OK\r\nContent-Type: application/octet-stream\r\nConnection: close\r\n\r\n";
+    if (!send_all(client, hdr, strlen(hdr))) {
+        close_socket(client);
+        return;
+    }
+    // 10 ms chunks on an absolute schedule so the average rate never drifts. Each send,
+    // including the short one at the end of the capture before it loops, waits until the
+    // samples sent so far are due.
+    const size_t frame_bytes = static_cast<size_t>(o.channels) * 2;
+    const size_t chunk = static_cast<size_t>(o.rate / 100) * frame_bytes;
+    const auto start = std::chrono::steady_clock::now();
+    size_t pos = 0;
+    uint64_t sent = 0;
+    while (true) {
+        size_t n = std::min(chunk, pcm->size() - pos);
+        if (!send_all(client, pcm->data() + pos, n)) break;
+        sent += n;
+        pos = (pos + n) % pcm->size();
+        std::this_thread::sleep_until(start + std::chrono::microseconds(sent / frame_bytes * 1000000 / static_cast<uint64_t>(o.rate)));
+    }
+    std::cout << "[replay] Audio client gone after " << sent / frame_bytes / o.rate << " s\n";
+    close_socket(client);
+}
+
+int serve_pcm(const Options& o) {
+    std::ifstream in(o.pcm, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const size_t frame_bytes = static_cast<size_t>(o.channels) * 2;
+    data.resize(data.size() - data.size() % frame_bytes);     // whole sample frames only, so the loop stays aligned
+    auto pcm = std::make_shared<const std::vector<char>>(std::move(data));
+    if (pcm->size() < frame_bytes) {
+        std::cerr << "[replay] No PCM data in " << o.pcm << "\n";
+        return 1;
+    }
+    std::string host, port;
+    split_host_port(o.http, "127.0.0.1", host, port);
+    socket_t listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(static_cast<unsigned short>(std::stoi(port)));
+    if (listen_fd == INVALID_SOCKET || inet_pton(AF_INET, host.c_str(), &sa.sin_addr) != 1 ||
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0 || listen(listen_fd, 4) != 0) {
+        std::cerr << "[replay] Cannot listen on " << host << ":" << port << "\n";
+        return 1;
+    }
+    std::cout << "[replay] Serving " << o.pcm << " (" << pcm->size() / frame_bytes / o.rate << " s, "
+              << o.rate << " Hz x" << o.channels << ", looped) on http://" << host << ":" << port << "/audio\n";
+    while (true) {
+        socket_t client = accept(listen_fd, nullptr, nullptr);
+        if (client == INVALID_SOCKET) continue;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+        std::thread(stream_pcm, client, pcm, o).detach();
+    }
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage:\n"
+              << "  " << argv0 << " --record-from=HOST[:PORT] --metadata=dump.tsv [--pattern=frame_*]\n"
+              << "  " << argv0 << " [--metadata=dump.tsv] [--redis=127.0.0.1:6379]"
+              << " [--pcm=audio.s16le] [--http=127.0.0.1:53354] [--rate=48000] [--channels=2]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto val = [&](const char* key) -> const char* {
+            size_t n = strlen(key);
+            return a.compare(0, n, key) == 0 ? a.c_str() + n : nullptr;
+        };
+        if (const char* v = val("--redis=")) o.redis = v;
+        else if (const char* v = val("--record-from=")) o.record_from = v;
+        else if (const char* v = val("--pattern=")) o.pattern = v;
+        else if (const char* v = val("--metadata=")) o.metadata = v;
+        else if (const char* v = val("--pcm=")) o.pcm = v;
+        else if (const char* v = val("--http=")) o.http = v;
+        else if (const char* v = val("--rate=")) o.rate = std::stoi(v);
+        else if (const char* v = val("--channels=")) o.channels = std::stoi(v);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (o.metadata.empty() && o.pcm.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "[replay] WSAStartup failed\n";
+        return 1;
+    }
+#endif
+    if (!o.record_from.empty()) {
+        if (o.metadata.empty()) {
+            usage(argv[0]);
+            return 1;
+        }
+        return record_metadata(o);
+    }
+    if (!o.metadata.empty() && !load_metadata(o)) return 1;
+    if (!o.pcm.empty()) return serve_pcm(o);
+    return 0;
+}
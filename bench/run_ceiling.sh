@@ -0,0 +1,84 @@
+#!/usr/bin/env bash
+# Frames/s ceiling of the current file path, three ways:
+#  1. feeder_microbench BM_FeedPathFrame: the feeder thread's and the video probe's
+#     per-frame work outside GStreamer, unpaced (with and without is_file_ready's sleep)
+#  2. frame_producer alone at increasing --fps: the rate the input side can write
+#  3. appsrc_feeder (video only, when built) fed by frame_producer at the same rates:
+#     frames pushed per second against the rate asked for, from the metrics endpoint
+# A rate counts as sustained at 95% of it or better; the sweep stops at the first that is not.
+#
+# Usage: bench/run_ceiling.sh <build_dir> [seconds_per_rate]
+#   RATES="300 450 600 900 1200 2400 4800"                      rates to try, ascending
+#   FEEDER_ARGS="--no-parse"                                    extra appsrc_feeder flags
+#   BENCH_DIR=/dev/shm/feeder_ceiling                           tmpfs work folder
+set -euo pipefail
+
+BUILD_DIR=${1:?build dir with frame_producer (and feeder_microbench, appsrc_feeder when built)}
+SECONDS_PER_RATE=${2:-5}
+RATES=${RATES:-300 450 600 900 1200 2400 4800}
+PORT=${METRICS_PORT:-19103}
+WORK=${BENCH_DIR:-/dev/shm/feeder_ceiling.$$}
+PRODUCER="$BUILD_DIR/frame_producer"
+FEEDER="$BUILD_DIR/appsrc_feeder"
+MICROBENCH="$BUILD_DIR/feeder_microbench"
+
+mkdir -p "$WORK"
+cleanup() {
+    kill "${FEEDER_PID:-}" "${PRODUCER_PID:-}" 2>/dev/null || true
+    wait 2>/dev/null || true
+    rm -rf "$WORK/frames"
+}
+trap cleanup EXIT
+
+echo "=== frames/s ceiling, ${SECONDS_PER_RATE}s per rate ==="
+if [ -x "$MICROBENCH" ]; then
+    echo "--- feeder_microbench (per-frame work outside GStreamer, 150 KB keyframes)"
+    "$MICROBENCH" --benchmark_filter=BM_FeedPathFrame 2>/dev/null | awk '/^BM_FeedPathFrame/'
+fi
+
+sustained() { awk -v got="$1" -v want="$2" 'BEGIN {exit !(got >= want * 0.95)}'; }
+
+echo "--- frame_producer alone (150 KB keyframes to tmpfs)"
+for R in $RATES; do
+    rm -rf "$WORK/frames" && mkdir -p "$WORK/frames"
+    COUNT=$((R * SECONDS_PER_RATE))
+    START=$(date +%s.%N)
+    "$PRODUCER" "$WORK/frames" --fps="$R" --count="$COUNT" --keep="$R" 2> "$WORK/producer.log"
+    END=$(date +%s.%N)
+    GOT=$(awk -v n="$COUNT" -v a="$START" -v b="$END" 'BEGIN {printf "%.0f", n / (b - a)}')
+    printf "%6s fps asked: %6s fps written\n" "$R" "$GOT"
+    sustained "$GOT" "$R" || break
+done
+
+if [ -x "$FEEDER" ]; then
+    echo "--- appsrc_feeder fed by frame_producer (video only)"
+    metric() { echo "$METRICS" | awk -v n="$1" '$1 ~ "^"n"[{ ]" {s += $2} END {print s + 0}'; }
+    for R in $RATES; do
+        rm -rf "$WORK/frames" && mkdir -p "$WORK/frames"
+        "$PRODUCER" "$WORK/frames" --fps="$R" --start=1 --keep=$((R * 10)) 2> "$WORK/producer.log" &
+        PRODUCER_PID=$!
+        sleep 0.5
+        (cd "$WORK" && exec "$FEEDER" 1 "$R" "$WORK/frames" "$WORK/out.ts" "$WORK/out.csv" camera01 \
+            --no-audio --skip-missing-ms=50 --metrics=127.0.0.1:"$PORT" ${FEEDER_ARGS:-}) \
+            > "$WORK/feeder.out" 2> "$WORK/feeder.log" &
+        FEEDER_PID=$!
+        # The first second is start-up; count the frames pushed over the rest
+        sleep 1
+        METRICS=$(curl -s "http://127.0.0.1:$PORT/metrics" || true)
+        BEFORE=$(metric feeder_frames_pushed_total)
+        sleep "$SECONDS_PER_RATE"
+        METRICS=$(curl -s "http://127.0.0.1:$PORT/metrics" || true)
+        AFTER=$(metric feeder_frames_pushed_total)
+        BEHIND=$(metric feeder_behind_schedule_total)
+        kill "$PRODUCER_PID" 2>/dev/null || true
+        sleep 0.5
+        kill "$FEEDER_PID" 2>/dev/null || true
+        wait 2>/dev/null || true
+        GOT=$(( (AFTER - BEFORE) / SECONDS_PER_RATE ))
+        printf "%6s fps asked: %6s fps pushed, %s frames behind schedule\n" "$R" "$GOT" "$BEHIND"
+        sustained "$GOT" "$R" || break
+    done
+else
+    echo "--- appsrc_feeder not built (GStreamer missing): pipeline not measured"
+fi
+echo "logs           : $WORK"
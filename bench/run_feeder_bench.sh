@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+# End-to-end throughput benchmark: frame_producer writes synthetic frames into a
+# tmpfs folder, appsrc_feeder (video only) remuxes them, and the run is summarised
+# from the feeder's metrics endpoint, /proc and the output file.
+#
+# Usage: bench/run_feeder_bench.sh <build_dir> [seconds] [fps]
+#   PRODUCER_ARGS="--gop=10 --jitter-ms=1 --hole-rate=0.001"   extra frame_producer flags
+#   FEEDER_ARGS="--batch=8 --no-parse"                          extra appsrc_feeder flags
+#   BENCH_DIR=/dev/shm/feeder_bench                             tmpfs work folder
+set -euo pipefail
+
+BUILD_DIR=${1:?build dir with appsrc_feeder and frame_producer}
+SECONDS_TO_RUN=${2:-30}
+FPS=${3:-300}
+PORT=${METRICS_PORT:-19100}
+WORK=${BENCH_DIR:-/dev/shm/feeder_bench.$$}
+FEEDER="$BUILD_DIR/appsrc_feeder"
+PRODUCER="$BUILD_DIR/frame_producer"
+
+mkdir -p "$WORK/frames"
+cleanup() {
+    kill "${FEEDER_PID:-}" "${PRODUCER_PID:-}" 2>/dev/null || true
+    wait 2>/dev/null || true
+    rm -rf "$WORK/frames"
+}
+trap cleanup EXIT
+
+# Keep ~10 s of frames so the folder stays small, like buffer_runner.sh does
+"$PRODUCER" "$WORK/frames" --fps="$FPS" --start=1 --keep=$((FPS * 10)) ${PRODUCER_ARGS:-} \
+    2> "$WORK/producer.log" &
+PRODUCER_PID=$!
+sleep 0.5
+
+(cd "$WORK" && exec "$FEEDER" 1 "$FPS" "$WORK/frames" "$WORK/out.ts" "$WORK/out.csv" camera01 \
+    --no-audio --skip-missing-ms=50 --metrics=127.0.0.1:"$PORT" ${FEEDER_ARGS:-}) \
+    > "$WORK/feeder.out" 2> "$WORK/feeder.log" &
+FEEDER_PID=$!
+
+sleep "$SECONDS_TO_RUN"
+
+METRICS=$(curl -s "http://127.0.0.1:$PORT/metrics" || true)
+CLK_TCK=$(getconf CLK_TCK)
+# utime + stime of the feeder process (fields 14/15 of /proc/<pid>/stat)
+CPU_TICKS=$(awk '{print $14 + $15}' "/proc/$FEEDER_PID/stat" 2>/dev/null || echo 0)
+TS_BYTES=$(stat -c %s "$WORK/out.ts" 2>/dev/null || echo 0)
+
+metric() { echo "$METRICS" | awk -v n="$1" '$1 ~ "^"n"[{ ]" {s += $2} END {print s + 0}'; }
+
+FRAMES=$(metric feeder_frames_pushed_total)
+BEHIND=$(metric feeder_behind_schedule_total)
+SKIP_PB=$(echo "$METRICS" | awk '/feeder_frames_skipped_total.*reason="pb"/ {print $2}')
+SKIP_MISSING=$(echo "$METRICS" | awk '/feeder_frames_skipped_total.*reason="missing"/ {print $2}')
+
+# Percentile upper bounds from the cumulative lateness histogram
+LATENESS=$(echo "$METRICS" | awk '
+    /^feeder_push_lateness_seconds_bucket/ {
+        match($0, /le="[^"]+"/); le = substr($0, RSTART + 4, RLENGTH - 5)
+        n++; bound[n] = le; cum[n] = $2
+    }
+    END {
+        total = cum[n]; split("0.5 0.9 0.99 0.999", qs, " ")
+        for (i = 1; i <= 4; i++) {
+            for (j = 1; j <= n; j++) if (cum[j] >= qs[i] * total) break
+            printf "p%s<=%ss ", qs[i] * 100, bound[j]
+        }
+    }')
+
+echo "=== feeder benchmark: ${SECONDS_TO_RUN}s at ${FPS} fps ==="
+echo "producer flags : ${PRODUCER_ARGS:-(defaults)}"
+echo "feeder flags   : ${FEEDER_ARGS:-(defaults)}"
+awk -v f="$FRAMES" -v s="$SECONDS_TO_RUN" 'BEGIN {printf "sustained fps  : %.1f (%d frames)\n", f / s, f}'
+echo "skipped        : pb=${SKIP_PB:-0} missing=${SKIP_MISSING:-0} behind-schedule=$BEHIND"
+echo "lateness       : $LATENESS"
+awk -v t="$CPU_TICKS" -v hz="$CLK_TCK" -v f="$FRAMES" \
+    'BEGIN {printf "cpu            : %.2f s total, %.1f us/frame\n", t / hz, f ? t / hz / f * 1e6 : 0}'
+awk -v b="$TS_BYTES" -v s="$SECONDS_TO_RUN" \
+    'BEGIN {printf "output         : %.1f MB (%.1f Mbit/s)\n", b / 1048576, b * 8 / s / 1e6}'
+echo "logs           : $WORK"
@@ -0,0 +1,88 @@
+#!/usr/bin/env bash
+# Fault-injection test of --self-heal: frame_producer feeds appsrc_feeder (video only)
+# while --heal-test posts an element error from queue1 every few seconds, each of which
+# restarts the pipeline in place. Reports every recovery time from the feeder log and
+# the metrics, fails when the slowest is above the target, and checks the recording
+# with ts_analyzer (which exempts the restart splices logged in out.ts.splices.csv).
+#
+# Usage: bench/run_heal_test.sh <build_dir> [seconds] [fps] [every_s]
+#   TARGET_MS=500                                               slowest recovery allowed
+#   FEEDER_ARGS="--no-parse"                                    extra appsrc_feeder flags
+#   BENCH_DIR=/dev/shm/feeder_heal                              tmpfs work folder
+# every_s stays above the 2 s back-off window so every restart is a first failure.
+set -euo pipefail
+
+BUILD_DIR=${1:?build dir with appsrc_feeder, frame_producer and ts_analyzer}
+SECONDS_TO_RUN=${2:-30}
+FPS=${3:-25}
+EVERY_S=${4:-3}
+TARGET_MS=${TARGET_MS:-500}
+PORT=${METRICS_PORT:-19101}
+WORK=${BENCH_DIR:-/dev/shm/feeder_heal.$$}
+FEEDER="$BUILD_DIR/appsrc_feeder"
+PRODUCER="$BUILD_DIR/frame_producer"
+ANALYZER="$BUILD_DIR/ts_analyzer"
+
+mkdir -p "$WORK/frames"
+cleanup() {
+    kill "${FEEDER_PID:-}" "${PRODUCER_PID:-}" 2>/dev/null || true
+    wait 2>/dev/null || true
+    rm -rf "$WORK/frames"
+}
+trap cleanup EXIT
+
+"$PRODUCER" "$WORK/frames" --fps="$FPS" --start=1 --keep=$((FPS * 10)) 2> "$WORK/producer.log" &
+PRODUCER_PID=$!
+sleep 0.5
+
+(cd "$WORK" && exec "$FEEDER" 1 "$FPS" "$WORK/frames" "$WORK/out.ts" "$WORK/out.csv" camera01 \
+    --no-audio --skip-missing-ms=50 --heal-test="$EVERY_S" --metrics=127.0.0.1:"$PORT" ${FEEDER_ARGS:-}) \
+    > "$WORK/feeder.out" 2> "$WORK/feeder.log" &
+FEEDER_PID=$!
+
+sleep "$SECONDS_TO_RUN"
+
+METRICS=$(curl -s "http://127.0.0.1:$PORT/metrics" || true)
+metric() { echo "$METRICS" | awk -v n="$1" '$1 ~ "^"n"[{ ]" {s += $2} END {print s + 0}'; }
+INJECTED=$((SECONDS_TO_RUN / EVERY_S))
+RECOVERIES=$(metric feeder_recovery_seconds_count)
+DISCARDED=$(metric feeder_recovery_discarded_frames_total)
+
+# The feeder has no clean stop outside EOS: the producer goes first, then the feeder
+kill "$PRODUCER_PID" 2>/dev/null || true
+sleep 1
+kill "$FEEDER_PID" 2>/dev/null || true
+wait 2>/dev/null || true
+
+# "[heal] pipeline recovered in 212 ms"
+TIMES=$(awk '/^\[heal\] pipeline recovered in/ {print $5}' "$WORK/feeder.log")
+STATS=$(echo "$TIMES" | sort -n | awk 'NF {n++; s += $1; v[n] = $1}
+    END {
+        if (!n) { print "0 0 0 0"; exit }
+        i = int(n * 0.95); if (i < n * 0.95) i++
+        printf "%d %.0f %d %d\n", n, s / n, v[i], v[n]
+    }')
+read -r N MEAN P95 MAX <<< "$STATS"
+
+echo "=== self-heal fault injection: ${SECONDS_TO_RUN}s at ${FPS} fps, an error every ${EVERY_S}s ==="
+echo "recoveries     : $N logged, $RECOVERIES in metrics (~$INJECTED injected)"
+echo "recovery time  : mean ${MEAN} ms, p95 ${P95} ms, max ${MAX} ms (target ${TARGET_MS} ms)"
+echo "discarded      : $DISCARDED queued frames"
+echo "--- ts_analyzer"
+ANALYZER_RC=0
+"$ANALYZER" "$WORK/out.ts" --csv="$WORK/out.csv" || ANALYZER_RC=$?
+echo "logs           : $WORK"
+
+if [ "$N" -eq 0 ]; then
+    echo "FAIL: no recovery logged"
+    exit 2
+fi
+if [ "$MAX" -gt "$TARGET_MS" ]; then
+    echo "FAIL: slowest recovery ${MAX} ms above ${TARGET_MS} ms"
+    exit 2
+fi
+if [ "$ANALYZER_RC" -ne 0 ]; then
+    echo "FAIL: ts_analyzer exit $ANALYZER_RC"
+    exit 2
+fi
+echo "PASS"
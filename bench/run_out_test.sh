@@ -0,0 +1,101 @@
+#!/usr/bin/env bash
+# Loopback test of --out: frame_producer feeds appsrc_feeder (video only) with a UDP and
+# an SRT live output on 127.0.0.1, received by gst-launch-1.0 (udpsrc, srtsrc caller)
+# into files. Each capture is checked with ts_analyzer: whole packets from the first
+# byte, continuity counters, PCR interval and PTS order must hold on what arrived, and
+# the received byte count is compared with the buffers the feeder reports as sent.
+#
+# Usage: bench/run_out_test.sh <build_dir> [seconds] [fps]
+#   UDP_PORT=19300 SRT_PORT=19301                               loopback ports
+#   FEEDER_ARGS="--no-parse"                                    extra appsrc_feeder flags
+#   BENCH_DIR=/dev/shm/feeder_out                               tmpfs work folder
+# A receiver joins a running stream: the checks need no PAT/PMT or frame count from the start.
+set -euo pipefail
+
+BUILD_DIR=${1:?build dir with appsrc_feeder, frame_producer and ts_analyzer}
+SECONDS_TO_RUN=${2:-20}
+FPS=${3:-25}
+UDP_PORT=${UDP_PORT:-19300}
+SRT_PORT=${SRT_PORT:-19301}
+PORT=${METRICS_PORT:-19102}
+WORK=${BENCH_DIR:-/dev/shm/feeder_out.$$}
+FEEDER="$BUILD_DIR/appsrc_feeder"
+PRODUCER="$BUILD_DIR/frame_producer"
+ANALYZER="$BUILD_DIR/ts_analyzer"
+
+mkdir -p "$WORK/frames"
+cleanup() {
+    kill "${FEEDER_PID:-}" "${PRODUCER_PID:-}" "${UDP_PID:-}" "${SRT_PID:-}" 2>/dev/null || true
+    wait 2>/dev/null || true
+    rm -rf "$WORK/frames"
+}
+trap cleanup EXIT
+
+# The UDP receiver is up before the first datagram; the SRT caller needs the listener first
+gst-launch-1.0 -e udpsrc address=127.0.0.1 port="$UDP_PORT" buffer-size=4194304 \
+    ! filesink location="$WORK/udp.ts" > "$WORK/udp.log" 2>&1 &
+UDP_PID=$!
+
+"$PRODUCER" "$WORK/frames" --fps="$FPS" --start=1 --keep=$((FPS * 10)) 2> "$WORK/producer.log" &
+PRODUCER_PID=$!
+sleep 0.5
+
+(cd "$WORK" && exec "$FEEDER" 1 "$FPS" "$WORK/frames" "$WORK/out.ts" "$WORK/out.csv" camera01 \
+    --no-audio --skip-missing-ms=50 --metrics=127.0.0.1:"$PORT" \
+    --out=udp://127.0.0.1:"$UDP_PORT" --out=srt://127.0.0.1:"$SRT_PORT" ${FEEDER_ARGS:-}) \
+    > "$WORK/feeder.out" 2> "$WORK/feeder.log" &
+FEEDER_PID=$!
+sleep 1
+
+gst-launch-1.0 -e srtsrc uri="srt://127.0.0.1:$SRT_PORT?mode=caller" \
+    ! filesink location="$WORK/srt.ts" > "$WORK/srt.log" 2>&1 &
+SRT_PID=$!
+
+sleep "$SECONDS_TO_RUN"
+
+METRICS=$(curl -s "http://127.0.0.1:$PORT/metrics" || true)
+# feeder_output_buffers_total{...,output="udp://127.0.0.1:19300",result="sent"} 1234
+buffers() { echo "$METRICS" | awk -v o="$1" -v r="$2" 'index($1, "output=\"" o "\"") && index($1, "result=\"" r "\"") {print $2}'; }
+UDP_SENT=$(buffers "udp://127.0.0.1:$UDP_PORT" sent)
+UDP_DROPPED=$(buffers "udp://127.0.0.1:$UDP_PORT" dropped)
+SRT_DROPPED=$(buffers "srt://127.0.0.1:$SRT_PORT" dropped)
+
+# Receivers stop first (EOS on SIGINT, so filesink has written everything), then the
+# producer and the feeder as in run_heal_test.sh
+kill -INT "$UDP_PID" "$SRT_PID" 2>/dev/null || true
+sleep 1
+kill "$PRODUCER_PID" 2>/dev/null || true
+sleep 1
+kill "$FEEDER_PID" 2>/dev/null || true
+wait 2>/dev/null || true
+
+size_of() { [ -f "$1" ] && stat -c %s "$1" || echo 0; }
+UDP_BYTES=$(size_of "$WORK/udp.ts")
+SRT_BYTES=$(size_of "$WORK/srt.ts")
+
+echo "=== --out loopback: ${SECONDS_TO_RUN}s at ${FPS} fps ==="
+echo "udp            : ${UDP_BYTES} bytes received, ${UDP_SENT:-?} buffers of 1316 bytes sent, ${UDP_DROPPED:-?} dropped"
+echo "srt            : ${SRT_BYTES} bytes received, ${SRT_DROPPED:-?} dropped"
+RC=0
+for OUT in udp srt; do
+    echo "--- ts_analyzer $OUT"
+    if [ "$(size_of "$WORK/$OUT.ts")" -eq 0 ]; then
+        echo "FAIL: nothing received on $OUT (see $WORK/$OUT.log)"
+        RC=2
+        continue
+    fi
+    if [ $(($(size_of "$WORK/$OUT.ts") % 188)) -ne 0 ]; then
+        echo "FAIL: $OUT capture is not whole TS packets"
+        RC=2
+    fi
+    "$ANALYZER" "$WORK/$OUT.ts" || { echo "FAIL: ts_analyzer exit $? on $OUT"; RC=2; }
+done
+echo "logs           : $WORK"
+
+# Every datagram sent on loopback arrives; the last ones can still be in flight at SIGINT
+if [ -n "${UDP_SENT:-}" ] && [ "$UDP_BYTES" -lt $((UDP_SENT * 1316 * 99 / 100)) ]; then
+    echo "FAIL: udp received fewer than 99% of the bytes sent"
+    RC=2
+fi
+[ "$RC" -eq 0 ] && echo "PASS"
+exit "$RC"
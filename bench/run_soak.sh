@@ -0,0 +1,171 @@
+#!/usr/bin/env bash
+# Match-readiness soak: N camera feeders (one process each, as run6.bat starts them)
+# against synthetic frame folders for a configurable duration. Every SAMPLE_SECONDS
+# it records RSS, CPU per thread, open FDs, TS/CSV sizes, behind-schedule count and
+# PTS-vs-wall-clock drift per camera into samples.csv, then checks the run against
+# the budgets below and exits 1 if any is exceeded.
+#
+# Usage: bench/run_soak.sh <build_dir> [seconds] [fps] [cameras]
+#   SAMPLE_SECONDS=5  WARMUP_SECONDS=30      sampling period / samples ignored for growth baselines
+#   BENCH_DIR=/dev/shm/feeder_soak           frames (tmpfs) and logs
+#   OUT_DIR=$BENCH_DIR/out                   TS + CSV output; use a real disk for multi-hour runs
+#   PRODUCER_ARGS=... FEEDER_ARGS=...        extra frame_producer / appsrc_feeder flags
+# Budgets (per camera):
+#   MAX_RSS_GROWTH_MB=64  MAX_FD_GROWTH=8  MAX_BEHIND_PER_MIN=30  MAX_DRIFT_MS=50
+#   MIN_FPS_RATIO=0.99    MAX_THREAD_CPU_PCT=90
+set -euo pipefail
+
+BUILD_DIR=${1:?build dir with appsrc_feeder and frame_producer}
+DURATION=${2:-3600}
+FPS=${3:-300}
+CAMERAS=${4:-3}
+INTERVAL=${SAMPLE_SECONDS:-5}
+WARMUP=${WARMUP_SECONDS:-30}
+BASE_PORT=${METRICS_PORT:-19200}
+WORK=${BENCH_DIR:-/dev/shm/feeder_soak.$$}
+OUT=${OUT_DIR:-$WORK/out}
+FEEDER="$(realpath "$BUILD_DIR/appsrc_feeder")"
+PRODUCER="$(realpath "$BUILD_DIR/frame_producer")"
+SAMPLES="$WORK/samples.csv"
+REPORT="$WORK/report.txt"
+
+MAX_RSS_GROWTH_MB=${MAX_RSS_GROWTH_MB:-64}
+MAX_FD_GROWTH=${MAX_FD_GROWTH:-8}
+MAX_BEHIND_PER_MIN=${MAX_BEHIND_PER_MIN:-30}
+MAX_DRIFT_MS=${MAX_DRIFT_MS:-50}
+MIN_FPS_RATIO=${MIN_FPS_RATIO:-0.99}
+MAX_THREAD_CPU_PCT=${MAX_THREAD_CPU_PCT:-90}
+
+CLK_TCK=$(getconf CLK_TCK)
+PIDS=()
+cleanup() {
+    kill "${PIDS[@]}" 2>/dev/null || true
+    wait 2>/dev/null || true
+    rm -rf "$WORK"/frames_*
+}
+trap cleanup EXIT
+
+now() { date +%s.%N; }
+metrics_of() { curl -s --max-time 2 "http://127.0.0.1:$((BASE_PORT + $1))/metrics" || true; }
+metric() { echo "$1" | awk -v n="$2" -v f="${3:-}" '$1 ~ "^"n"[{ ]" && index($0, f) {s += $2} END {print s + 0}'; }
+
+declare -a FEEDER_PID CAM_NAME
+for ((c = 1; c <= CAMERAS; c++)); do
+    cam=$(printf 'camera%02d' "$c")
+    CAM_NAME[$c]=$cam
+    mkdir -p "$WORK/frames_$cam" "$OUT/$cam"
+    "$PRODUCER" "$WORK/frames_$cam" --camera="$cam" --fps="$FPS" --start=1 --keep=$((FPS * 10)) \
+        ${PRODUCER_ARGS:-} 2> "$WORK/producer_$cam.log" &
+    PIDS+=($!)
+done
+sleep 0.5
+for ((c = 1; c <= CAMERAS; c++)); do
+    cam=${CAM_NAME[$c]}
+    # Summary/audio CSVs land in the working directory, so one per camera
+    (cd "$OUT/$cam" && exec "$FEEDER" 1 "$FPS" "$WORK/frames_$cam" "$OUT/$cam/out.ts" "$OUT/$cam/out.csv" "$cam" \
+        --no-audio --skip-missing-ms=50 --redis=off --metrics=127.0.0.1:$((BASE_PORT + c)) ${FEEDER_ARGS:-}) \
+        > "$WORK/feeder_$cam.out" 2> "$WORK/feeder_$cam.log" &
+    FEEDER_PID[$c]=$!
+    PIDS+=($!)
+done
+
+echo "t_s,camera,alive,rss_mb,fds,cpu_pct,top_thread,top_thread_pct,ts_mb,csv_mb,frames,behind,drift_ms" > "$SAMPLES"
+echo "[soak] $CAMERAS cameras at $FPS fps for ${DURATION}s, sampling every ${INTERVAL}s -> $SAMPLES"
+
+declare -A PREV_TICKS
+declare -a PTS0 WALL0
+T_START=$(now)
+PREV_T=$T_START
+while :; do
+    sleep "$INTERVAL"
+    T=$(now)
+    ELAPSED=$(awk -v a="$T" -v b="$T_START" 'BEGIN {printf "%.1f", a - b}')
+    DT=$(awk -v a="$T" -v b="$PREV_T" 'BEGIN {print a - b}')
+    PREV_T=$T
+    for ((c = 1; c <= CAMERAS; c++)); do
+        cam=${CAM_NAME[$c]}
+        pid=${FEEDER_PID[$c]}
+        if [[ ! -d /proc/$pid ]]; then
+            echo "$ELAPSED,$cam,0,0,0,0,,0,0,0,0,0,0" >> "$SAMPLES"
+            continue
+        fi
+        rss_mb=$(awk '/^VmRSS/ {printf "%.1f", $2 / 1024}' "/proc/$pid/status")
+        fds=$(ls "/proc/$pid/fd" 2>/dev/null | wc -l || true)
+
+        # Per-thread CPU over the last interval; comm may contain spaces, so split after ")"
+        cpu_total=0 top_name="" top_pct=0
+        for task in /proc/$pid/task/*; do
+            tid=${task##*/}
+            stat=$(cat "$task/stat" 2>/dev/null) || continue
+            name=$(tr ' ,' '__' < "$task/comm" 2>/dev/null) || continue
+            ticks=$(echo "${stat##*) }" | awk '{print $12 + $13}')
+            prev=${PREV_TICKS[$c:$tid]:-$ticks}
+            PREV_TICKS[$c:$tid]=$ticks
+            pct=$(awk -v d=$((ticks - prev)) -v hz="$CLK_TCK" -v dt="$DT" 'BEGIN {printf "%.1f", d / hz / dt * 100}')
+            cpu_total=$(awk -v a="$cpu_total" -v b="$pct" 'BEGIN {print a + b}')
+            if awk -v a="$pct" -v b="$top_pct" 'BEGIN {exit !(a > b)}'; then top_name=$name; top_pct=$pct; fi
+        done
+
+        ts_mb=$( (stat -c %s "$OUT/$cam/out.ts" 2>/dev/null || echo 0) | awk '{printf "%.1f", $1 / 1048576}')
+        csv_mb=$( (cat "$OUT/$cam"/*.csv 2>/dev/null || true) | wc -c | awk '{printf "%.2f", $1 / 1048576}')
+
+        TC=$(now)       # per camera: the loop above takes a while with many threads
+        M=$(metrics_of "$c")
+        frames=$(metric "$M" feeder_frames_pushed_total)
+        behind=$(metric "$M" feeder_behind_schedule_total)
+        pts=$(metric "$M" feeder_last_pts_seconds 'stream="video"')
+        # Live PTS is pipeline running time: it should advance exactly as fast as the wall clock
+        drift_ms=0
+        if awk -v p="$pts" 'BEGIN {exit !(p > 0)}'; then
+            if [[ -z ${PTS0[$c]:-} ]]; then PTS0[$c]=$pts; WALL0[$c]=$TC; fi
+            drift_ms=$(awk -v p="$pts" -v p0="${PTS0[$c]}" -v w="$TC" -v w0="${WALL0[$c]}" \
+                'BEGIN {printf "%.1f", ((p - p0) - (w - w0)) * 1000}')
+        fi
+        echo "$ELAPSED,$cam,1,${rss_mb:-0},$fds,$cpu_total,$top_name,$top_pct,${ts_mb:-0},$csv_mb,$frames,$behind,$drift_ms" >> "$SAMPLES"
+    done
+    awk -F, -v t="$ELAPSED" '$1 == t {printf "[soak] t=%ss %s rss=%sMB fds=%s cpu=%s%% frames=%s behind=%s drift=%sms\n", $1, $2, $4, $5, $6, $11, $12, $13}' "$SAMPLES"
+    awk -v e="$ELAPSED" -v d="$DURATION" 'BEGIN {exit !(e >= d)}' && break
+done
+
+STATUS=0
+# Budgets: growth is measured from the first sample after warm-up to the last one
+awk -F, -v warm="$WARMUP" -v fps="$FPS" \
+    -v max_rss="$MAX_RSS_GROWTH_MB" -v max_fd="$MAX_FD_GROWTH" -v max_behind="$MAX_BEHIND_PER_MIN" \
+    -v max_drift="$MAX_DRIFT_MS" -v min_ratio="$MIN_FPS_RATIO" -v max_thread="$MAX_THREAD_CPU_PCT" '
+    NR == 1 { next }
+    {
+        cam = $2; if (!(cam in seen)) { seen[cam] = 1; cams[++ncams] = cam }
+        if (!$3) { dead[cam] = $1; next }
+        if ($1 < warm) next
+        if (!(cam in t0)) { t0[cam] = $1; rss0[cam] = $4; fd0[cam] = $5; fr0[cam] = $11; bh0[cam] = $12 }
+        t1[cam] = $1; rss1[cam] = $4; fd1[cam] = $5; fr1[cam] = $11; bh1[cam] = $12
+        if ($4 > rss_peak[cam]) rss_peak[cam] = $4
+        d = $13 < 0 ? -$13 : $13; if (d > drift[cam]) drift[cam] = d
+        if ($8 > thr[cam]) { thr[cam] = $8; thr_name[cam] = $7 }
+        cpu_sum[cam] += $6; n[cam]++
+        ts[cam] = $9; csv[cam] = $10
+    }
+    function check(ok) { if (!ok) fail = 1; return ok ? "ok" : "FAIL" }
+    END {
+        for (i = 1; i <= ncams; i++) {
+            cam = cams[i]
+            if (cam in dead) { printf "%s: feeder exited at t=%ss  FAIL\n", cam, dead[cam]; fail = 1; continue }
+            if (!n[cam]) { printf "%s: no samples after warm-up  FAIL\n", cam; fail = 1; continue }
+            span = t1[cam] - t0[cam]
+            fps_got = span > 0 ? (fr1[cam] - fr0[cam]) / span : 0
+            behind_min = span > 0 ? (bh1[cam] - bh0[cam]) / span * 60 : 0
+            printf "%s over %.0fs:\n", cam, span
+            printf "  fps            %8.1f  (min %.1f)  %s\n", fps_got, fps * min_ratio, check(span == 0 || fps_got >= fps * min_ratio)
+            printf "  rss growth     %+8.1f MB (peak %.1f, budget %s)  %s\n", rss1[cam] - rss0[cam], rss_peak[cam], max_rss, check(rss1[cam] - rss0[cam] <= max_rss)
+            printf "  fd growth      %+8d  (budget %s)  %s\n", fd1[cam] - fd0[cam], max_fd, check(fd1[cam] - fd0[cam] <= max_fd)
+            printf "  behind/min     %8.1f  (budget %s)  %s\n", behind_min, max_behind, check(behind_min <= max_behind)
+            printf "  max |drift|    %8.1f ms (budget %s)  %s\n", drift[cam], max_drift, check(drift[cam] <= max_drift)
+            printf "  busiest thread %8.1f %% (%s, budget %s)  %s\n", thr[cam], thr_name[cam] == "" ? "-" : thr_name[cam], max_thread, check(thr[cam] <= max_thread)
+            printf "  avg cpu        %8.1f %%\n", cpu_sum[cam] / n[cam]
+            printf "  output         %8.1f MB TS, %.2f MB CSV\n", ts[cam], csv[cam]
+        }
+        printf "RESULT: %s\n", fail ? "FAIL" : "PASS"
+        exit fail
+    }' "$SAMPLES" | tee "$REPORT" || STATUS=$?
+echo "[soak] samples: $SAMPLES  report: $REPORT  logs: $WORK"
+exit "$STATUS"
@@ -0,0 +1,609 @@
+// Post-match check of a recorded appsrc_feeder .ts, in one pass over the mapped file:
+//
+//  * sync bytes (with resync), continuity counters per PID
+//  * PCR interval and jitter (PCR against the packet position between its neighbours)
+//  * PTS/DTS monotonicity per elementary stream
+//  * video frame count (PES starts) against the rows of the feeder's frame CSV
+//  * A/V skew: last video PTS minus last audio PTS, as the --sim-hours report measures it
+//
+// Prints a summary and exits 0 (pass), 2 (violations) or 1 (cannot read). --series
+// writes one CSV row per second of PCR time for plotting.
+//
+// A --self-heal restart splices a new mux run into the file (new PAT/PMT, continuity
+// counters and PCR from scratch). The feeder logs where to <recording>.ts.splices.csv,
+// which is read when present (or --splices=FILE): continuity and the PCR interval are
+// not checked across a splice, and frames discarded in restarts may miss from the TS.
+//
+// Only the 4-byte header, the adaptation field and the first bytes of PES headers are
+// read, so the scan runs at the rate the file can be paged in.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t TS = 188;
+constexpr int64_t PCR_HZ = 27000000;
+constexpr int64_t PCR_WRAP = (int64_t(1) << 33) * 300;
+constexpr int64_t PTS_WRAP = int64_t(1) << 33;
+
+struct Options {
+    std::string ts;
+    std::string csv;                     // feeder frame CSV (output_full.csv)
+    std::string series;                  // per-second CSV out
+    std::string splices;                 // restart splice log (ByteOffset,DiscardedFrames)
+    double pcr_max_ms = 100.0;           // ISO/IEC 13818-1; DVB asks for 40
+    double max_skew_ms = 100.0;          // as SimBudget::max_av_skew_ms
+};
+
+class MappedFile {
+public:
+    ~MappedFile() { close(); }
+    bool open(const std::string& path) {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(file_, &sz)) return false;
+        size_ = static_cast<size_t>(sz.QuadPart);
+        if (!size_) return true;
+        map_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!map_) return false;
+        data_ = static_cast<const uint8_t*>(MapViewOfFile(map_, FILE_MAP_READ, 0, 0, 0));
+        return data_ != nullptr;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* p = size_ ? mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        if (p) {
+            madvise(p, size_, MADV_SEQUENTIAL);
+            madvise(p, size_, MADV_WILLNEED);
+        }
+        data_ = static_cast<const uint8_t*>(p);
+        return true;
+#endif
+    }
+    void close() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (map_) CloseHandle(map_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        map_ = NULL;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE map_ = NULL;
+#endif
+};
+
+enum StreamKind { KIND_OTHER, KIND_VIDEO, KIND_AUDIO };
+
+struct PidState {
+    StreamKind kind = KIND_OTHER;
+    uint8_t stream_type = 0;
+    int last_cc = -1;
+    bool last_had_payload = false;
+    uint64_t packets = 0;
+    uint64_t cc_errors = 0;
+    uint64_t pes = 0;
+    uint64_t ts_regressions = 0;         // PTS (audio) / DTS or PTS (video) not above the previous
+    int64_t last_ts = -1;                // unwrapped 90 kHz
+    int64_t first_ts = -1;
+};
+
+struct Second {
+    uint64_t packets = 0;
+    uint64_t video_frames = 0;
+    uint64_t audio_pes = 0;
+    uint64_t cc_errors = 0;
+    uint64_t pcrs = 0;
+    double pcr_max_interval_ms = 0;
+    double pcr_max_jitter_us = 0;
+    int64_t last_video_pts = -1;
+    int64_t last_audio_pts = -1;
+};
+
+struct PcrSample {
+    size_t pos;                          // packet number
+    int64_t pcr;                         // unwrapped 27 MHz
+};
+
+const char* kind_name(StreamKind k) {
+    return k == KIND_VIDEO ? "video" : k == KIND_AUDIO ? "audio" : "other";
+}
+
+StreamKind classify(uint8_t stream_type) {
+    switch (stream_type) {
+    case 0x01: case 0x02: case 0x10: case 0x1b: case 0x24:
+        return KIND_VIDEO;
+    case 0x03: case 0x04: case 0x0f: case 0x11: case 0x81:
+    case 0x06:                           // private data: mpegtsmux carries Opus this way
+        return KIND_AUDIO;
+    default:
+        return KIND_OTHER;
+    }
+}
+
+int64_t read_ts90k(const uint8_t* p) {
+    return (int64_t(p[0] & 0x0e) << 29) | (int64_t(p[1]) << 22) | (int64_t(p[2] & 0xfe) << 14) |
+           (int64_t(p[3]) << 7) | (p[4] >> 1);
+}
+
+// Unwrap a counter that wraps at `wrap` against the previous unwrapped value
+int64_t unwrap(int64_t raw, int64_t prev, int64_t wrap) {
+    if (prev < 0) return raw;
+    int64_t base = prev - prev % wrap;
+    int64_t v = base + raw;
+    if (v < prev - wrap / 2) v += wrap;
+    else if (v > prev + wrap / 2 && v >= wrap) v -= wrap;
+    return v;
+}
+
+class Analyzer {
+public:
+    explicit Analyzer(const Options& o) : o_(o) {}
+
+    // Byte offsets where a restarted mux run begins, ascending
+    void set_splices(std::vector<uint64_t> offsets, uint64_t discarded) {
+        splices_ = std::move(offsets);
+        splice_discarded_ = discarded;
+    }
+
+    void run(const uint8_t* data, size_t size) {
+        size_t off = 0;
+        size_t next_splice = 0;
+        while (off + TS <= size) {
+            const uint8_t* p = data + off;
+            for (; next_splice < splices_.size() && off >= splices_[next_splice]; ++next_splice) splice();
+            if (p[0] != 0x47) {
+                ++sync_errors_;
+                size_t next = resync(data, size, off + 1);
+                lost_bytes_ += next - off;
+                off = next;
+                continue;
+            }
+            packet(p);
+            off += TS;
+        }
+        trailing_bytes_ = size - std::min(off, size);
+    }
+
+    bool report(std::ostream& os, size_t bytes, double seconds) const;
+    bool write_series(const std::string& path) const;
+
+private:
+    // Next offset with sync bytes on three consecutive packets (or the end)
+    static size_t resync(const uint8_t* data, size_t size, size_t from) {
+        for (size_t o = from; o + TS <= size; ++o) {
+            if (data[o] != 0x47) continue;
+            if (o + 2 * TS < size && (data[o + TS] != 0x47 || data[o + 2 * TS] != 0x47)) continue;
+            return o;
+        }
+        return size;
+    }
+
+    // Nothing carries over from the previous mux run but the timestamps
+    void splice() {
+        for (PidState& st : pids_) st.last_cc = -1;
+        pcr_n_ = 0;
+        pcr_after_splice_ = true;
+    }
+
+    // Second of PCR time; a PCR below the first one (regression, or a restart after a
+    // splice) goes into second 0 rather than wrapping to a huge index
+    size_t pcr_second(int64_t pcr) const {
+        return pcr > first_pcr_ ? static_cast<size_t>((pcr - first_pcr_) / PCR_HZ) : 0;
+    }
+
+    Second& sec() {
+        size_t s = pcr_seen_ ? pcr_second(last_pcr_) : 0;
+        if (s >= seconds_.size()) seconds_.resize(s + 1);
+        return seconds_[s];
+    }
+
+    void packet(const uint8_t* p) {
+        uint16_t pid = static_cast<uint16_t>(((p[1] & 0x1f) << 8) | p[2]);
+        bool pusi = p[1] & 0x40;
+        uint8_t afc = (p[3] >> 4) & 3;
+        uint8_t cc = p[3] & 0x0f;
+        size_t pos = packets_++;
+        if (pid == 0x1fff) return;
+
+        PidState& st = pids_[pid];
+        ++st.packets;
+        bool has_payload = afc & 1;
+        size_t payload = 4;
+        bool discontinuity = false;
+        if (afc & 2) {
+            uint8_t af_len = p[4];
+            payload = 5 + af_len;
+            if (af_len && p[5] & 0x80) discontinuity = true;
+            if (af_len >= 7 && (p[5] & 0x10) && pid == pcr_pid_) pcr(p + 6, pos);
+        }
+        sec().packets++;
+
+        // Continuity: +1 per payload packet; one repeat is legal, no payload keeps the counter
+        if (st.last_cc >= 0 && !discontinuity) {
+            int expect = has_payload ? (st.last_cc + 1) & 0x0f : st.last_cc;
+            bool repeat = has_payload && st.last_had_payload && cc == st.last_cc;
+            if (cc != expect && !repeat) {
+                ++st.cc_errors;
+                ++sec().cc_errors;
+            }
+        }
+        st.last_cc = cc;
+        st.last_had_payload = has_payload;
+        if (!has_payload || payload >= TS) return;
+
+        const uint8_t* pl = p + payload;
+        size_t len = TS - payload;
+        if (pid == 0 && pusi) pat(pl, len);
+        else if (pmt_pids_[pid] && pusi) pmt(pl, len);
+        else if (pusi && st.kind != KIND_OTHER) pes(st, pl, len);
+    }
+
+    void pat(const uint8_t* pl, size_t len) {
+        size_t ptr = pl[0];
+        if (1 + ptr + 8 > len) return;
+        const uint8_t* s = pl + 1 + ptr;
+        if (s[0] != 0x00) return;
+        size_t sec_len = ((s[1] & 0x0f) << 8) | s[2];
+        if (sec_len < 9) return;         // 5 header bytes after the length + CRC: no room for a program
+        size_t end = std::min(len - 1 - ptr, 3 + sec_len) - 4;   // minus CRC; >= 4 from the checks above
+        for (size_t i = 8; i + 4 <= end; i += 4) {
+            uint16_t program = static_cast<uint16_t>((s[i] << 8) | s[i + 1]);
+            uint16_t pid = static_cast<uint16_t>(((s[i + 2] & 0x1f) << 8) | s[i + 3]);
+            if (program) pmt_pids_[pid] = true;
+        }
+    }
+
+    void pmt(const uint8_t* pl, size_t len) {
+        size_t ptr = pl[0];
+        if (1 + ptr + 12 > len) return;
+        const uint8_t* s = pl + 1 + ptr;
+        if (s[0] != 0x02) return;
+        size_t sec_len = ((s[1] & 0x0f) << 8) | s[2];
+        if (sec_len < 13) return;        // header through program_info_length + CRC
+        size_t end = std::min(len - 1 - ptr, 3 + sec_len) - 4;   // >= 8 from the checks above
+        size_t i = 12 + (((s[10] & 0x0f) << 8) | s[11]);
+        if (i > end) return;             // program_info runs past the section (or this packet)
+        pcr_pid_ = static_cast<uint16_t>(((s[8] & 0x1f) << 8) | s[9]);
+        for (; i + 5 <= end; i += 5 + (((s[i + 3] & 0x0f) << 8) | s[i + 4])) {
+            uint16_t pid = static_cast<uint16_t>(((s[i + 1] & 0x1f) << 8) | s[i + 2]);
+            PidState& st = pids_[pid];
+            st.stream_type = s[i];
+            st.kind = classify(s[i]);
+        }
+    }
+
+    void pes(PidState& st, const uint8_t* pl, size_t len) {
+        if (len < 9 || pl[0] != 0 || pl[1] != 0 || pl[2] != 1) return;
+        ++st.pes;
+        Second& s = sec();
+        if (st.kind == KIND_VIDEO) {
+            ++video_frames_;
+            ++s.video_frames;
+        } else {
+            ++s.audio_pes;
+        }
+        uint8_t flags = pl[7] >> 6;
+        if (!(flags & 2) || len < 14) return;
+        int64_t pts = unwrap(read_ts90k(pl + 9), st.last_ts, PTS_WRAP);
+        int64_t order = pts;
+        if (flags == 3 && len >= 19) order = unwrap(read_ts90k(pl + 14), st.last_ts, PTS_WRAP);
+        if (st.last_ts >= 0 && order <= st.last_ts) ++st.ts_regressions;
+        st.last_ts = order;
+        if (st.first_ts < 0) st.first_ts = order;
+        if (st.kind == KIND_VIDEO) {
+            last_video_pts_ = pts;
+            s.last_video_pts = pts;
+        } else {
+            last_audio_pts_ = pts;
+            s.last_audio_pts = pts;
+        }
+        if (last_video_pts_ >= 0 && last_audio_pts_ >= 0) {
+            double skew = (last_video_pts_ - last_audio_pts_) / 90.0;
+            max_abs_skew_ms_ = std::max(max_abs_skew_ms_, std::fabs(skew));
+        }
+    }
+
+    void pcr(const uint8_t* f, size_t pos) {
+        int64_t base = (int64_t(f[0]) << 25) | (int64_t(f[1]) << 17) | (int64_t(f[2]) << 9) |
+                       (int64_t(f[3]) << 1) | (f[4] >> 7);
+        int64_t ext = ((f[4] & 1) << 8) | f[5];
+        int64_t v = unwrap(base * 300 + ext, pcr_seen_ ? last_pcr_ : -1, PCR_WRAP);
+        // The gap across a restart splice is the recovery time, not a PCR interval
+        bool check = pcr_seen_ && !pcr_after_splice_;
+        double interval_ms = check ? (v - last_pcr_) * 1000.0 / PCR_HZ : 0.0;
+        if (!pcr_seen_) first_pcr_ = v;
+        else if (interval_ms > o_.pcr_max_ms) ++pcr_late_;
+        else if (interval_ms < 0) ++pcr_regressions_;
+        if (pcr_seen_ && v < first_pcr_) ++pcr_below_first_;
+        pcr_seen_ = true;
+        pcr_after_splice_ = false;
+        last_pcr_ = v;
+        ++pcrs_;
+        max_pcr_interval_ms_ = std::max(max_pcr_interval_ms_, interval_ms);
+        Second& s = sec();
+        ++s.pcrs;
+        s.pcr_max_interval_ms = std::max(s.pcr_max_interval_ms, interval_ms);
+
+        if (pcr_n_ == 3) {
+            pcr_win_[0] = pcr_win_[1];
+            pcr_win_[1] = pcr_win_[2];
+            pcr_n_ = 2;
+        }
+        pcr_win_[pcr_n_++] = PcrSample{pos, v};
+        if (pcr_n_ == 3) pcr_jitter();
+    }
+
+    // Middle PCR against the straight line between its neighbours (constant rate between them)
+    void pcr_jitter() {
+        const PcrSample &a = pcr_win_[0], &b = pcr_win_[1], &c = pcr_win_[2];
+        if (c.pos == a.pos) return;
+        double expect = a.pcr + double(c.pcr - a.pcr) * double(b.pos - a.pos) / double(c.pos - a.pos);
+        double jitter_us = std::fabs(double(b.pcr) - expect) * 1e6 / PCR_HZ;
+        max_pcr_jitter_us_ = std::max(max_pcr_jitter_us_, jitter_us);
+        size_t s = pcr_second(b.pcr);
+        if (s < seconds_.size()) seconds_[s].pcr_max_jitter_us = std::max(seconds_[s].pcr_max_jitter_us, jitter_us);
+    }
+
+    const Options& o_;
+    // Indexed by PID: no lookup per packet
+    std::vector<PidState> pids_ = std::vector<PidState>(8192);
+    std::vector<bool> pmt_pids_ = std::vector<bool>(8192);
+    uint16_t pcr_pid_ = 0xffff;
+    std::vector<Second> seconds_;
+
+    std::vector<uint64_t> splices_;
+    uint64_t splice_discarded_ = 0;
+    bool pcr_after_splice_ = false;
+
+    uint64_t packets_ = 0, sync_errors_ = 0, lost_bytes_ = 0, trailing_bytes_ = 0;
+    uint64_t video_frames_ = 0;
+    bool pcr_seen_ = false;
+    int64_t first_pcr_ = 0, last_pcr_ = 0;
+    uint64_t pcrs_ = 0, pcr_late_ = 0, pcr_regressions_ = 0, pcr_below_first_ = 0;
+    double max_pcr_interval_ms_ = 0, max_pcr_jitter_us_ = 0;
+    PcrSample pcr_win_[3] = {};
+    int pcr_n_ = 0;
+    int64_t last_video_pts_ = -1, last_audio_pts_ = -1;
+    double max_abs_skew_ms_ = 0;
+};
+
+// Data rows of the feeder's frame CSV (header line excluded)
+bool count_csv_rows(const std::string& path, uint64_t& rows) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    std::vector<char> buf(1 << 20);
+    uint64_t lines = 0;
+    while (f.read(buf.data(), static_cast<std::streamsize>(buf.size())) || f.gcount()) {
+        lines += static_cast<uint64_t>(std::count(buf.data(), buf.data() + f.gcount(), '\n'));
+    }
+    rows = lines ? lines - 1 : 0;
+    return true;
+}
+
+// <recording>.ts.splices.csv written by the feeder's --self-heal: offsets and the
+// frames queued in the pipeline when it was restarted there
+bool read_splices(const std::string& path, std::vector<uint64_t>& offsets, uint64_t& discarded) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::string line;
+    std::getline(f, line);               // header
+    while (std::getline(f, line)) {
+        unsigned long long offset = 0, frames = 0;
+        if (sscanf(line.c_str(), "%llu,%llu", &offset, &frames) < 1) continue;
+        offsets.push_back(offset);
+        discarded += frames;
+    }
+    std::sort(offsets.begin(), offsets.end());
+    return true;
+}
+
+bool Analyzer::report(std::ostream& os, size_t bytes, double seconds) const {
+    bool ok = true;
+    char line[256];
+    auto verdict = [&](bool good) {
+        ok = ok && good;
+        return good ? "ok" : "FAIL";
+    };
+
+    snprintf(line, sizeof(line), "file        : %s, %.2f GB, %llu packets, scanned in %.2f s (%.2f GB/s)\n",
+             o_.ts.c_str(), bytes / 1e9, static_cast<unsigned long long>(packets_), seconds,
+             seconds > 0 ? bytes / 1e9 / seconds : 0.0);
+    os << line;
+    snprintf(line, sizeof(line), "sync        : %llu errors, %llu bytes skipped, %llu trailing  [%s]\n",
+             static_cast<unsigned long long>(sync_errors_), static_cast<unsigned long long>(lost_bytes_),
+             static_cast<unsigned long long>(trailing_bytes_), verdict(sync_errors_ == 0 && trailing_bytes_ == 0));
+    os << line;
+
+    if (!splices_.empty()) {
+        snprintf(line, sizeof(line),
+                 "restarts    : %zu splices from %s, %llu queued frames discarded (continuity, PCR interval "
+                 "not checked across)\n",
+                 splices_.size(), o_.splices.c_str(), static_cast<unsigned long long>(splice_discarded_));
+        os << line;
+    }
+
+    uint64_t cc_total = 0, regress_total = 0;
+    for (size_t pid = 0; pid < pids_.size(); ++pid) {
+        const PidState& st = pids_[pid];
+        cc_total += st.cc_errors;
+        if (st.kind != KIND_OTHER) regress_total += st.ts_regressions;
+        if (!st.packets || pid == 0 || pmt_pids_[pid]) continue;
+        double span_s = st.first_ts >= 0 ? (st.last_ts - st.first_ts) / 90000.0 : 0.0;
+        snprintf(line, sizeof(line),
+                 "pid 0x%04x  : %-5s type 0x%02x, %llu packets, %llu PES over %.1f s, %llu cc errors, %llu %s regressions\n",
+                 static_cast<unsigned>(pid), kind_name(st.kind), st.stream_type, static_cast<unsigned long long>(st.packets),
+                 static_cast<unsigned long long>(st.pes), span_s, static_cast<unsigned long long>(st.cc_errors),
+                 static_cast<unsigned long long>(st.ts_regressions), st.kind == KIND_VIDEO ? "DTS" : "PTS");
+        os << line;
+    }
+    snprintf(line, sizeof(line), "continuity  : %llu errors  [%s]\n", static_cast<unsigned long long>(cc_total),
+             verdict(cc_total == 0));
+    os << line;
+    snprintf(line, sizeof(line), "timestamps  : %llu regressions  [%s]\n", static_cast<unsigned long long>(regress_total),
+             verdict(regress_total == 0));
+    os << line;
+    if (pcr_pid_ == 0xffff || !pcrs_) {
+        os << "pcr         : none found  [" << verdict(false) << "]\n";
+    } else {
+        snprintf(line, sizeof(line),
+                 "pcr         : pid 0x%04x, %llu samples over %.1f s, max interval %.1f ms (%llu above %.0f ms), "
+                 "%llu regressions (%llu below the first PCR), max jitter %.0f us  [%s]\n",
+                 pcr_pid_, static_cast<unsigned long long>(pcrs_), (last_pcr_ - first_pcr_) / double(PCR_HZ),
+                 max_pcr_interval_ms_, static_cast<unsigned long long>(pcr_late_), o_.pcr_max_ms,
+                 static_cast<unsigned long long>(pcr_regressions_), static_cast<unsigned long long>(pcr_below_first_),
+                 max_pcr_jitter_us_, verdict(pcr_late_ == 0 && pcr_regressions_ == 0));
+        os << line;
+    }
+    if (!o_.csv.empty()) {
+        uint64_t rows = 0;
+        if (!count_csv_rows(o_.csv, rows)) {
+            os << "frames      : " << video_frames_ << " in the TS, cannot read " << o_.csv << "  [" << verdict(false) << "]\n";
+        } else if (splices_.empty()) {
+            snprintf(line, sizeof(line), "frames      : %llu in the TS, %llu CSV rows  [%s]\n",
+                     static_cast<unsigned long long>(video_frames_), static_cast<unsigned long long>(rows),
+                     verdict(rows == video_frames_));
+            os << line;
+        } else {
+            // Frames in the CSV that a restart discarded (queued or inside the mux) never reached the TS
+            snprintf(line, sizeof(line), "frames      : %llu in the TS, %llu CSV rows, %lld lost in restarts  [%s]\n",
+                     static_cast<unsigned long long>(video_frames_), static_cast<unsigned long long>(rows),
+                     static_cast<long long>(rows) - static_cast<long long>(video_frames_),
+                     verdict(video_frames_ <= rows));
+            os << line;
+        }
+    } else {
+        os << "frames      : " << video_frames_ << " in the TS\n";
+    }
+    if (last_video_pts_ >= 0 && last_audio_pts_ >= 0) {
+        snprintf(line, sizeof(line), "a/v skew    : %.1f ms at the end, max |skew| %.1f ms (budget %.0f ms)  [%s]\n",
+                 (last_video_pts_ - last_audio_pts_) / 90.0, max_abs_skew_ms_, o_.max_skew_ms,
+                 verdict(max_abs_skew_ms_ <= o_.max_skew_ms));
+        os << line;
+    } else {
+        os << "a/v skew    : no " << (last_video_pts_ < 0 ? "video" : "audio") << " PTS\n";
+    }
+    os << "result      : " << (ok ? "PASS" : "FAIL") << "\n";
+    return ok;
+}
+
+bool Analyzer::write_series(const std::string& path) const {
+    std::ofstream f(path);
+    if (!f) return false;
+    f << "second,packets,kbps,video_frames,audio_pes,cc_errors,pcrs,pcr_max_interval_ms,pcr_max_jitter_us,av_skew_ms\n";
+    char line[256];
+    for (size_t i = 0; i < seconds_.size(); ++i) {
+        const Second& s = seconds_[i];
+        char skew[32] = "NA";
+        if (s.last_video_pts >= 0 && s.last_audio_pts >= 0)
+            snprintf(skew, sizeof(skew), "%.1f", (s.last_video_pts - s.last_audio_pts) / 90.0);
+        snprintf(line, sizeof(line), "%zu,%llu,%.0f,%llu,%llu,%llu,%llu,%.2f,%.0f,%s\n", i,
+                 static_cast<unsigned long long>(s.packets), s.packets * TS * 8 / 1000.0,
+                 static_cast<unsigned long long>(s.video_frames), static_cast<unsigned long long>(s.audio_pes),
+                 static_cast<unsigned long long>(s.cc_errors), static_cast<unsigned long long>(s.pcrs),
+                 s.pcr_max_interval_ms, s.pcr_max_jitter_us, skew);
+        f << line;
+    }
+    return static_cast<bool>(f);
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " <recording.ts> [--csv=output_full.csv] [--series=per_second.csv]"
+              << " [--pcr-max-ms=100] [--max-skew-ms=100] [--splices=recording.ts.splices.csv]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    Options o;
+    o.ts = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        auto val = [&](const char* key) -> const char* {
+            size_t n = strlen(key);
+            return a.compare(0, n, key) == 0 ? a.c_str() + n : nullptr;
+        };
+        if (const char* v = val("--csv=")) o.csv = v;
+        else if (const char* v = val("--series=")) o.series = v;
+        else if (const char* v = val("--pcr-max-ms=")) o.pcr_max_ms = std::stod(v);
+        else if (const char* v = val("--max-skew-ms=")) o.max_skew_ms = std::stod(v);
+        else if (const char* v = val("--splices=")) o.splices = v;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    MappedFile file;
+    if (!file.open(o.ts)) {
+        std::cerr << "Cannot map " << o.ts << "\n";
+        return 1;
+    }
+    Analyzer an(o);
+    std::vector<uint64_t> splices;
+    uint64_t discarded = 0;
+    if (!o.splices.empty()) {
+        if (!read_splices(o.splices, splices, discarded)) {
+            std::cerr << "Cannot read " << o.splices << "\n";
+            return 1;
+        }
+    } else if (read_splices(o.ts + ".splices.csv", splices, discarded)) {
+        o.splices = o.ts + ".splices.csv";
+    }
+    an.set_splices(std::move(splices), discarded);
+    auto t0 = std::chrono::steady_clock::now();
+    an.run(file.data(), file.size());
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    bool ok = an.report(std::cout, file.size(), secs);
+    if (!o.series.empty() && !an.write_series(o.series)) {
+        std::cerr << "Cannot write " << o.series << "\n";
+        return 1;
+    }
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,137 @@
+// Reference consumer for appsrc_feeder --shm-out=NAME: attaches to the video ring
+// (video_ring.h) read-only, follows it and prints once a second how many AUs arrived,
+// how many it lost by falling behind, and the publish-to-read latency. --dump writes the
+// AUs to an Annex B .hevc file; --meta prints the metadata of every keyframe.
+//
+// Processing happens in place in the ring; only after it is the AU checked for having
+// been overwritten meanwhile (a "torn" read, counted and discarded).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "video_ring.h"
+
+namespace {
+
+struct Options {
+    std::string ring;
+    double seconds = 0.0;                // 0 = run until killed
+    bool from_oldest = false;            // start with the oldest AU still in the ring
+    std::string dump;
+    bool meta = false;
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " <ring_name> [--seconds=S] [--from=oldest|live] [--dump=out.hevc] [--meta]\n";
+}
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t percentile(std::vector<int64_t>& v, double p) {
+    if (v.empty()) return 0;
+    size_t k = std::min(v.size() - 1, static_cast<size_t>(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    Options o;
+    o.ring = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        auto val = [&](const char* key) -> const char* {
+            size_t n = strlen(key);
+            return a.compare(0, n, key) == 0 ? a.c_str() + n : nullptr;
+        };
+        if (const char* v = val("--seconds=")) o.seconds = std::stod(v);
+        else if (a == "--from=oldest") o.from_oldest = true;
+        else if (a == "--from=live") o.from_oldest = false;
+        else if (const char* v = val("--dump=")) o.dump = v;
+        else if (a == "--meta") o.meta = true;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    VideoRing ring;
+    while (!ring.open(o.ring)) {
+        std::cerr << "[reader] Waiting for video ring " << o.ring << "...\n";
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    std::cout << "[reader] Attached to " << o.ring << ": " << ring.slot_count() << " slots x "
+              << ring.slot_size() / 1024 << " KB\n";
+    std::ofstream dump;
+    if (!o.dump.empty()) dump.open(o.dump, std::ios::binary);
+
+    uint64_t next = ring.published();
+    if (o.from_oldest) next = next > ring.slot_count() ? next - ring.slot_count() + 1 : 0;
+    uint64_t total = 0, lost = 0, torn = 0, bytes = 0, keyframes = 0;
+    uint64_t sec_aus = 0, sec_lost = 0;
+    std::vector<int64_t> latency;
+    latency.reserve(4096);
+    const int64_t t_start = steady_ns();
+    int64_t t_report = t_start + 1000000000;
+    std::string chunk;
+
+    for (;;) {
+        int64_t now = steady_ns();
+        if (o.seconds > 0 && now - t_start >= static_cast<int64_t>(o.seconds * 1e9)) break;
+        if (now >= t_report) {
+            std::printf("[reader] %llu AU/s, %llu lost, latency p50 %.1f us p99 %.1f us\n",
+                        static_cast<unsigned long long>(sec_aus), static_cast<unsigned long long>(sec_lost),
+                        percentile(latency, 0.50) / 1e3, percentile(latency, 0.99) / 1e3);
+            std::fflush(stdout);
+            sec_aus = sec_lost = 0;
+            latency.clear();
+            t_report += 1000000000;
+        }
+
+        VideoRingAu au;
+        if (!ring.read(next, au, 100)) continue;
+        int64_t lat = steady_ns() - au.publish_ns;
+        lost += au.seq - next;
+        sec_lost += au.seq - next;
+        next = au.seq + 1;
+
+        // Consume in place, then check the slot was not reused meanwhile
+        bool key = !(au.flags & VIDEO_AU_DELTA);
+        if (dump.is_open()) chunk.assign(reinterpret_cast<const char*>(au.data), au.size);
+        std::string meta = o.meta && key ? std::string(au.meta) : std::string();
+        if (!ring.intact(au)) {
+            ++torn;
+            continue;
+        }
+        if (dump.is_open()) dump.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        if (o.meta && key) {
+            std::printf("[reader] keyframe %llu pts %.3f s: %s\n", static_cast<unsigned long long>(au.index),
+                        au.pts_ns >= 0 ? au.pts_ns / 1e9 : -1.0, meta.empty() ? "(no metadata)" : meta.c_str());
+        }
+        ++total;
+        ++sec_aus;
+        bytes += au.size;
+        keyframes += key;
+        latency.push_back(lat);
+    }
+
+    std::cout << "[reader] " << total << " AUs (" << keyframes << " keyframes, " << bytes / 1024 << " KB), "
+              << lost << " lost, " << torn << " torn, " << ring.oversize() << " too large for a slot\n";
+    return 0;
+}
@@ -0,0 +1,584 @@
+#include "feeder_core.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// === Frame files ===
+uint64_t find_first_index_fast(const std::string& folder) {
+    for (const auto& entry : fs::directory_iterator(folder)) {
+        if (entry.is_regular_file()) {
+
+            std::string fname = entry.path().filename().string();
+            if (fname.find("frame_camera01_") == 0 && fname.find(".hevc") != std::string::npos) {
+                std::string number_str = fname.substr(
+                    std::string("frame_camera01_").size(),
+                    fname.size() - std::string("frame_camera01_").size() - 5
+                );
+                try {
+                    return std::stoull(number_str);
+                } catch (...) {
+                    throw std::runtime_error("[error] Invalid file name: " + fname);
+                }
+            }
+        }
+    }
+    throw std::runtime_error("[error] No valid files found in folder: " + folder);
+}
+
+std::string make_frame_filename(const std::string& camera, uint64_t idx) {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "frame_%s_%09" PRIu64 ".hevc", camera.c_str(), idx);
+    return std::string(buf);
+}
+
+FramePathTemplate::FramePathTemplate(const std::string& folder, const std::string& camera) {
+    std::string name = "frame_" + camera + "_";
+    prefix_ = folder.empty() ? name : (fs::path(folder) / name).string();
+    name_pos_ = prefix_.size() - name.size();
+    at(0);
+}
+
+const std::string& FramePathTemplate::at(uint64_t idx) {
+    char digits[24];
+    int n = snprintf(digits, sizeof(digits), "%09" PRIu64, idx);
+    if (static_cast<size_t>(n) != digits_) {
+        // First call, or the index gained a digit: the only time this allocates
+        digits_ = static_cast<size_t>(n);
+        s_ = prefix_ + digits + ".hevc";
+    } else {
+        memcpy(&s_[prefix_.size()], digits, digits_);
+    }
+    return s_;
+}
+
+bool file_size_of(const char* path, uint64_t& size) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(path, &st) != 0 || !(st.st_mode & _S_IFREG)) return false;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+#endif
+    size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+bool file_size_of(const char* path, uint64_t& size, int64_t& mtime_ns) {
+#ifdef _WIN32
+    // _stat64 only has whole seconds
+    WIN32_FILE_ATTRIBUTE_DATA fa;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &fa) || (fa.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+        return false;
+    size = (static_cast<uint64_t>(fa.nFileSizeHigh) << 32) | fa.nFileSizeLow;
+    uint64_t ticks = (static_cast<uint64_t>(fa.ftLastWriteTime.dwHighDateTime) << 32) | fa.ftLastWriteTime.dwLowDateTime;
+    mtime_ns = static_cast<int64_t>(ticks - 116444736000000000ULL) * 100;   // 100 ns ticks since 1601
+#else
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+    mtime_ns = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+#endif
+    return true;
+}
+
+bool is_file_ready(const char* path, int max_attempts, int delay_ms) {
+    uint64_t last_size = 0, new_size = 0;
+    if (!file_size_of(path, last_size)) return false;
+    for (int i = 0; i < max_attempts; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        if (!file_size_of(path, new_size)) return false;
+        if (new_size == last_size) return true;
+        last_size = new_size;
+    }
+    return false;
+}
+
+bool is_iframe(const char* path) {
+    uint64_t size = 0;
+    return file_size_of(path, size) && size >= IFRAME_MIN_SIZE;
+}
+
+bool is_file_ready(const fs::path& path, int max_attempts, int delay_ms) {
+    if (!fs::exists(path)) return false;
+    auto last_size = fs::file_size(path);
+    for (int i = 0; i < max_attempts; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        if (!fs::exists(path)) return false;
+        auto new_size = fs::file_size(path);
+        if (new_size == last_size) return true;
+        last_size = new_size;
+    }
+    return false;
+}
+
+bool is_iframe(const fs::path& path) {
+    try {
+        if (!fs::exists(path)) return false;
+        return fs::file_size(path) >= IFRAME_MIN_SIZE;
+    } catch (...) {
+        return false;
+    }
+}
+
+std::vector<fs::path> list_frame_files(const std::string& folder, const std::string& camera) {
+    const std::string prefix = "frame_" + camera + "_";
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(folder)) {
+        std::string fname = entry.path().filename().string();
+        if (entry.is_regular_file() && fname.rfind(prefix, 0) == 0 && entry.path().extension() == ".hevc")
+            files.push_back(entry.path());
+    }
+    // Zero-padded indices sort correctly as strings
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+FrameReadStatus read_frame_file(const fs::path& path, std::vector<uint8_t>& out) {
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (!ifs) return FRAME_OPEN_FAILED;
+    std::streamsize size = ifs.tellg();
+    ifs.seekg(0, std::ios::beg);
+    out.resize(static_cast<size_t>(size));
+    if (!ifs.read(reinterpret_cast<char*>(out.data()), size)) return FRAME_READ_FAILED;
+    return FRAME_READ_OK;
+}
+
+FrameReadStatus read_frame_into(const char* path, uint8_t* dst, size_t cap, size_t& size) {
+#ifdef _WIN32
+    int fd = _open(path, _O_RDONLY | _O_BINARY);
+    if (fd < 0) return FRAME_OPEN_FAILED;
+    struct _stat64 st;
+    bool ok = _fstat64(fd, &st) == 0;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return FRAME_OPEN_FAILED;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+#endif
+    size = ok ? static_cast<size_t>(st.st_size) : 0;
+    FrameReadStatus rs = !ok ? FRAME_READ_FAILED : size > cap ? FRAME_TOO_LARGE : FRAME_READ_OK;
+    for (size_t done = 0; rs == FRAME_READ_OK && done < size;) {
+#ifdef _WIN32
+        int n = _read(fd, dst + done, static_cast<unsigned>(size - done));
+#else
+        ssize_t n = read(fd, dst + done, size - done);
+#endif
+        if (n <= 0) rs = FRAME_READ_FAILED;
+        else done += static_cast<size_t>(n);
+    }
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+    return rs;
+}
+
+// === Redis metadata ===
+std::string_view json_value(std::string_view json, std::string_view key) {
+    // First "key": in the text, same as searching for the quoted pattern
+    size_t pos = 0;
+    while ((pos = json.find(key, pos)) != std::string_view::npos) {
+        if (pos > 0 && json[pos - 1] == '"' && json.substr(pos + key.size(), 2) == "\":") break;
+        pos++;
+    }
+    if (pos == std::string_view::npos) return "NA";
+    pos += key.size() + 2; // move past key":
+    if (pos >= json.size()) return "NA";
+    // detect value type
+    if (json[pos] == '"') {
+        size_t end = json.find('"', pos + 1);
+        if (end == std::string_view::npos) return "NA";
+        return json.substr(pos + 1, end - pos - 1);
+    } else {
+        size_t end = json.find_first_of(",}", pos);
+        if (end == std::string_view::npos) return json.substr(pos);
+        return json.substr(pos, end - pos);
+    }
+}
+
+std::string json_extract(const std::string& json, const std::string& key) {
+    return std::string(json_value(json, key));
+}
+
+void FrameMetadata::reset() {
+    ball.assign("1"); frame_name.assign("NA"); innings.assign("1"); isStart.assign("false");
+    matchID.assign("123"); over.assign("1"); ptp_timestamp.assign("NA"); received_at.assign("NA");
+    size.assign("NA"); crc32c.assign("NA");
+}
+
+void parse_frame_metadata(std::string_view json, FrameMetadata& md) {
+    md.ball.assign(json_value(json, "ball"));
+    md.innings.assign(json_value(json, "innings"));
+    md.isStart.assign(json_value(json, "isStart"));
+    md.matchID.assign(json_value(json, "matchID"));
+    md.over.assign(json_value(json, "over"));
+    md.frame_name.assign(json_value(json, "frame_name"));
+    md.ptp_timestamp.assign(json_value(json, "ptp_timestamp"));
+    md.received_at.assign(json_value(json, "received_at"));
+    md.size.assign(json_value(json, "size"));
+    md.crc32c.assign(json_value(json, "crc32c"));
+}
+
+// === CSV rows ===
+void write_video_csv_row(std::ostream& os, uint64_t seq, bool has_pts, uint64_t pts_90k,
+                         std::string_view fname, const FrameMetadata& md, const uint32_t* crc) {
+    os << seq << ",";
+    if (has_pts) os << pts_90k;
+    else os << "NA";
+    os << "," << fname << ","
+       << md.ball << "," << md.frame_name << "," << md.innings << "," << md.isStart << ","
+       << md.matchID << "," << md.over << "," << md.ptp_timestamp << "," << md.received_at;
+    if (crc) {
+        char hex[12];
+        snprintf(hex, sizeof(hex), ",%08" PRIx32, *crc);
+        os << hex;
+    }
+    os << "\n";
+}
+
+void write_summary_csv_row(std::ostream& os, uint64_t seq, uint64_t pts_90k, const FrameMetadata& md) {
+    os << seq << "," << pts_90k << "," << md.over << "," << md.ball << "," << md.innings << "," << md.matchID << "\n";
+}
+
+void write_audio_csv_row(std::ostream& os, uint64_t idx, uint64_t pts_90k) {
+    os << idx << "," << pts_90k << "\n";
+}
+
+// === HEVC access units ===
+// Position of the next 00 00 01 start code at or after pos (size if none); the
+// returned offset includes a leading zero byte when the code is 4 bytes long.
+static size_t next_start_code(const uint8_t* data, size_t size, size_t pos) {
+    while (pos + 3 <= size) {
+        const void* hit = memchr(data + pos + 2, 0x01, size - pos - 2);
+        if (!hit) return size;
+        size_t one = static_cast<const uint8_t*>(hit) - data;
+        if (data[one - 1] == 0 && data[one - 2] == 0) {
+            size_t sc = one - 2;
+            return (sc > 0 && data[sc - 1] == 0) ? sc - 1 : sc;
+        }
+        pos = one - 1;
+    }
+    return size;
+}
+
+AuInfo scan_hevc_au(const uint8_t* data, size_t size) {
+    AuInfo info;
+    size_t sc = next_start_code(data, size, 0);
+    while (sc < size) {
+        size_t hdr = sc;
+        while (hdr < size && data[hdr] == 0) hdr++;
+        hdr++;                                   // skip the 0x01
+        if (hdr >= size) break;
+        uint8_t type = (data[hdr] >> 1) & 0x3f;
+        if (type < HEVC_NAL_VPS) {
+            info.found_vcl = true;
+            info.keyframe = type >= HEVC_NAL_IRAP_FIRST && type <= HEVC_NAL_IRAP_LAST;
+            break;
+        }
+        size_t next = next_start_code(data, size, hdr);
+        NalSpan span{sc, next - sc};
+        if (type == HEVC_NAL_VPS) info.vps = span;
+        else if (type == HEVC_NAL_SPS) info.sps = span;
+        else if (type == HEVC_NAL_PPS) info.pps = span;
+        sc = next;
+    }
+    return info;
+}
+
+AuTail hevc_au_tail(const uint8_t* data, size_t size) {
+    size_t end = size, zeros = 0;
+    while (end && data[end - 1] == 0) {
+        --end;
+        ++zeros;
+    }
+    if (zeros > 3 || !end) return AU_TAIL_ZERO_FILLED;
+    // 00 00 01 plus a 2-byte NAL header need at least one payload byte after them,
+    // except end of sequence / bitstream, which are only a header
+    for (size_t p = end >= 5 ? end - 5 : 0; p + 3 <= end; ++p) {
+        if (data[p] != 0 || data[p + 1] != 0 || data[p + 2] != 1) continue;
+        uint8_t type = p + 5 == end ? (data[p + 3] >> 1) & 0x3f : 0;
+        if (type != HEVC_NAL_EOS && type != HEVC_NAL_EOB) return AU_TAIL_CUT_NAL;
+    }
+    return AU_TAIL_OK;
+}
+
+// Bit reader over an RBSP that drops emulation-prevention bytes (00 00 03)
+struct RbspReader {
+    const uint8_t* data; size_t size; size_t byte = 0; int bit = 0; int zeros = 0;
+    bool ok = true;
+
+    uint32_t bits(int n) {
+        uint32_t v = 0;
+        while (n--) {
+            if (byte >= size) { ok = false; return 0; }
+            if (bit == 0) {
+                if (zeros >= 2 && data[byte] == 0x03) { byte++; zeros = 0; if (byte >= size) { ok = false; return 0; } }
+                zeros = data[byte] == 0 ? zeros + 1 : 0;
+            }
+            v = (v << 1) | ((data[byte] >> (7 - bit)) & 1);
+            if (++bit == 8) { bit = 0; byte++; }
+        }
+        return v;
+    }
+    uint32_t ue() {
+        int lz = 0;
+        while (ok && bits(1) == 0) {
+            // 32 or more leading zeros do not fit 32 bits: malformed
+            if (++lz >= 32) { ok = false; return 0; }
+        }
+        return ok && lz ? ((1u << lz) - 1 + bits(lz)) : 0;
+    }
+};
+
+bool parse_sps_dimensions(const uint8_t* nal, size_t size, int& width, int& height) {
+    size_t hdr = 0;
+    while (hdr < size && nal[hdr] == 0) hdr++;
+    hdr += 3;                                    // 0x01 + two-byte NAL header
+    if (hdr >= size) return false;
+    RbspReader r{nal + hdr, size - hdr};
+    r.bits(4);                                   // sps_video_parameter_set_id
+    int max_sub_layers_minus1 = r.bits(3);
+    r.bits(1);                                   // temporal_id_nesting
+    // profile_tier_level(1, max_sub_layers_minus1)
+    r.bits(32); r.bits(32); r.bits(24);          // general profile (88 bits)
+    r.bits(8);                                   // general_level_idc
+    bool sub_profile[8] = {}, sub_level[8] = {};
+    for (int i = 0; i < max_sub_layers_minus1; ++i) {
+        sub_profile[i] = r.bits(1);
+        sub_level[i] = r.bits(1);
+    }
+    if (max_sub_layers_minus1 > 0)
+        for (int i = max_sub_layers_minus1; i < 8; ++i) r.bits(2);
+    for (int i = 0; i < max_sub_layers_minus1; ++i) {
+        if (sub_profile[i]) { r.bits(32); r.bits(32); r.bits(24); }
+        if (sub_level[i]) r.bits(8);
+    }
+    r.ue();                                      // sps_seq_parameter_set_id
+    uint32_t chroma_format_idc = r.ue();
+    if (chroma_format_idc == 3) r.bits(1);       // separate_colour_plane_flag
+    uint32_t w = r.ue(), h = r.ue();
+    if (r.bits(1)) {                             // conformance_window_flag
+        int sub_w = (chroma_format_idc == 1 || chroma_format_idc == 2) ? 2 : 1;
+        int sub_h = (chroma_format_idc == 1) ? 2 : 1;
+        uint32_t left = r.ue(), right = r.ue(), top = r.ue(), bottom = r.ue();
+        w -= sub_w * (left + right);
+        h -= sub_h * (top + bottom);
+    }
+    if (!r.ok || w == 0 || h == 0 || w > 16384 || h > 16384) return false;
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    return true;
+}
+
+// === Frame integrity ===
+namespace {
+
+// Slicing-by-8 tables for the reflected Castagnoli polynomial
+struct Crc32cTables {
+    uint32_t t[8][256];
+    Crc32cTables() {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+            t[0][n] = c;
+        }
+        for (uint32_t n = 0; n < 256; ++n)
+            for (int k = 1; k < 8; ++k) t[k][n] = (t[k - 1][n] >> 8) ^ t[0][t[k - 1][n] & 0xff];
+    }
+};
+
+uint32_t crc32c_sw(uint32_t crc, const uint8_t* p, size_t n) {
+    static const Crc32cTables tab;
+    const auto& t = tab.t;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    while (n--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    return crc;
+}
+
+#if defined(_M_X64) || defined(__x86_64__)
+// crc32 has a 3-cycle latency but 1/cycle throughput: three independent streams over
+// adjacent blocks keep the unit busy, then the partial CRCs are shifted into place with
+// "append N zero bytes" tables (as in Mark Adler's crc32c.c)
+constexpr size_t CRC_LONG = 8192, CRC_SHORT = 256;
+
+uint32_t gf2_times(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+    for (; vec; vec >>= 1, ++mat)
+        if (vec & 1) sum ^= *mat;
+    return sum;
+}
+
+// Operator (32x32 over GF(2)) that appends len zero bytes to a raw CRC register
+void zeros_op(uint32_t* op, size_t len) {
+    uint32_t sq[32], tmp[32];
+    sq[0] = 0x82f63b78u;                                  // one zero bit
+    for (int n = 1; n < 32; ++n) sq[n] = 1u << (n - 1);
+    for (int k = 0; k < 3; ++k) {                         // ... squared to one zero byte
+        for (int n = 0; n < 32; ++n) tmp[n] = gf2_times(sq, sq[n]);
+        memcpy(sq, tmp, sizeof(sq));
+    }
+    for (int n = 0; n < 32; ++n) op[n] = 1u << n;         // identity, then op = byte^len
+    for (; len; len >>= 1) {
+        if (len & 1) {
+            for (int n = 0; n < 32; ++n) tmp[n] = gf2_times(sq, op[n]);
+            memcpy(op, tmp, sizeof(tmp));
+        }
+        for (int n = 0; n < 32; ++n) tmp[n] = gf2_times(sq, sq[n]);
+        memcpy(sq, tmp, sizeof(sq));
+    }
+}
+
+struct Crc32cShift {
+    uint32_t t[4][256];
+    explicit Crc32cShift(size_t len) {
+        uint32_t op[32];
+        zeros_op(op, len);
+        for (uint32_t b = 0; b < 256; ++b)
+            for (int k = 0; k < 4; ++k) t[k][b] = gf2_times(op, b << (8 * k));
+    }
+    uint32_t operator()(uint32_t crc) const {
+        return t[0][crc & 0xff] ^ t[1][(crc >> 8) & 0xff] ^ t[2][(crc >> 16) & 0xff] ^ t[3][crc >> 24];
+    }
+};
+
+#ifndef _MSC_VER
+__attribute__((target("sse4.2")))
+#endif
+uint64_t crc32c_3way(uint64_t c0, const uint8_t*& p, size_t& n, size_t block, const Crc32cShift& shift) {
+    while (n >= 3 * block) {
+        uint64_t c1 = 0, c2 = 0;
+        for (const uint8_t* end = p + block; p < end; p += 8) {
+            uint64_t v0, v1, v2;
+            memcpy(&v0, p, 8);
+            memcpy(&v1, p + block, 8);
+            memcpy(&v2, p + 2 * block, 8);
+            c0 = _mm_crc32_u64(c0, v0);
+            c1 = _mm_crc32_u64(c1, v1);
+            c2 = _mm_crc32_u64(c2, v2);
+        }
+        c0 = shift(static_cast<uint32_t>(c0)) ^ c1;
+        c0 = shift(static_cast<uint32_t>(c0)) ^ c2;
+        p += 2 * block;
+        n -= 3 * block;
+    }
+    return c0;
+}
+
+#ifndef _MSC_VER
+__attribute__((target("sse4.2")))
+#endif
+uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t n) {
+    static const Crc32cShift long_shift(CRC_LONG), short_shift(CRC_SHORT);
+    uint64_t c = crc;
+    c = crc32c_3way(c, p, n, CRC_LONG, long_shift);
+    c = crc32c_3way(c, p, n, CRC_SHORT, short_shift);
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+    uint32_t c32 = static_cast<uint32_t>(c);
+    while (n--) c32 = _mm_crc32_u8(c32, *p++);
+    return c32;
+}
+
+bool cpu_has_sse42() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+const bool HAVE_HW_CRC = cpu_has_sse42();
+#elif defined(__ARM_FEATURE_CRC32)
+uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t n) {
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+    }
+    while (n--) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+const bool HAVE_HW_CRC = true;
+#else
+uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t n) { return crc32c_sw(crc, p, n); }
+const bool HAVE_HW_CRC = false;
+#endif
+
+} // namespace
+
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc) {
+    crc = ~crc;
+    crc = HAVE_HW_CRC ? crc32c_hw(crc, data, size) : crc32c_sw(crc, data, size);
+    return ~crc;
+}
+
+const char* crc32c_impl() {
+#if defined(_M_X64) || defined(__x86_64__)
+    return HAVE_HW_CRC ? "sse4.2" : "software";
+#elif defined(__ARM_FEATURE_CRC32)
+    return "armv8-crc";
+#else
+    return "software";
+#endif
+}
+
+bool RecentPayloads::seen(uint32_t crc, uint64_t size, uint64_t index, uint64_t& first_index) {
+    if (entries_.empty()) return false;
+    bool dup = false;
+    for (const Entry& e : entries_) {
+        if (e.size == size && e.crc == crc && size) {
+            first_index = e.index;
+            dup = true;
+            break;
+        }
+    }
+    entries_[next_] = Entry{size, index, crc};
+    next_ = (next_ + 1) % entries_.size();
+    return dup;
+}
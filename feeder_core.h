@@ -0,0 +1,148 @@
+#pragma once
+
+// Per-frame helpers used by appsrc_feeder, kept free of GStreamer/hiredis so they
+// can be linked into the micro-benchmarks (bench/bench_hot_paths.cpp) on their own.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// === Frame files ===
+static constexpr std::size_t IFRAME_MIN_SIZE = 30 * 1024; // 30 KB
+
+uint64_t find_first_index_fast(const std::string& folder);
+std::string make_frame_filename(const std::string& camera, uint64_t idx);
+bool is_file_ready(const std::filesystem::path& path, int max_attempts = 5, int delay_ms = 2);
+bool is_iframe(const std::filesystem::path& path);
+
+// frame_<camera>_<idx>.hevc (optionally under a folder) rebuilt in place: per frame only
+// the index digits are rewritten, so no allocation once the digit count is stable.
+class FramePathTemplate {
+public:
+    FramePathTemplate() = default;
+    FramePathTemplate(const std::string& folder, const std::string& camera);
+    // Full path for idx; valid until the next call
+    const std::string& at(uint64_t idx);
+    const char* c_str() const { return s_.c_str(); }
+    // File name part, and the name without ".hevc" (the Redis key)
+    std::string_view name() const { return std::string_view(s_).substr(name_pos_); }
+    std::string_view key() const { return std::string_view(s_).substr(name_pos_, s_.size() - name_pos_ - 5); }
+
+private:
+    std::string prefix_;                 // folder + separator + "frame_<camera>_"
+    std::string s_;
+    size_t name_pos_ = 0;
+    size_t digits_ = 0;
+};
+
+// Same checks on a plain path string via stat(), without building a std::filesystem::path
+bool file_size_of(const char* path, uint64_t& size);
+// Same single stat(), also returning the last write time (ns since the epoch) as the
+// frame's arrival time for the stream analytics
+bool file_size_of(const char* path, uint64_t& size, int64_t& mtime_ns);
+bool is_file_ready(const char* path, int max_attempts = 5, int delay_ms = 2);
+bool is_iframe(const char* path);
+// All frame_<camera>_*.hevc files in folder, in index order
+std::vector<std::filesystem::path> list_frame_files(const std::string& folder, const std::string& camera);
+
+enum FrameReadStatus { FRAME_READ_OK, FRAME_OPEN_FAILED, FRAME_READ_FAILED, FRAME_TOO_LARGE };
+// Whole file into out (resized to the file size)
+FrameReadStatus read_frame_file(const std::filesystem::path& path, std::vector<uint8_t>& out);
+// Whole file into dst[0, cap); size is the file size (also on FRAME_TOO_LARGE, nothing read then)
+FrameReadStatus read_frame_into(const char* path, uint8_t* dst, size_t cap, size_t& size);
+
+// === Redis metadata ===
+// Value of "key" in the flat JSON stored per frame, "NA" if absent
+std::string_view json_value(std::string_view json, std::string_view key);
+std::string json_extract(const std::string& json, const std::string& key);
+
+struct FrameMetadata {
+    std::string ball = "1", frame_name = "NA", innings = "1", isStart = "false",
+                matchID = "123", over = "1", ptp_timestamp = "NA", received_at = "NA";
+    // Optional, from the writer of the frame file: payload bytes and CRC32C (hex), to
+    // catch a file read before it was fully written
+    std::string size = "NA", crc32c = "NA";
+    // Back to the defaults, keeping the string capacity (for an instance reused per frame)
+    void reset();
+};
+// Assigns into the existing strings, so a reused FrameMetadata stops allocating once
+// its fields have seen their longest values
+void parse_frame_metadata(std::string_view json, FrameMetadata& md);
+
+// === CSV rows ===
+// FrameIndex,PTS_90k,Filename,ball,frame_name,innings,isStart,matchID,over,ptp_timestamp,received_at[,crc32c]
+void write_video_csv_row(std::ostream& os, uint64_t seq, bool has_pts, uint64_t pts_90k,
+                         std::string_view fname, const FrameMetadata& md, const uint32_t* crc = nullptr);
+// FrameIndex,PTS_90k,over,ball,innings,matchID
+void write_summary_csv_row(std::ostream& os, uint64_t seq, uint64_t pts_90k, const FrameMetadata& md);
+// FrameIndex,AudioPTS_90k
+void write_audio_csv_row(std::ostream& os, uint64_t idx, uint64_t pts_90k);
+
+// === HEVC access units ===
+// NAL unit types from ITU-T H.265 Table 7-1
+enum : uint8_t {
+    HEVC_NAL_IRAP_FIRST = 16,   // BLA_W_LP
+    HEVC_NAL_IRAP_LAST  = 23,   // RSV_IRAP_VCL23
+    HEVC_NAL_VPS        = 32,
+    HEVC_NAL_SPS        = 33,
+    HEVC_NAL_PPS        = 34,
+    HEVC_NAL_EOS        = 36,
+    HEVC_NAL_EOB        = 37,
+};
+
+struct NalSpan { size_t offset = 0; size_t size = 0; };   // start code included
+
+struct AuInfo {
+    bool keyframe = false;      // first VCL NAL is IRAP
+    bool found_vcl = false;
+    NalSpan vps, sps, pps;      // size 0 if absent
+};
+
+// Scan the NAL headers of one byte-stream access unit. Stops at the first VCL NAL,
+// so only the parameter sets / SEI prefix is read, not the slice payload.
+AuInfo scan_hevc_au(const uint8_t* data, size_t size);
+
+// Cropped luma size from an SPS NAL (span includes start code). Returns false if malformed.
+bool parse_sps_dimensions(const uint8_t* nal, size_t size, int& width, int& height);
+
+// How an access unit ends, from its last bytes only. A NAL unit never ends in 0x00
+// (cabac_zero_words get a final 0x03), so a run of zeros at the end is space the
+// writer had not filled yet, and a start code in the last bytes is a NAL cut after
+// its header. A cut inside slice data ends on an ordinary byte and is left to the
+// size / CRC32C the writer may put in the metadata.
+enum AuTail : uint8_t {
+    AU_TAIL_OK,
+    AU_TAIL_ZERO_FILLED,        // more than 3 trailing zero bytes (trailing_zero_8bits allows a few)
+    AU_TAIL_CUT_NAL,            // last NAL has no payload
+};
+AuTail hevc_au_tail(const uint8_t* data, size_t size);
+
+// === Frame integrity ===
+// CRC32C (Castagnoli) of data, continuing from crc (0 to start). The SSE4.2 crc32
+// instruction when the CPU has it, ARMv8 CRC when built for it, slicing-by-8 otherwise.
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc = 0);
+// "sse4.2", "armv8-crc" or "software"
+const char* crc32c_impl();
+
+// Payloads pushed recently, to catch a frame the sender delivered twice. Same size and
+// CRC32C counts as the same payload (a chance collision is ~1 in 4 billion per pair).
+class RecentPayloads {
+public:
+    explicit RecentPayloads(size_t capacity = 256) : entries_(capacity) {}
+    // True (and the index it was first seen under) if the payload is among the last
+    // `capacity` added; either way it is added
+    bool seen(uint32_t crc, uint64_t size, uint64_t index, uint64_t& first_index);
+
+private:
+    struct Entry {
+        uint64_t size = 0;
+        uint64_t index = 0;
+        uint32_t crc = 0;
+    };
+    std::vector<Entry> entries_;         // ring, size 0 = empty
+    size_t next_ = 0;
+};
@@ -0,0 +1,158 @@
+#include "frame_arena.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+size_t round_up(size_t n, size_t to) { return (n + to - 1) / to * to; }
+
+#ifdef _WIN32
+// MEM_LARGE_PAGES needs SeLockMemoryPrivilege enabled in the process token
+bool enable_lock_memory_privilege() {
+    HANDLE token;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) return false;
+    TOKEN_PRIVILEGES tp{};
+    tp.PrivilegeCount = 1;
+    tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    bool ok = LookupPrivilegeValueA(NULL, "SeLockMemoryPrivilege", &tp.Privileges[0].Luid) &&
+              AdjustTokenPrivileges(token, FALSE, &tp, 0, NULL, NULL) && GetLastError() == ERROR_SUCCESS;
+    CloseHandle(token);
+    return ok;
+}
+#endif
+
+} // namespace
+
+bool FrameArena::init(size_t chunk_size, size_t count) {
+    release_all();
+    chunk_size_ = round_up(chunk_size, 4096);
+    count_ = count;
+    size_t want = chunk_size_ * count;
+
+#ifdef _WIN32
+    size_t large = GetLargePageMinimum();
+    if (large && enable_lock_memory_privilege()) {
+        bytes_ = round_up(want, large);
+        base_ = static_cast<uint8_t*>(VirtualAlloc(NULL, bytes_, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE));
+        if (base_) backing_ = ARENA_LARGE_PAGES;
+        else fallback_reason_ = "VirtualAlloc(MEM_LARGE_PAGES) failed, error " + std::to_string(GetLastError());
+    } else {
+        fallback_reason_ = large ? "no \"Lock pages in memory\" right" : "no large page support";
+    }
+    if (!base_) {
+        bytes_ = want;
+        base_ = static_cast<uint8_t*>(VirtualAlloc(NULL, bytes_, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        if (base_) backing_ = ARENA_NORMAL;
+    }
+#else
+    bytes_ = round_up(want, HUGE_PAGE);
+    void* p = mmap(NULL, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+    if (p != MAP_FAILED) {
+        base_ = static_cast<uint8_t*>(p);
+        backing_ = ARENA_HUGETLB;
+    } else {
+        fallback_reason_ = "MAP_HUGETLB: " + std::string(strerror(errno)) + " (vm.nr_hugepages)";
+        // Over-map by one huge page so the block can start on a 2 MB boundary
+        size_t span = bytes_ + HUGE_PAGE;
+        p = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+            uint8_t* raw = static_cast<uint8_t*>(p);
+            uint8_t* aligned = reinterpret_cast<uint8_t*>(round_up(reinterpret_cast<uintptr_t>(raw), HUGE_PAGE));
+            if (aligned > raw) munmap(raw, static_cast<size_t>(aligned - raw));
+            size_t tail = static_cast<size_t>(raw + span - (aligned + bytes_));
+            if (tail) munmap(aligned + bytes_, tail);
+            base_ = aligned;
+#ifdef MADV_HUGEPAGE
+            backing_ = madvise(base_, bytes_, MADV_HUGEPAGE) == 0 ? ARENA_THP : ARENA_NORMAL;
+#else
+            backing_ = ARENA_NORMAL;
+#endif
+        }
+    }
+#endif
+    if (!base_) {
+        backing_ = ARENA_NONE;
+        bytes_ = 0;
+        return false;
+    }
+    // Fault everything in now rather than on the first frames
+    for (size_t off = 0; off < bytes_; off += 4096) base_[off] = 0;
+
+    free_.reserve(count_);
+    for (size_t i = count_; i-- > 0;) free_.push_back(static_cast<uint32_t>(i));
+    return true;
+}
+
+void FrameArena::release_all() {
+    if (!base_) return;
+#ifdef _WIN32
+    VirtualFree(base_, 0, MEM_RELEASE);
+#else
+    munmap(base_, bytes_);
+#endif
+    base_ = nullptr;
+    bytes_ = 0;
+    backing_ = ARENA_NONE;
+    free_.clear();
+}
+
+uint8_t* FrameArena::acquire() {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (free_.empty()) return nullptr;
+    uint32_t i = free_.back();
+    free_.pop_back();
+    return base_ + static_cast<size_t>(i) * chunk_size_;
+}
+
+void FrameArena::release(uint8_t* chunk) {
+    std::lock_guard<std::mutex> lock(mu_);
+    free_.push_back(static_cast<uint32_t>(static_cast<size_t>(chunk - base_) / chunk_size_));
+}
+
+size_t FrameArena::huge_bytes() const {
+    if (backing_ == ARENA_HUGETLB || backing_ == ARENA_LARGE_PAGES) return bytes_;
+    if (backing_ != ARENA_THP) return 0;
+#ifdef __linux__
+    // AnonHugePages of the mapping that starts at base_
+    FILE* f = fopen("/proc/self/smaps", "r");
+    if (!f) return 0;
+    char line[256];
+    bool ours = false;
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long start = 0, end = 0;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {     // header line of the next mapping
+            ours = start <= reinterpret_cast<uintptr_t>(base_) && reinterpret_cast<uintptr_t>(base_) < end;
+            continue;
+        }
+        unsigned long v = 0;
+        if (ours && sscanf(line, "AnonHugePages: %lu kB", &v) == 1) kb += v;
+    }
+    fclose(f);
+    return kb * 1024;
+#else
+    return 0;
+#endif
+}
+
+std::string FrameArena::report() const {
+    static const char* names[] = {"none", "hugetlb 2 MB pages", "transparent huge pages", "large pages", "normal pages"};
+    char line[256];
+    const double MB = 1024.0 * 1024.0;
+    snprintf(line, sizeof(line), "%.0f MB frame arena (%zu x %zu KB) on %s: %.0f MB on huge pages",
+             bytes_ / MB, count_, chunk_size_ / 1024, names[backing_], huge_bytes() / MB);
+    std::string s = line;
+    if (!fallback_reason_.empty()) s += " [" + fallback_reason_ + "]";
+    return s;
+}
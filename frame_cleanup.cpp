@@ -0,0 +1,90 @@
+#include "frame_cleanup.h"
+
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool FrameCleaner::start(const std::string& folder, const std::string& camera, uint64_t first_index, uint64_t keep) {
+    stop();
+#ifdef _WIN32
+    names_ = FramePathTemplate(folder, camera);
+#else
+    dir_fd_ = open(folder.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd_ < 0) {
+        std::cerr << "[cleanup] Cannot open " << folder << "\n";
+        return false;
+    }
+    names_ = FramePathTemplate("", camera);    // names relative to dir_fd_
+#endif
+    next_ = first_index;
+    keep_ = keep;
+    retry_.clear();
+    consumed_ = first_index;
+    running_ = true;
+    thread_ = std::thread(&FrameCleaner::run, this);
+    return true;
+}
+
+void FrameCleaner::stop() {
+    if (!running_.exchange(false)) return;
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+#ifndef _WIN32
+    close(dir_fd_);
+    dir_fd_ = -1;
+#endif
+}
+
+void FrameCleaner::run() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (running_.load()) {
+        wake_.wait_for(lock, std::chrono::milliseconds(CLEANUP_PERIOD_MS));
+        sweep();
+    }
+}
+
+FrameCleaner::Outcome FrameCleaner::remove(uint64_t index) {
+#ifdef _WIN32
+    bool ok = DeleteFileA(names_.at(index).c_str()) != 0;
+    DWORD err = ok ? 0 : GetLastError();
+    bool gone = err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND;
+#else
+    bool ok = unlinkat(dir_fd_, names_.at(index).c_str(), 0) == 0;
+    bool gone = !ok && errno == ENOENT;
+#endif
+    if (ok) removed_.fetch_add(1, std::memory_order_relaxed);
+    return ok ? REMOVED : gone ? GONE : FAILED;
+}
+
+void FrameCleaner::sweep() {
+    // Earlier misses first: a skipped frame may have been written since
+    size_t kept = 0;
+    for (Retry& r : retry_) {
+        Outcome o = remove(r.index);
+        if (o == REMOVED) continue;
+        r.failed = o == FAILED;
+        if (--r.sweeps_left > 0) {
+            retry_[kept++] = r;
+        } else if (!r.failed) {
+            absent_.fetch_add(1, std::memory_order_relaxed);
+        } else if (failed_.fetch_add(1, std::memory_order_relaxed) < 10) {
+            // e.g. still open in the receiver on Windows; the first few are worth a line
+            std::cerr << "[cleanup] Cannot remove " << names_.at(r.index) << "\n";
+        }
+    }
+    retry_.resize(kept);
+
+    uint64_t consumed = consumed_.load(std::memory_order_relaxed);
+    if (consumed < keep_) return;
+    for (uint64_t end = consumed - keep_; next_ < end; ++next_) {
+        Outcome o = remove(next_);
+        if (o != REMOVED) retry_.push_back(Retry{next_, CLEANUP_RETRY_SWEEPS, o == FAILED});
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+// --cleanup: the feeder retires the frame files it has consumed, instead of relying on
+// an external sweep of the RAMdisk folder.
+//
+// The feeder only publishes how far it has got (one relaxed store per frame). A
+// background thread wakes every CLEANUP_PERIOD_MS and removes, in one batch, every
+// frame_<camera>_<idx>.hevc from the first consumed index up to `keep` indices behind
+// the feeder; the last `keep` frames stay for backfill. A file that is not there yet
+// (skipped, still being written late) or cannot be removed is retried on the next
+// CLEANUP_RETRY_SWEEPS sweeps before it counts as absent or failed. On POSIX the names are unlinked
+// relative to a directory fd held open for the whole run (unlinkat), so no path is
+// resolved from the root per file; Windows has no such call and uses DeleteFileA.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "feeder_core.h"
+
+class FrameCleaner {
+public:
+    static constexpr int CLEANUP_PERIOD_MS = 100;
+    static constexpr int CLEANUP_RETRY_SWEEPS = 50;   // 5 s for a late frame to turn up
+
+    FrameCleaner() = default;
+    ~FrameCleaner() { stop(); }
+    FrameCleaner(const FrameCleaner&) = delete;
+    FrameCleaner& operator=(const FrameCleaner&) = delete;
+
+    // Remove files from first_index on, keeping the newest `keep` consumed indices
+    bool start(const std::string& folder, const std::string& camera, uint64_t first_index, uint64_t keep);
+    // Stop the thread; frames inside the keep window are left in place
+    void stop();
+    bool running() const { return running_.load(std::memory_order_relaxed); }
+
+    // Feeder: every index below this one has been pushed or skipped
+    void consumed_below(uint64_t index) { consumed_.store(index, std::memory_order_relaxed); }
+
+    uint64_t removed() const { return removed_.load(std::memory_order_relaxed); }
+    uint64_t absent() const { return absent_.load(std::memory_order_relaxed); }   // never arrived / already gone (after retries)
+    uint64_t failed() const { return failed_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void sweep();
+    enum Outcome { REMOVED, GONE, FAILED };
+    Outcome remove(uint64_t index);
+
+    struct Retry {
+        uint64_t index;
+        int sweeps_left;
+        bool failed;                         // last attempt failed for another reason than absence
+    };
+
+    FramePathTemplate names_;
+    uint64_t next_ = 0;                      // lowest index not yet retired
+    uint64_t keep_ = 0;
+    std::vector<Retry> retry_;               // thread only
+    std::atomic<uint64_t> consumed_{0};
+    std::atomic<uint64_t> removed_{0}, absent_{0}, failed_{0};
+    std::atomic<bool> running_{false};
+    std::mutex mu_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    int dir_fd_ = -1;
+};
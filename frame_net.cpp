@@ -0,0 +1,459 @@
+#include "frame_net.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+static void close_socket(socket_t s) { closesocket(s); }
+#define SHUT_RDWR SD_BOTH
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+static constexpr socket_t INVALID_SOCKET = -1;
+static void close_socket(socket_t s) { close(s); }
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void split_host_port(const std::string& addr, const std::string& def_host, std::string& host, std::string& port) {
+    size_t colon = addr.rfind(':');
+    if (colon == std::string::npos) {
+        host = def_host;
+        port = addr;
+    } else {
+        host = colon ? addr.substr(0, colon) : def_host;
+        port = addr.substr(colon + 1);
+    }
+}
+
+// 1..65535, 0 if port is anything else
+unsigned short parse_port(const std::string& port) {
+    char* end = nullptr;
+    long v = port.empty() ? 0 : strtol(port.c_str(), &end, 10);
+    return v > 0 && v <= 65535 && *end == '\0' ? static_cast<unsigned short>(v) : 0;
+}
+
+bool recv_all(socket_t fd, void* dst, size_t n) {
+    char* p = static_cast<char*>(dst);
+    while (n) {
+        int got = recv(fd, p, static_cast<int>(std::min<size_t>(n, 1 << 20)), 0);
+        if (got <= 0) return false;
+        p += got;
+        n -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool send_all(socket_t fd, const void* src, size_t n) {
+    const char* p = static_cast<const char*>(src);
+    while (n) {
+        int sent = send(fd, p, static_cast<int>(std::min<size_t>(n, 1 << 20)), MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        p += sent;
+        n -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool wsa_start() {
+#ifdef _WIN32
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+#else
+    return true;
+#endif
+}
+
+void wsa_stop() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// Wait until fd is readable or 200 ms passed, so loops notice stop()
+bool readable(socket_t fd) {
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+    timeval tv{0, 200000};
+    return select(static_cast<int>(fd + 1), &fds, NULL, NULL, &tv) > 0;
+}
+
+} // namespace
+
+// === FrameReceiver ===
+
+FrameReceiver::FrameReceiver(size_t window, size_t max_frame)
+    : slots_(window ? window : 1), max_frame_(max_frame) {}
+
+FrameReceiver::~FrameReceiver() {
+    stop();
+    for (Slot& s : slots_) {
+        free(s.data);
+        s = Slot();
+    }
+}
+
+bool FrameReceiver::start(const std::string& addr, bool udp) {
+    std::string host, port;
+    split_host_port(addr, "0.0.0.0", host, port);
+    unsigned short port_n = parse_port(port);
+    if (!port_n) {
+        std::cerr << "[net] Bad port in " << addr << "\n";
+        return false;
+    }
+    if (!wsa_start()) {
+        std::cerr << "[net] WSAStartup failed\n";
+        return false;
+    }
+    socket_t fd = socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, udp ? IPPROTO_UDP : IPPROTO_TCP);
+    if (fd == INVALID_SOCKET) {
+        std::cerr << "[net] socket() failed\n";
+        wsa_stop();
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+    if (udp) {
+        // About a second of 300 fps I-frames; the OS caps it at its own maximum
+        int rcvbuf = 64 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&rcvbuf), sizeof(rcvbuf));
+    }
+
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port_n);
+    if (inet_pton(AF_INET, host.c_str(), &sa.sin_addr) != 1 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0 ||
+        (!udp && listen(fd, 16) != 0)) {
+        std::cerr << "[net] Cannot listen on " << (udp ? "udp " : "tcp ") << host << ":" << port << "\n";
+        close_socket(fd);
+        wsa_stop();
+        return false;
+    }
+
+    listen_fd_ = static_cast<intptr_t>(fd);
+    running_ = true;
+    accept_thread_ = udp ? std::thread(&FrameReceiver::udp_loop, this)
+                         : std::thread(&FrameReceiver::accept_loop, this);
+    std::cout << "[net] Receiving frames on " << (udp ? "udp " : "tcp ") << host << ":" << port << "\n";
+    return true;
+}
+
+void FrameReceiver::stop() {
+    if (!running_.exchange(false)) return;
+    if (accept_thread_.joinable()) accept_thread_.join();
+    {
+        // Unblock connection threads waiting in recv()
+        std::lock_guard<std::mutex> lock(conn_mu_);
+        for (intptr_t c : conn_fds_) shutdown(static_cast<socket_t>(c), SHUT_RDWR);
+    }
+    for (std::thread& t : conn_threads_) t.join();
+    conn_threads_.clear();
+    conn_done_.clear();
+    close_socket(static_cast<socket_t>(listen_fd_));
+    listen_fd_ = -1;
+    ready_.notify_all();
+    wsa_stop();
+}
+
+void FrameReceiver::clear(Slot& s) {
+    if (s.used && !s.complete()) stats_.incomplete.fetch_add(1, std::memory_order_relaxed);
+    free(s.data);
+    s = Slot();
+}
+
+void FrameReceiver::drop_below(uint64_t index) {
+    for (Slot& s : slots_) {
+        if (s.used && s.index < index) clear(s);
+    }
+}
+
+void FrameReceiver::rebase(uint64_t index) {
+    for (Slot& s : slots_) clear(s);
+    base_ = top_ = index;
+    have_base_ = true;
+    taken_ = false;
+    stray_run_ = 0;
+    stats_.rebases.fetch_add(1, std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+FrameReceiver::Slot* FrameReceiver::slot_for(const NetFrameHeader& h, bool first_part) {
+    if (!have_base_) {
+        base_ = top_ = h.index;
+        have_base_ = true;
+    }
+    // Nothing taken yet: an earlier frame that fits the window with the rest is still wanted
+    if (!taken_ && h.index < base_ && top_ - h.index < slots_.size()) base_ = h.index;
+    bool late = h.index < base_;
+    if (late || h.index - base_ >= slots_.size()) {
+        if (!first_part) return nullptr;
+        (late ? stats_.late : stats_.overflow).fetch_add(1, std::memory_order_relaxed);
+        // A run of frames a whole window away from everything seen is a sender that
+        // restarted elsewhere; stragglers and a feeder that fell behind stay near it
+        bool far = late ? base_ - h.index >= slots_.size() : h.index - top_ >= slots_.size();
+        if (!far) {
+            stray_run_ = 0;
+            return nullptr;
+        }
+        stray_min_ = stray_run_ ? std::min(stray_min_, h.index) : h.index;
+        if (++stray_run_ < NET_REBASE_AFTER) return nullptr;
+        rebase(stray_min_);
+        if (h.index - base_ >= slots_.size()) return nullptr;
+    } else if (first_part) {
+        stray_run_ = 0;
+    }
+    top_ = std::max(top_, h.index);
+    return &slots_[h.index % slots_.size()];
+}
+
+void FrameReceiver::store_tcp(const NetFrameHeader& h, uint8_t* data) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        Slot* s = slot_for(h, true);
+        if (s && s->used) {
+            stats_.duplicates.fetch_add(1, std::memory_order_relaxed);
+            s = nullptr;
+        }
+        if (!s) {
+            free(data);
+            return;
+        }
+        s->used = true;
+        s->index = h.index;
+        s->data = data;
+        s->size = h.size;
+        s->received = h.size;
+        s->flags = h.flags;
+        s->capture_ns = h.capture_ns;
+        s->arrival_ns = steady_ns();
+    }
+    stats_.frames.fetch_add(1, std::memory_order_relaxed);
+    stats_.bytes.fetch_add(h.size, std::memory_order_relaxed);
+    ready_.notify_all();
+}
+
+void FrameReceiver::store_udp(const NetFrameHeader& h, const uint8_t* frag, size_t len) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        Slot* s = slot_for(h, h.offset == 0);
+        if (!s) return;
+        if (!s->used) {
+            s->data = static_cast<uint8_t*>(malloc(h.size));
+            if (!s->data) return;
+            s->used = true;
+            s->index = h.index;
+            s->size = h.size;
+            s->flags = h.flags;
+            s->capture_ns = h.capture_ns;
+            s->fragments.assign((h.size / NET_UDP_PAYLOAD + 64) / 64, 0);
+        } else if (s->size != h.size || s->complete()) {
+            if (s->complete() && h.offset == 0) stats_.duplicates.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // Fragments are whole NET_UDP_PAYLOAD pieces (udp_loop checks), so the frame is
+        // complete once every one arrived; a repeated one must not count twice
+        size_t part = h.offset / NET_UDP_PAYLOAD;
+        uint64_t bit = uint64_t(1) << (part % 64);
+        if (s->fragments[part / 64] & bit) return;
+        s->fragments[part / 64] |= bit;
+        memcpy(s->data + h.offset, frag, len);
+        s->received += static_cast<uint32_t>(len);
+        if (!s->complete()) return;
+        s->arrival_ns = steady_ns();
+    }
+    stats_.frames.fetch_add(1, std::memory_order_relaxed);
+    stats_.bytes.fetch_add(h.size, std::memory_order_relaxed);
+    ready_.notify_all();
+}
+
+bool FrameReceiver::take(uint64_t index, NetFrame& out, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mu_);
+    Slot& s = slots_[index % slots_.size()];
+    auto here = [&] { return s.index == index && s.complete(); };
+    if (!ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] { return here() || !running_; }) || !here())
+        return false;
+
+    out.index = s.index;
+    out.flags = s.flags;
+    out.capture_ns = s.capture_ns;
+    out.arrival_ns = s.arrival_ns;
+    out.data = s.data;
+    out.size = s.size;
+    s = Slot();
+    drop_below(index);
+    base_ = index + 1;
+    top_ = std::max(top_, index);
+    have_base_ = true;
+    taken_ = true;
+    return true;
+}
+
+bool FrameReceiver::next_ready(uint64_t from, uint64_t& index, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mu_);
+    auto lowest = [&] {
+        bool found = false;
+        for (const Slot& s : slots_) {
+            if (s.complete() && s.index >= from && (!found || s.index < index)) {
+                index = s.index;
+                found = true;
+            }
+        }
+        return found;
+    };
+    return ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] { return lowest() || !running_; }) &&
+           lowest();
+}
+
+void FrameReceiver::accept_loop() {
+    socket_t lfd = static_cast<socket_t>(listen_fd_);
+    while (running_.load()) {
+        if (!readable(lfd)) {
+            std::lock_guard<std::mutex> lock(conn_mu_);
+            reap_connections();
+            continue;
+        }
+        socket_t c = accept(lfd, NULL, NULL);
+        if (c == INVALID_SOCKET) continue;
+        int rcvbuf = 8 * 1024 * 1024;
+        setsockopt(c, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&rcvbuf), sizeof(rcvbuf));
+        stats_.connections.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(conn_mu_);
+        reap_connections();
+        conn_fds_.push_back(static_cast<intptr_t>(c));
+        conn_threads_.emplace_back(&FrameReceiver::tcp_loop, this, static_cast<intptr_t>(c));
+    }
+}
+
+void FrameReceiver::reap_connections() {
+    // A thread in conn_done_ has left tcp_loop's last critical section: join is immediate
+    for (std::thread::id id : conn_done_) {
+        auto t = std::find_if(conn_threads_.begin(), conn_threads_.end(),
+                              [&](const std::thread& th) { return th.get_id() == id; });
+        if (t == conn_threads_.end()) continue;
+        t->join();
+        conn_threads_.erase(t);
+    }
+    conn_done_.clear();
+}
+
+void FrameReceiver::tcp_loop(intptr_t cfd) {
+    socket_t fd = static_cast<socket_t>(cfd);
+    NetFrameHeader h;
+    while (running_.load() && recv_all(fd, &h, sizeof(h))) {
+        if (h.magic != NET_FRAME_MAGIC || h.size == 0 || h.size > max_frame_ || h.offset != 0) {
+            stats_.malformed.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "[net] Malformed frame header, dropping connection\n";
+            break;
+        }
+        // Payload goes straight into the block the feeder will wrap
+        uint8_t* data = static_cast<uint8_t*>(malloc(h.size));
+        if (!data || !recv_all(fd, data, h.size)) {
+            free(data);
+            break;
+        }
+        store_tcp(h, data);
+    }
+    {
+        std::lock_guard<std::mutex> lock(conn_mu_);
+        conn_fds_.erase(std::remove(conn_fds_.begin(), conn_fds_.end(), cfd), conn_fds_.end());
+    }
+    close_socket(fd);
+    std::lock_guard<std::mutex> lock(conn_mu_);
+    conn_done_.push_back(std::this_thread::get_id());
+}
+
+void FrameReceiver::udp_loop() {
+    socket_t fd = static_cast<socket_t>(listen_fd_);
+    std::vector<uint8_t> buf(65536);
+    while (running_.load()) {
+        if (!readable(fd)) continue;
+        int n = recv(fd, reinterpret_cast<char*>(buf.data()), static_cast<int>(buf.size()), 0);
+        if (n <= 0) continue;
+        NetFrameHeader h;
+        size_t len = static_cast<size_t>(n);
+        if (len >= sizeof(h)) memcpy(&h, buf.data(), sizeof(h));
+        len -= std::min(len, sizeof(h));
+        if (len == 0 || h.magic != NET_FRAME_MAGIC || h.size > max_frame_ || h.offset >= h.size ||
+            h.offset % NET_UDP_PAYLOAD != 0 || len != std::min<size_t>(NET_UDP_PAYLOAD, h.size - h.offset)) {
+            stats_.malformed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        store_udp(h, buf.data() + sizeof(h), len);
+    }
+}
+
+// === FrameSender ===
+
+bool FrameSender::connect(const std::string& addr, bool udp, int connections) {
+    close();
+    std::string host, port;
+    split_host_port(addr, "127.0.0.1", host, port);
+    if (!wsa_start()) return false;
+    wsa_ = true;
+    udp_ = udp;
+    addrinfo hints{}, *res = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = udp ? SOCK_DGRAM : SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res) return false;
+    for (int i = 0; i < (udp ? 1 : std::max(1, connections)); ++i) {
+        socket_t fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        if (fd == INVALID_SOCKET) break;
+        if (::connect(fd, res->ai_addr, static_cast<int>(res->ai_addrlen)) != 0) {
+            close_socket(fd);
+            break;
+        }
+        int one = 1, sndbuf = 8 * 1024 * 1024;
+        if (!udp) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sndbuf), sizeof(sndbuf));
+        fds_.push_back(static_cast<intptr_t>(fd));
+    }
+    freeaddrinfo(res);
+    if (fds_.empty()) return false;
+    if (udp) dgram_.resize(sizeof(NetFrameHeader) + NET_UDP_PAYLOAD);
+    return true;
+}
+
+void FrameSender::close() {
+    for (intptr_t fd : fds_) close_socket(static_cast<socket_t>(fd));
+    fds_.clear();
+    if (wsa_) wsa_stop();
+    wsa_ = false;
+}
+
+bool FrameSender::send(uint64_t index, const uint8_t* data, size_t size, uint32_t flags) {
+    if (fds_.empty()) return false;
+    NetFrameHeader h{NET_FRAME_MAGIC, flags, index, steady_ns(), static_cast<uint32_t>(size), 0};
+    socket_t fd = static_cast<socket_t>(fds_[next_++ % fds_.size()]);
+    if (!udp_) return send_all(fd, &h, sizeof(h)) && send_all(fd, data, size);
+
+    for (size_t off = 0; off < size; off += NET_UDP_PAYLOAD) {
+        size_t len = std::min(NET_UDP_PAYLOAD, size - off);
+        h.offset = static_cast<uint32_t>(off);
+        memcpy(dgram_.data(), &h, sizeof(h));
+        memcpy(dgram_.data() + sizeof(h), data + off, len);
+        if (::send(fd, reinterpret_cast<const char*>(dgram_.data()), static_cast<int>(sizeof(h) + len), 0) < 0)
+            return false;
+    }
+    return true;
+}
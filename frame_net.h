@@ -0,0 +1,161 @@
+#pragma once
+
+// --listen: frames sent to the feeder over the network instead of RAMdisk files.
+//
+// Every frame travels as a NetFrameHeader followed by payload. Over TCP the payload is
+// the whole frame, and any number of connections may carry frames of the same camera.
+// Over UDP a frame is split into datagrams of at most NET_UDP_PAYLOAD bytes, each with
+// its own header (offset = where the fragment goes, a multiple of NET_UDP_PAYLOAD; a
+// repeated fragment is ignored). Connections and datagrams may
+// deliver out of order; frames land in a reorder window keyed by index and the feeder
+// takes them in index order.
+//
+// The sender's index is authoritative. Until the feeder takes its first frame the
+// window starts at the lowest index seen, so a frame that arrives a little late on
+// another connection still counts. NET_REBASE_AFTER frames in a row a whole window away
+// from the indices seen (a sender restarted further on or further back) move the
+// window to them; the feeder sees generation() change and starts over from the new
+// first frame.
+//
+// Over TCP the payload is received straight into the block the feeder later wraps as a
+// GstBuffer, so a frame is never copied between the socket and the muxer.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t NET_FRAME_MAGIC = 0x314d5246;   // "FRM1"
+static constexpr size_t NET_UDP_PAYLOAD = 60000;           // fragment bytes per datagram
+static constexpr uint32_t NET_REBASE_AFTER = 16;           // consecutive out-of-window frames
+
+// Little-endian on the wire, like every host this runs on. Flags as in frame_ring.h.
+struct NetFrameHeader {
+    uint32_t magic;
+    uint32_t flags;
+    uint64_t index;          // frame index, as in frame_<camera>_<idx>.hevc
+    int64_t capture_ns;      // sender's steady clock at capture / send
+    uint32_t size;           // whole frame
+    uint32_t offset;         // UDP: fragment offset in the frame; TCP: 0
+};
+static_assert(sizeof(NetFrameHeader) == 32, "wire header");
+
+// One complete frame; data is malloc'd and owned by whoever took the frame (free())
+struct NetFrame {
+    uint64_t index = 0;
+    uint32_t flags = 0;
+    int64_t capture_ns = 0;
+    int64_t arrival_ns = 0;  // receiver's steady clock when the last byte arrived
+    uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+struct FrameReceiverStats {
+    std::atomic<uint64_t> frames{0};        // complete frames stored
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> late{0};          // index already taken or skipped by the feeder
+    std::atomic<uint64_t> duplicates{0};
+    std::atomic<uint64_t> overflow{0};      // index beyond the reorder window (feeder too far behind)
+    std::atomic<uint64_t> incomplete{0};    // UDP frames dropped with fragments missing
+    std::atomic<uint64_t> malformed{0};     // bad magic/size; the TCP connection is dropped
+    std::atomic<uint64_t> rebases{0};       // window moved to a new run of indices
+    std::atomic<uint64_t> connections{0};
+};
+
+class FrameReceiver {
+public:
+    explicit FrameReceiver(size_t window = 1024, size_t max_frame = 8 * 1024 * 1024);
+    ~FrameReceiver();
+    FrameReceiver(const FrameReceiver&) = delete;
+    FrameReceiver& operator=(const FrameReceiver&) = delete;
+
+    // Listen on "[host:]port" (host defaults to 0.0.0.0) and receive on background threads;
+    // false on a bad address or port
+    bool start(const std::string& addr, bool udp);
+    void stop();
+    bool running() const { return running_.load(); }
+
+    // Frame `index`, waiting up to timeout_ms for it. On success everything below index is
+    // dropped and later arrivals for it count as late.
+    bool take(uint64_t index, NetFrame& out, int timeout_ms);
+    // Lowest complete index >= from (the first frame when nothing was taken yet),
+    // waiting up to timeout_ms for one to exist
+    bool next_ready(uint64_t from, uint64_t& index, int timeout_ms);
+    // Bumped on every re-base: the index the feeder waits for will not come
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    const FrameReceiverStats& stats() const { return stats_; }
+
+private:
+    struct Slot {
+        uint64_t index = 0;
+        uint8_t* data = nullptr;
+        uint32_t size = 0;
+        uint32_t received = 0;
+        std::vector<uint64_t> fragments;     // UDP: bit per NET_UDP_PAYLOAD fragment received
+        uint32_t flags = 0;
+        int64_t capture_ns = 0;
+        int64_t arrival_ns = 0;
+        bool used = false;
+        bool complete() const { return used && received == size; }
+    };
+
+    // Window slot for frame h.index, nullptr (and counted) if it is outside the window.
+    // Caller holds mu_.
+    Slot* slot_for(const NetFrameHeader& h, bool first_part);
+    void clear(Slot& s);                     // counts a partial frame as incomplete
+    void drop_below(uint64_t index);         // caller holds mu_
+    void rebase(uint64_t index);             // caller holds mu_
+    void store_tcp(const NetFrameHeader& h, uint8_t* data);
+    void store_udp(const NetFrameHeader& h, const uint8_t* frag, size_t len);
+    void accept_loop();
+    void reap_connections();                 // caller holds conn_mu_
+    void tcp_loop(intptr_t fd);
+    void udp_loop();
+
+    std::vector<Slot> slots_;
+    size_t max_frame_;
+    uint64_t base_ = 0;                      // lowest index still wanted
+    uint64_t top_ = 0;                       // highest index stored since the last (re)base
+    bool have_base_ = false;
+    bool taken_ = false;                     // base_ fixed by take(); before that it may move down
+    uint32_t stray_run_ = 0;                 // frames in a row outside the window
+    uint64_t stray_min_ = 0;                 // lowest index among them
+    std::atomic<uint64_t> generation_{0};
+    std::mutex mu_;
+    std::condition_variable ready_;
+
+    std::atomic<bool> running_{false};
+    intptr_t listen_fd_ = -1;
+    std::thread accept_thread_;
+    std::mutex conn_mu_;
+    std::vector<intptr_t> conn_fds_;
+    std::vector<std::thread> conn_threads_;
+    std::vector<std::thread::id> conn_done_; // connection threads that have returned, to join
+    FrameReceiverStats stats_;
+};
+
+// Bundled sender (bench/frame_producer --send): frames round-robin over N TCP
+// connections, or fragmented over UDP
+class FrameSender {
+public:
+    FrameSender() = default;
+    ~FrameSender() { close(); }
+    FrameSender(const FrameSender&) = delete;
+    FrameSender& operator=(const FrameSender&) = delete;
+
+    bool connect(const std::string& addr, bool udp, int connections = 1);
+    void close();
+    bool send(uint64_t index, const uint8_t* data, size_t size, uint32_t flags);
+
+private:
+    std::vector<intptr_t> fds_;
+    size_t next_ = 0;
+    bool udp_ = false;
+    std::vector<uint8_t> dgram_;
+    bool wsa_ = false;
+};
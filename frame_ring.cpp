@@ -0,0 +1,261 @@
+#include "frame_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "shm_mapping.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t ALIGN = 64;
+
+size_t align_up(size_t n) { return (n + ALIGN - 1) / ALIGN * ALIGN; }
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t current_pid() {
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+// Start time of pid in clock ticks since boot (field 22 of /proc/<pid>/stat), so a pid
+// reused by an unrelated process is not taken for the consumer; 0 if unknown or a zombie
+uint64_t process_start(uint32_t pid) {
+#ifdef __linux__
+    std::ifstream f("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    std::getline(f, stat);
+    size_t comm_end = stat.rfind(')');   // the command name may contain spaces
+    if (comm_end == std::string::npos) return 0;
+    std::istringstream fields(stat.substr(comm_end + 1));
+    std::string state, skip;
+    fields >> state;
+    if (state == "Z") return 0;
+    for (int i = 4; i < 22; ++i) fields >> skip;
+    uint64_t start = 0;
+    fields >> start;
+    return start;
+#else
+    (void)pid;
+    return 0;
+#endif
+}
+
+bool process_alive(uint32_t pid, uint64_t start) {
+#ifdef _WIN32
+    (void)start;
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!h) return false;
+    DWORD code = 0;
+    bool alive = GetExitCodeProcess(h, &code) && code == STILL_ACTIVE;
+    CloseHandle(h);
+    return alive;
+#else
+    if (kill(static_cast<pid_t>(pid), 0) != 0 && errno != EPERM) return false;
+#ifdef __linux__
+    if (start) return process_start(pid) == start;
+#endif
+    (void)start;
+    return true;
+#endif
+}
+
+} // namespace
+
+struct FrameRing::Shared {
+    struct SlotRef {
+        Shared* shared;
+        uint32_t slot;
+    };
+
+    ShmMapping shm;
+    FrameRingHeader* hdr = nullptr;
+    std::atomic<uint32_t> refs{1};       // the FrameRing's own, plus one per taken slot
+    uint32_t consumer = 0;               // our pid once open() registered it in the header
+    std::vector<SlotRef> slots;          // what f.ref points at, one per slot (consumer only)
+
+    void unref() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        if (consumer && hdr) {
+            uint32_t self = consumer;
+            hdr->consumer_pid.compare_exchange_strong(self, 0, std::memory_order_release);
+        }
+        delete this;
+    }
+};
+
+FrameRingSlot* FrameRing::slot_at(uint64_t seq) const {
+    uint8_t* base = reinterpret_cast<uint8_t*>(hdr_) + sizeof(FrameRingHeader);
+    return reinterpret_cast<FrameRingSlot*>(base + (seq % hdr_->slot_count) * hdr_->slot_stride);
+}
+
+bool FrameRing::create(const std::string& name, uint32_t slot_count, uint32_t slot_size) {
+    close();
+    if (!slot_count || !slot_size) return false;
+    uint64_t stride = sizeof(FrameRingSlot) + align_up(slot_size);
+    shared_ = new Shared();
+    if (!shared_->shm.map(name, true, sizeof(FrameRingHeader) + stride * slot_count)) {
+        close();
+        return false;
+    }
+    hdr_ = shared_->hdr = static_cast<FrameRingHeader*>(shared_->shm.data());
+
+    // Fresh mapping is zeroed; construct the atomics in place, publish the magic last
+    FrameRingHeader* h = new (hdr_) FrameRingHeader();
+    h->version = FRAME_RING_VERSION;
+    h->slot_count = slot_count;
+    h->slot_size = slot_size;
+    h->slot_stride = stride;
+    h->epoch = static_cast<uint32_t>(steady_ns()) ^ (current_pid() << 16);
+    for (uint32_t i = 0; i < slot_count; ++i) {
+        FrameRingSlot* s = new (slot_at(i)) FrameRingSlot();
+        s->state.store(FRAME_SLOT_FREE, std::memory_order_relaxed);
+    }
+    h->magic.store(FRAME_RING_MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool FrameRing::open(const std::string& name) {
+    close();
+    busy_pid_ = 0;
+    shared_ = new Shared();
+    if (!shared_->shm.map(name, false, 0)) {
+        close();
+        return false;
+    }
+    hdr_ = shared_->hdr = static_cast<FrameRingHeader*>(shared_->shm.data());
+    size_t mapped = shared_->shm.size();
+    bool ok = mapped >= sizeof(FrameRingHeader) &&
+              hdr_->magic.load(std::memory_order_acquire) == FRAME_RING_MAGIC &&
+              hdr_->version == FRAME_RING_VERSION && hdr_->slot_count &&
+              sizeof(FrameRingHeader) + hdr_->slot_stride * hdr_->slot_count <= mapped;
+    if (!ok) {
+        close();
+        return false;
+    }
+    // IN_USE slots are the recorded consumer's buffers while it runs; only once it is
+    // gone are they ours to free (they never come back otherwise)
+    uint32_t self = current_pid();
+    uint32_t owner = hdr_->consumer_pid.load(std::memory_order_acquire);
+    if ((owner && owner != self && process_alive(owner, hdr_->consumer_start)) ||
+        !hdr_->consumer_pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+        busy_pid_ = owner;
+        close();
+        return false;
+    }
+    hdr_->consumer_start = process_start(self);
+    name_ = name;
+    shared_->consumer = self;
+    shared_->slots.resize(hdr_->slot_count);
+    for (uint32_t i = 0; i < hdr_->slot_count; ++i) shared_->slots[i] = {shared_, i};
+    for (uint32_t i = 0; i < hdr_->slot_count; ++i) {
+        uint32_t in_use = FRAME_SLOT_IN_USE;
+        slot_at(i)->state.compare_exchange_strong(in_use, FRAME_SLOT_FREE, std::memory_order_release);
+    }
+    return true;
+}
+
+bool FrameRing::replaced() const {
+    if (!hdr_ || name_.empty()) return false;
+    ShmMapping now;
+    if (!now.map(name_, false, 0, false) || now.size() < sizeof(FrameRingHeader)) return false;   // gone, not back yet
+    const auto* h = static_cast<const FrameRingHeader*>(now.data());
+    return h->magic.load(std::memory_order_acquire) == FRAME_RING_MAGIC && h->epoch != hdr_->epoch;
+}
+
+void FrameRing::close() {
+    if (shared_) shared_->unref();
+    shared_ = nullptr;
+    hdr_ = nullptr;
+    name_.clear();
+}
+
+uint8_t* FrameRing::reserve(size_t size) {
+    if (!hdr_ || size > hdr_->slot_size) return nullptr;
+    FrameRingSlot* s = slot_at(hdr_->write_seq.load(std::memory_order_relaxed));
+    if (s->state.load(std::memory_order_acquire) != FRAME_SLOT_FREE) return nullptr;
+    return reinterpret_cast<uint8_t*>(s) + sizeof(FrameRingSlot);
+}
+
+void FrameRing::commit(uint64_t index, size_t size, uint32_t flags) {
+    uint64_t seq = hdr_->write_seq.load(std::memory_order_relaxed);
+    FrameRingSlot* s = slot_at(seq);
+    s->index = index;
+    s->size = size;
+    s->flags = flags;
+    s->publish_ns = steady_ns();
+    s->state.store(FRAME_SLOT_READY, std::memory_order_release);
+    hdr_->write_seq.store(seq + 1, std::memory_order_release);
+}
+
+bool FrameRing::publish(uint64_t index, const uint8_t* data, size_t size, uint32_t flags) {
+    uint8_t* dst = reserve(size);
+    if (!dst) {
+        if (hdr_) hdr_->overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    memcpy(dst, data, size);
+    commit(index, size, flags);
+    return true;
+}
+
+bool FrameRing::acquire(FrameRingFrame& f, int timeout_ms) {
+    if (!hdr_) return false;
+    uint64_t seq = hdr_->read_seq.load(std::memory_order_relaxed);
+    FrameRingSlot* s = slot_at(seq);
+    if (s->state.load(std::memory_order_acquire) != FRAME_SLOT_READY) {
+        // Frames are due every few ms: spin briefly, then poll
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        for (int spins = 0; s->state.load(std::memory_order_acquire) != FRAME_SLOT_READY; ++spins) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            if (spins < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    s->state.store(FRAME_SLOT_IN_USE, std::memory_order_relaxed);
+    hdr_->read_seq.store(seq + 1, std::memory_order_relaxed);
+    shared_->refs.fetch_add(1, std::memory_order_relaxed);
+
+    f.slot = static_cast<uint32_t>(seq % hdr_->slot_count);
+    f.ref = &shared_->slots[f.slot];
+    f.flags = s->flags;
+    f.index = s->index;
+    f.data = reinterpret_cast<uint8_t*>(s) + sizeof(FrameRingSlot);
+    f.size = static_cast<size_t>(std::min<uint64_t>(s->size, hdr_->slot_size));
+    f.publish_ns = s->publish_ns;
+    return true;
+}
+
+void FrameRing::release(uint32_t slot) {
+    if (shared_ && slot < shared_->slots.size()) release_ref(&shared_->slots[slot]);
+}
+
+void FrameRing::release_ref(void* ref) {
+    if (!ref) return;
+    Shared::SlotRef* r = static_cast<Shared::SlotRef*>(ref);
+    Shared* shared = r->shared;
+    uint8_t* base = reinterpret_cast<uint8_t*>(shared->hdr) + sizeof(FrameRingHeader);
+    auto* s = reinterpret_cast<FrameRingSlot*>(base + r->slot * shared->hdr->slot_stride);
+    s->state.store(FRAME_SLOT_FREE, std::memory_order_release);
+    shared->unref();
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+// --shm-ring: frames handed over in shared memory instead of RAMdisk files.
+//
+// A co-located producer (the receiver, or bench/frame_producer --shm-ring) creates a
+// named ring of fixed-size slots and copies each frame into the next free slot. The
+// feeder maps the same ring and wraps slots as GstBuffers without copying; a slot goes
+// back to the producer when its buffer is freed downstream, in whatever order that
+// happens. Each taken slot holds a reference on the mapping, so a buffer freed after
+// the FrameRing was closed (or destroyed) still releases into mapped memory.
+//
+// One producer and one consumer per ring. The consumer records its pid in the header;
+// open() refuses a ring whose consumer is still running, and frees the slots a dead
+// one left IN_USE. A producer that restarts creates a new object under the same name;
+// the feeder still maps the old one, sees replaced() once it runs dry, and re-opens.
+//
+// Layout (all offsets 64-byte aligned, little-endian, same-host only):
+//   FrameRingHeader | slot 0: FrameRingSlot + payload[slot_size] | slot 1 ...
+// Mapped through ShmMapping (shm_mapping.h).
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+static constexpr uint32_t FRAME_RING_MAGIC = 0x474e5246;   // "FRNG"
+static constexpr uint32_t FRAME_RING_VERSION = 1;
+
+// Slot states; only the producer moves FREE -> READY, only the consumer the rest
+enum : uint32_t {
+    FRAME_SLOT_FREE = 0,     // producer may write it
+    FRAME_SLOT_READY = 1,    // published, not taken yet
+    FRAME_SLOT_IN_USE = 2,   // wrapped in a GstBuffer somewhere in the pipeline
+};
+
+// Slot flags, set by the producer
+enum : uint32_t {
+    FRAME_FLAG_DELTA = 1u << 0,   // P/B frame: the feeder skips it like a small file
+};
+
+struct FrameRingHeader {
+    std::atomic<uint32_t> magic;         // written last by create()
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;                  // payload capacity per slot
+    uint64_t slot_stride;                // bytes from one slot header to the next
+    std::atomic<uint64_t> write_seq;     // frames published so far (producer)
+    std::atomic<uint64_t> read_seq;      // frames taken so far (consumer); survives a feeder restart
+    std::atomic<uint64_t> overruns;      // frames the producer dropped because the next slot was busy
+    std::atomic<uint32_t> consumer_pid;  // feeder that has the ring open, 0 if none
+    uint32_t epoch;                      // set by create(): tells a recreated ring from this one
+    uint64_t consumer_start;             // its start time (Linux: /proc starttime), 0 if unknown
+};
+
+struct FrameRingSlot {
+    std::atomic<uint32_t> state;
+    uint32_t flags;
+    uint64_t index;                      // frame index, as in frame_<camera>_<idx>.hevc
+    uint64_t size;                       // payload bytes
+    int64_t publish_ns;                  // steady clock when published (system-wide monotonic)
+    uint8_t reserved[32];
+};
+
+static_assert(sizeof(FrameRingHeader) == 64, "ring header is part of the shared layout");
+static_assert(sizeof(FrameRingSlot) == 64, "slot header is part of the shared layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring atomics must be address-free");
+
+// One frame taken from the ring; data stays valid until release(slot) or release_ref(ref)
+struct FrameRingFrame {
+    uint32_t slot = 0;
+    uint32_t flags = 0;
+    uint64_t index = 0;
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    int64_t publish_ns = 0;
+    void* ref = nullptr;                 // this frame's hold on the ring, for release_ref()
+};
+
+class FrameRing {
+public:
+    FrameRing() = default;
+    ~FrameRing() { close(); }
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    // Producer: create (or recreate) the ring. Any previous contents are discarded.
+    bool create(const std::string& name, uint32_t slot_count, uint32_t slot_size);
+    // Consumer: map an existing ring. False while another consumer is still running
+    // (busy_pid() says which); slots a dead one left IN_USE are freed.
+    bool open(const std::string& name);
+    // Drop this object's hold; the mapping goes with the last taken frame. The producer
+    // also removes the name.
+    void close();
+    bool is_open() const { return hdr_ != nullptr; }
+    uint32_t busy_pid() const { return busy_pid_; }
+    // Consumer: the name now holds a different ring (the producer restarted); open() it again
+    bool replaced() const;
+
+    uint32_t slot_count() const { return hdr_ ? hdr_->slot_count : 0; }
+    uint32_t slot_size() const { return hdr_ ? hdr_->slot_size : 0; }
+    uint64_t overruns() const { return hdr_ ? hdr_->overruns.load(std::memory_order_relaxed) : 0; }
+
+    // Producer: payload area of the next slot, nullptr if that slot is still in use
+    // (ring full) or size exceeds slot_size. Fill it, then commit().
+    uint8_t* reserve(size_t size);
+    void commit(uint64_t index, size_t size, uint32_t flags);
+    // reserve + copy + commit; false (and an overrun counted) if the frame was dropped
+    bool publish(uint64_t index, const uint8_t* data, size_t size, uint32_t flags);
+
+    // Consumer: next published frame, waiting up to timeout_ms for one
+    bool acquire(FrameRingFrame& f, int timeout_ms);
+    // Hand a taken slot back to the producer; safe from any thread
+    void release(uint32_t slot);
+    // The same as a GDestroyNotify on f.ref: needs no FrameRing, only the frame's hold
+    static void release_ref(void* ref);
+
+private:
+    struct Shared;
+
+    FrameRingSlot* slot_at(uint64_t seq) const;
+
+    Shared* shared_ = nullptr;           // mapping + slot holds, freed with the last reference
+    FrameRingHeader* hdr_ = nullptr;
+    std::string name_;
+    uint32_t busy_pid_ = 0;
+};
@@ -0,0 +1,219 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+
+namespace {
+
+const char* const ALERT_NAMES[ALERT_KINDS] = {"bitrate_low", "bitrate_high", "jitter"};
+
+template <typename T, size_t N>
+T percentile(const std::array<T, N>& values, size_t count, std::array<T, N>& scratch, double p) {
+    if (!count) return 0;
+    std::copy(values.begin(), values.begin() + count, scratch.begin());
+    size_t k = std::min(count - 1, static_cast<size_t>(p * count));
+    std::nth_element(scratch.begin(), scratch.begin() + k, scratch.begin() + count);
+    return scratch[k];
+}
+
+std::string fixed(double v, int decimals) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    return buf;
+}
+
+} // namespace
+
+void FrameStats::configure(unsigned fps, const FrameStatsConfig& cfg, std::ostream* log) {
+    fps_ = std::max(1u, fps);
+    cfg_ = cfg;
+    log_ = log;
+    frame_ns_ = 1000000000LL / fps_;
+    jitter_limit_ns_ = cfg.jitter_ms < 0 ? frame_ns_ / 2 : static_cast<int64_t>(cfg.jitter_ms * 1e6);
+}
+
+void FrameStats::observe(uint64_t index, uint64_t size, bool key, int64_t arrival_ns) {
+    win_bytes_ += size;
+    ++win_frames_;
+
+    if (key) {
+        key_sizes_[keys_++ % KEY_WINDOW] = static_cast<uint32_t>(std::min<uint64_t>(size, UINT32_MAX));
+        if (since_key_) gop_ = gop_ > 0 ? gop_ + (static_cast<double>(since_key_) - gop_) / 8 : since_key_;
+        since_key_ = 0;
+    }
+    if (since_key_ || key) ++since_key_;
+
+    // Only consecutive indices: a gap would count as one long interval
+    if (arrival_ns >= 0 && last_arrival_ns_ >= 0 && index == last_index_ + 1) {
+        int64_t d = arrival_ns - last_arrival_ns_;
+        intervals_[arrivals_++ % ARRIVAL_WINDOW] = d;
+        jitter_ns_ += (std::llabs(d - frame_ns_) - jitter_ns_) / 16;
+    }
+    last_arrival_ns_ = arrival_ns;
+    last_index_ = index;
+
+    if (win_frames_ >= fps_) roll();
+}
+
+void FrameStats::roll() {
+    double rate = static_cast<double>(win_bytes_) * 8 * fps_ / win_frames_;
+    win_bytes_ = 0;
+    win_frames_ = 0;
+    ++seconds_;
+
+    // Bitrate against the baseline
+    if (seconds_ == 1) baseline_ = rate;
+    bool low = cfg_.low_ratio > 0 && rate < baseline_ * cfg_.low_ratio;
+    bool high = cfg_.high_ratio > 0 && rate > baseline_ * cfg_.high_ratio;
+    bool alerting = active(ALERT_BITRATE_LOW) || active(ALERT_BITRATE_HIGH);
+    if (!alerting) {
+        if (low || high) {
+            ++out_run_;
+        } else {
+            out_run_ = 0;
+            baseline_ += (rate - baseline_) / static_cast<double>(std::min<uint64_t>(seconds_, BASELINE_S));
+        }
+        if (out_run_ >= ALERT_HOLD_S && seconds_ > WARMUP_S) {
+            if (low) raise(ALERT_BITRATE_LOW, "bitrate collapsed", rate, baseline_);
+            else raise(ALERT_BITRATE_HIGH, "bitrate jumped", rate, baseline_);
+            alert_since_ = seconds_;
+            in_run_ = 0;
+        }
+    } else {
+        StreamAlert a = active(ALERT_BITRATE_LOW) ? ALERT_BITRATE_LOW : ALERT_BITRATE_HIGH;
+        in_run_ = low || high ? 0 : in_run_ + 1;
+        if (in_run_ >= ALERT_HOLD_S) {
+            clear(a, "bitrate back in range", rate, baseline_);
+        } else if (seconds_ - alert_since_ >= REBASE_S) {
+            clear(a, "bitrate settled, new baseline", rate, baseline_);
+            baseline_ = rate;
+        }
+        if (!active(a)) out_run_ = 0;
+    }
+
+    // Arrival jitter, with the same hold on both edges
+    if (jitter_limit_ns_ > 0 && arrivals_) {
+        bool over = jitter_ns_ > jitter_limit_ns_;
+        bool on = active(ALERT_JITTER);
+        jitter_run_ = over != on ? jitter_run_ + 1 : 0;
+        if (jitter_run_ >= ALERT_HOLD_S) {
+            if (on) clear(ALERT_JITTER, "arrival jitter back to", jitter_ns_ / 1e6, jitter_limit_ns_ / 1e6);
+            else raise(ALERT_JITTER, "arrival jitter", jitter_ns_ / 1e6, jitter_limit_ns_ / 1e6);
+            jitter_run_ = 0;
+        }
+    }
+
+    // Publish the snapshot
+    size_t nkeys = static_cast<size_t>(std::min<uint64_t>(keys_, KEY_WINDOW));
+    uint64_t key_sum = 0;
+    for (size_t i = 0; i < nkeys; ++i) key_sum += key_sizes_[i];
+    size_t nint = static_cast<size_t>(std::min<uint64_t>(arrivals_, ARRIVAL_WINDOW));
+    int64_t int_sum = 0;
+    for (size_t i = 0; i < nint; ++i) int_sum += intervals_[i];
+    pub_bitrate_.store(static_cast<uint64_t>(rate), std::memory_order_relaxed);
+    pub_baseline_.store(static_cast<uint64_t>(baseline_), std::memory_order_relaxed);
+    pub_key_mean_.store(nkeys ? key_sum / nkeys : 0, std::memory_order_relaxed);
+    pub_key_p99_.store(percentile(key_sizes_, nkeys, key_scratch_, 0.99), std::memory_order_relaxed);
+    pub_gop_x100_.store(static_cast<uint64_t>(gop_ * 100 + 0.5), std::memory_order_relaxed);
+    pub_interval_mean_.store(nint ? int_sum / static_cast<int64_t>(nint) : 0, std::memory_order_relaxed);
+    pub_interval_p99_.store(percentile(intervals_, nint, interval_scratch_, 0.99), std::memory_order_relaxed);
+    pub_jitter_.store(static_cast<int64_t>(jitter_ns_), std::memory_order_relaxed);
+    pub_seconds_.store(seconds_, std::memory_order_release);
+}
+
+void FrameStats::raise(StreamAlert a, const char* what, double value, double reference) {
+    active_[a].store(true, std::memory_order_relaxed);
+    raised_[a].fetch_add(1, std::memory_order_relaxed);
+    if (!log_) return;
+    if (a == ALERT_JITTER) {
+        *log_ << "[alert] " << what << " " << fixed(value, 1) << " ms exceeds " << fixed(reference, 1) << " ms\n";
+    } else {
+        *log_ << "[alert] " << what << ": " << fixed(value / 1e6, 2) << " Mbit/s against a baseline of "
+              << fixed(reference / 1e6, 2) << " Mbit/s\n";
+    }
+}
+
+void FrameStats::clear(StreamAlert a, const char* what, double value, double reference) {
+    active_[a].store(false, std::memory_order_relaxed);
+    if (!log_) return;
+    if (a == ALERT_JITTER) {
+        *log_ << "[alert] Cleared: " << what << " " << fixed(value, 1) << " ms (limit " << fixed(reference, 1) << " ms)\n";
+    } else {
+        *log_ << "[alert] Cleared: " << what << ", " << fixed(value / 1e6, 2) << " Mbit/s (baseline was "
+              << fixed(reference / 1e6, 2) << " Mbit/s)\n";
+    }
+}
+
+FrameStatsSnapshot FrameStats::snapshot() const {
+    FrameStatsSnapshot s;
+    s.seconds = pub_seconds_.load(std::memory_order_acquire);
+    s.bitrate_bps = pub_bitrate_.load(std::memory_order_relaxed);
+    s.baseline_bps = pub_baseline_.load(std::memory_order_relaxed);
+    s.keyframe_mean = pub_key_mean_.load(std::memory_order_relaxed);
+    s.keyframe_p99 = pub_key_p99_.load(std::memory_order_relaxed);
+    s.gop = pub_gop_x100_.load(std::memory_order_relaxed) / 100.0;
+    s.interval_mean_ns = pub_interval_mean_.load(std::memory_order_relaxed);
+    s.interval_p99_ns = pub_interval_p99_.load(std::memory_order_relaxed);
+    s.jitter_ns = pub_jitter_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void FrameStats::collect(std::string& out, const std::string& labels) const {
+    FrameStatsSnapshot s = snapshot();
+    if (!s.seconds) return;
+    out += "# TYPE feeder_video_bitrate_bits_per_second gauge\n";
+    out += "feeder_video_bitrate_bits_per_second{" + labels + "} " + std::to_string(s.bitrate_bps) + "\n";
+    out += "# TYPE feeder_video_bitrate_baseline_bits_per_second gauge\n";
+    out += "feeder_video_bitrate_baseline_bits_per_second{" + labels + "} " + std::to_string(s.baseline_bps) + "\n";
+    out += "# TYPE feeder_keyframe_bytes gauge\n";
+    out += "feeder_keyframe_bytes{" + labels + ",stat=\"mean\"} " + std::to_string(s.keyframe_mean) + "\n";
+    out += "feeder_keyframe_bytes{" + labels + ",stat=\"p99\"} " + std::to_string(s.keyframe_p99) + "\n";
+    out += "# TYPE feeder_gop_frames gauge\n";
+    out += "feeder_gop_frames{" + labels + "} " + fixed(s.gop, 2) + "\n";
+    if (s.interval_mean_ns) {
+        out += "# TYPE feeder_arrival_interval_seconds gauge\n";
+        out += "feeder_arrival_interval_seconds{" + labels + ",stat=\"mean\"} " + fixed(s.interval_mean_ns / 1e9, 6) + "\n";
+        out += "feeder_arrival_interval_seconds{" + labels + ",stat=\"p99\"} " + fixed(s.interval_p99_ns / 1e9, 6) + "\n";
+        out += "# TYPE feeder_arrival_jitter_seconds gauge\n";
+        out += "feeder_arrival_jitter_seconds{" + labels + "} " + fixed(s.jitter_ns / 1e9, 6) + "\n";
+    }
+    out += "# TYPE feeder_stream_alert gauge\n";
+    for (int a = 0; a < ALERT_KINDS; ++a) {
+        out += "feeder_stream_alert{" + labels + ",kind=\"" + ALERT_NAMES[a] + "\"} " +
+               (active(static_cast<StreamAlert>(a)) ? "1" : "0") + "\n";
+    }
+    out += "# TYPE feeder_stream_alerts_total counter\n";
+    for (int a = 0; a < ALERT_KINDS; ++a) {
+        out += "feeder_stream_alerts_total{" + labels + ",kind=\"" + ALERT_NAMES[a] + "\"} " +
+               std::to_string(raised(static_cast<StreamAlert>(a))) + "\n";
+    }
+}
+
+void FrameStats::summary(std::ostream& os) const {
+    FrameStatsSnapshot s = snapshot();
+    if (!s.seconds) return;
+    os << fixed(s.bitrate_bps / 1e6, 1) << " Mbit/s (baseline " << fixed(s.baseline_bps / 1e6, 1) << "), keyframe "
+       << s.keyframe_mean / 1024 << "/" << s.keyframe_p99 / 1024 << " KB mean/p99, GOP " << fixed(s.gop, 1);
+    if (s.interval_mean_ns) {
+        os << ", arrival " << fixed(s.interval_mean_ns / 1e6, 1) << "/" << fixed(s.interval_p99_ns / 1e6, 1)
+           << " ms mean/p99, jitter " << fixed(s.jitter_ns / 1e6, 1) << " ms";
+    }
+}
+
+void FrameStats::report(std::ostream& os) const {
+    uint64_t total = 0;
+    for (int a = 0; a < ALERT_KINDS; ++a) total += raised(static_cast<StreamAlert>(a));
+    os << "[analytics] " << total << " alert" << (total == 1 ? "" : "s");
+    const char* sep = " (";
+    for (int a = 0; a < ALERT_KINDS; ++a) {
+        if (uint64_t n = raised(static_cast<StreamAlert>(a))) {
+            os << sep << n << " " << ALERT_NAMES[a];
+            sep = ", ";
+        }
+    }
+    if (total) os << ")";
+    os << "\n";
+}
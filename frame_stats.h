@@ -0,0 +1,121 @@
+#pragma once
+
+// Rolling per-camera stream analytics: bitrate, keyframe size, GOP length and frame
+// inter-arrival time, in constant memory, with alerts when the bitrate collapses or
+// jumps (lens cap, exposure change, encoder fault) or arrivals get jittery.
+//
+// The feeder calls observe() once per frame index it is handed, including the P/B frames
+// it skips (not again when a read of the same frame is retried). Time is the stream's own: bitrate is the bytes of the last second of frames
+// (fps frames) at the nominal rate, so it reads the same live, --offline and under
+// --sim-hours. Each completed second rolls the window: the snapshot read by the [stats]
+// line and by metrics scrapes is refreshed (plain atomics, no lock) and the alerts are
+// evaluated. A stream that stops altogether rolls nothing; that is the missing-frame
+// and stall handling's business.
+//
+// Bitrate alerts compare each second with a baseline (EWMA over ~BASELINE_S seconds)
+// that out-of-band seconds do not feed. An alert is raised after ALERT_HOLD_S seconds
+// out of band and cleared after ALERT_HOLD_S seconds back in it; one still active after
+// REBASE_S seconds takes the current rate as the new baseline and clears. Jitter is
+// RFC 3550's running mean of |interval - frame interval| over the arrival times of
+// consecutive frames (ring publish, network arrival or file mtime).
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+enum StreamAlert { ALERT_BITRATE_LOW = 0, ALERT_BITRATE_HIGH = 1, ALERT_JITTER = 2, ALERT_KINDS = 3 };
+
+struct FrameStatsConfig {
+    double low_ratio = 0.5;              // second below baseline * low_ratio: collapse (0 = off)
+    double high_ratio = 2.0;             // second above baseline * high_ratio: jump (0 = off)
+    double jitter_ms = -1.0;             // jitter above this: alert; < 0 = half a frame interval, 0 = off
+};
+
+// Values as of the last completed second
+struct FrameStatsSnapshot {
+    uint64_t seconds = 0;                // seconds of stream seen, 0 = nothing to report yet
+    uint64_t bitrate_bps = 0;
+    uint64_t baseline_bps = 0;
+    uint64_t keyframe_mean = 0;          // bytes, over the last KEY_WINDOW keyframes
+    uint64_t keyframe_p99 = 0;
+    double gop = 0.0;                    // frames per GOP (smoothed), 0 = fewer than two keyframes yet
+    int64_t interval_mean_ns = 0;        // inter-arrival time over the last ARRIVAL_WINDOW frames,
+    int64_t interval_p99_ns = 0;         // 0 = arrival times unknown
+    int64_t jitter_ns = 0;
+};
+
+class FrameStats {
+public:
+    static constexpr size_t KEY_WINDOW = 256;
+    static constexpr size_t ARRIVAL_WINDOW = 256;
+    static constexpr int ALERT_HOLD_S = 2;
+    static constexpr int BASELINE_S = 30;
+    static constexpr int WARMUP_S = 10;  // no bitrate alerts before the baseline has this many seconds
+    static constexpr int REBASE_S = 60;
+
+    FrameStats() = default;
+    FrameStats(const FrameStats&) = delete;
+    FrameStats& operator=(const FrameStats&) = delete;
+
+    // Before the first observe(); log receives the "[alert]" lines (nullptr = silent)
+    void configure(unsigned fps, const FrameStatsConfig& cfg, std::ostream* log);
+
+    // Feeder thread, every frame: index as in the file name, payload bytes, whether the
+    // feeder treats it as a keyframe, and when it arrived (ns on a clock consistent across
+    // calls, < 0 = unknown)
+    void observe(uint64_t index, uint64_t size, bool key, int64_t arrival_ns);
+
+    // Any thread
+    FrameStatsSnapshot snapshot() const;
+    bool active(StreamAlert a) const { return active_[a].load(std::memory_order_relaxed); }
+    uint64_t raised(StreamAlert a) const { return raised_[a].load(std::memory_order_relaxed); }
+    // Prometheus lines (feeder_video_bitrate_bits_per_second, feeder_keyframe_bytes,
+    // feeder_gop_frames, feeder_arrival_*, feeder_stream_alert{kind=}, ...)
+    void collect(std::string& out, const std::string& labels) const;
+    // "14.8 Mbit/s (baseline 15.0), keyframe 62/81 KB mean/p99, GOP 1.0, arrival 40.0/41.3 ms mean/p99, jitter 0.4 ms"
+    void summary(std::ostream& os) const;
+    // Alert totals at exit: "[analytics] 2 alerts (1 bitrate_low, 1 jitter)"
+    void report(std::ostream& os) const;
+
+private:
+    void roll();
+    void raise(StreamAlert a, const char* what, double value, double reference);
+    void clear(StreamAlert a, const char* what, double value, double reference);
+
+    unsigned fps_ = 0;
+    FrameStatsConfig cfg_;
+    int64_t jitter_limit_ns_ = 0;        // 0 = no jitter alerts
+    int64_t frame_ns_ = 0;
+    std::ostream* log_ = nullptr;
+
+    // Feeder thread only
+    uint64_t win_bytes_ = 0;
+    unsigned win_frames_ = 0;
+    uint64_t seconds_ = 0;
+    std::array<uint32_t, KEY_WINDOW> key_sizes_{};
+    uint64_t keys_ = 0;
+    uint64_t since_key_ = 0;             // frames since the last keyframe, 0 = none yet
+    double gop_ = 0.0;
+    std::array<int64_t, ARRIVAL_WINDOW> intervals_{};
+    uint64_t arrivals_ = 0;
+    int64_t last_arrival_ns_ = -1;
+    uint64_t last_index_ = 0;
+    double jitter_ns_ = 0.0;
+    double baseline_ = 0.0;
+    int out_run_ = 0;                    // consecutive seconds out of band / back in band
+    int in_run_ = 0;
+    uint64_t alert_since_ = 0;
+    int jitter_run_ = 0;
+    std::array<uint32_t, KEY_WINDOW> key_scratch_{};
+    std::array<int64_t, ARRIVAL_WINDOW> interval_scratch_{};
+
+    // Published on roll
+    std::atomic<uint64_t> pub_seconds_{0}, pub_bitrate_{0}, pub_baseline_{0}, pub_key_mean_{0}, pub_key_p99_{0};
+    std::atomic<uint64_t> pub_gop_x100_{0};
+    std::atomic<int64_t> pub_interval_mean_{0}, pub_interval_p99_{0}, pub_jitter_{0};
+    std::atomic<bool> active_[ALERT_KINDS] = {};
+    std::atomic<uint64_t> raised_[ALERT_KINDS] = {};
+};
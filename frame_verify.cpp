@@ -0,0 +1,240 @@
+#include "frame_verify.h"
+
+#include "metrics.h"
+
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+bool DecodeVerifier::start(guint every, guint budget_pct, int core, const std::string& failures_csv,
+                           ParamSetCache& param_sets) {
+    stop();
+    param_sets_ = &param_sets;
+    every_ = every;
+    budget_pct_ = std::min<guint>(100, std::max<guint>(1, budget_pct));
+    core_ = core;
+    offered_ = 0;
+    stopping_ = false;
+    head_ = count_ = 0;
+    queue_.assign(QUEUE_FRAMES, Job{nullptr, 0, false});
+
+    failures_.open(failures_csv, std::ios::out | std::ios::app);
+    if (!failures_.is_open()) {
+        std::cerr << "[verify] Cannot open " << failures_csv << "\n";
+        return false;
+    }
+    if (failures_.tellp() == 0) failures_ << "FrameIndex,Error\n";
+
+    // output-corrupt=false: a picture the decoder had to conceal is not output, i.e. fails.
+    // No appsrc: the worker pushes into the parser itself, so parse and decode run on the
+    // worker thread and the pipeline has no streaming thread of its own.
+    GError* err = nullptr;
+    pipeline_ = gst_parse_launch(
+        "h265parse name=parse ! avdec_h265 max-threads=1 output-corrupt=false"
+        " ! appsink name=sink sync=false async=false max-buffers=1 drop=true", &err);
+    if (!pipeline_ || err) {
+        std::cerr << "[verify] Cannot build the decode pipeline: " << (err ? err->message : "?") << "\n";
+        if (err) g_error_free(err);
+        stop();
+        return false;
+    }
+    sink_ = gst_bin_get_by_name(GST_BIN(pipeline_), "sink");
+    GstElement* parse = gst_bin_get_by_name(GST_BIN(pipeline_), "parse");
+    GstPad* parse_sink = gst_element_get_static_pad(parse, "sink");
+    src_ = gst_pad_new("verify_src", GST_PAD_SRC);
+    gst_pad_set_active(src_, TRUE);
+    bool linked = gst_pad_link(src_, parse_sink) == GST_PAD_LINK_OK;
+    gst_object_unref(parse_sink);
+    gst_object_unref(parse);
+    GstBus* bus = gst_element_get_bus(pipeline_);
+    gst_bus_set_sync_handler(bus, on_sync_message, NULL, NULL);
+    gst_object_unref(bus);
+    if (!linked || gst_element_set_state(pipeline_, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        std::cerr << "[verify] Cannot start the decode pipeline\n";
+        stop();
+        return false;
+    }
+    gst_pad_push_event(src_, gst_event_new_stream_start("verify"));
+    GstCaps* caps = gst_caps_from_string("video/x-h265,stream-format=byte-stream,alignment=au");
+    gst_pad_push_event(src_, gst_event_new_caps(caps));
+    gst_caps_unref(caps);
+    worker_ = std::thread(&DecodeVerifier::run, this);
+    return true;
+}
+
+void DecodeVerifier::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stopping_ = true;
+        for (; count_; --count_, head_ = (head_ + 1) % queue_.size()) gst_buffer_unref(queue_[head_].buffer);
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+    if (pipeline_) gst_element_set_state(pipeline_, GST_STATE_NULL);
+    if (src_) {
+        gst_pad_set_active(src_, FALSE);
+        gst_object_unref(src_);
+    }
+    if (sink_) gst_object_unref(sink_);
+    if (pipeline_) gst_object_unref(pipeline_);
+    pipeline_ = sink_ = nullptr;
+    src_ = nullptr;
+    if (failures_.is_open()) failures_.close();
+}
+
+void DecodeVerifier::offer(GstBuffer* buffer, guint64 index, bool ball_start) {
+    if (!pipeline_) return;
+    bool sampled = every_ && offered_++ % every_ == 0;
+    // Only keyframes decode on their own (the feeder pushes nothing else)
+    if ((!sampled && !ball_start) || GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) return;
+
+    std::unique_lock<std::mutex> lock(mu_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        metric_inc(stats_.skipped);
+        return;
+    }
+    if (count_ == queue_.size()) {
+        // A ball start displaces the oldest sampled frame; otherwise this one is skipped
+        size_t i = 0;
+        while (ball_start && i < count_ && queue_[(head_ + i) % queue_.size()].ball_start) ++i;
+        metric_inc(stats_.skipped);
+        if (!ball_start || i == count_) return;
+        gst_buffer_unref(queue_[(head_ + i) % queue_.size()].buffer);
+        for (; i + 1 < count_; ++i) queue_[(head_ + i) % queue_.size()] = queue_[(head_ + i + 1) % queue_.size()];
+        --count_;
+    }
+    queue_[(head_ + count_) % queue_.size()] = Job{gst_buffer_ref(buffer), index, ball_start};
+    ++count_;
+    lock.unlock();
+    cv_.notify_one();
+}
+
+void DecodeVerifier::run() {
+    lower_priority();
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            cv_.wait(lock, [this] { return stopping_ || count_; });
+            if (stopping_) return;
+            job = queue_[head_];
+            head_ = (head_ + 1) % queue_.size();
+            --count_;
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        std::string detail;
+        bool ok = decode(job, detail);
+        gst_buffer_unref(job.buffer);
+        auto took = std::chrono::steady_clock::now() - t0;
+        stats_.decode_ns.fetch_add(static_cast<guint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(took).count()),
+                                   std::memory_order_relaxed);
+        if (ok) {
+            metric_inc(stats_.ok);
+        } else {
+            metric_inc(stats_.failed);
+            stats_.last_failed_index.store(job.index, std::memory_order_relaxed);
+            std::cerr << "[verify] Frame " << job.index << (job.ball_start ? " (ball start)" : "")
+                      << " failed to decode: " << detail << "\n";
+            for (char& c : detail) if (c == ',' || c == '\n') c = ' ';
+            failures_ << job.index << "," << detail << "\n";
+            failures_.flush();
+        }
+
+        // Stay within the CPU budget: rest in proportion to the work just done
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait_for(lock, took * (100 - budget_pct_) / budget_pct_, [this] { return stopping_; });
+        if (stopping_) return;
+    }
+}
+
+bool DecodeVerifier::decode(const Job& job, std::string& detail) {
+    GstBuffer* au = param_sets_->decodable(job.buffer);
+    if (!au) {
+        detail = "no VPS/SPS/PPS seen yet";
+        return false;
+    }
+    // Flush out whatever the previous frame left (error state, EOS), then one frame and
+    // EOS, which makes the decoder give up the picture instead of holding it for
+    // reordering. All of it runs synchronously, here.
+    GstSegment segment;
+    gst_segment_init(&segment, GST_FORMAT_TIME);
+    gst_pad_push_event(src_, gst_event_new_flush_start());
+    gst_pad_push_event(src_, gst_event_new_flush_stop(TRUE));
+    gst_pad_push_event(src_, gst_event_new_segment(&segment));
+    GstFlowReturn ret = gst_pad_push(src_, au);
+    if (ret == GST_FLOW_OK) gst_pad_push_event(src_, gst_event_new_eos());
+    GstSample* sample = gst_app_sink_try_pull_sample(GST_APP_SINK(sink_), 0);
+
+    GstBus* bus = gst_element_get_bus(pipeline_);
+    while (GstMessage* msg = gst_bus_pop_filtered(bus, static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_WARNING))) {
+        GError* err = nullptr;
+        if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) gst_message_parse_error(msg, &err, NULL);
+        else gst_message_parse_warning(msg, &err, NULL);
+        if (err && detail.empty()) detail = std::string(GST_OBJECT_NAME(GST_MESSAGE_SRC(msg))) + ": " + err->message;
+        if (err) g_error_free(err);
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+    if (detail.empty() && ret != GST_FLOW_OK) detail = std::string("flow ") + gst_flow_get_name(ret);
+    if (detail.empty() && !sample) detail = "no picture decoded";
+    if (sample) gst_sample_unref(sample);
+    return detail.empty();
+}
+
+GstBusSyncReply DecodeVerifier::on_sync_message(GstBus* bus, GstMessage* msg, gpointer data) {
+    (void)bus;
+    (void)data;
+    // Nothing watches this bus: keep only what decode() pops, or the rest piles up
+    return GST_MESSAGE_TYPE(msg) & (GST_MESSAGE_ERROR | GST_MESSAGE_WARNING) ? GST_BUS_PASS : GST_BUS_DROP;
+}
+// The worker is the only thread the verifier runs on (decoding included)
+void DecodeVerifier::lower_priority() const {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE);
+    if (core_ >= 0 && !SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core_))
+        std::cerr << "[verify] Cannot pin to CPU " << core_ << "\n";
+#elif defined(__linux__)
+    // SCHED_IDLE: runs only on time no other thread wants
+    sched_param sp{};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &sp);
+    if (core_ >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core_, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            std::cerr << "[verify] Cannot pin to CPU " << core_ << "\n";
+    }
+#endif
+}
+
+void DecodeVerifier::collect(std::string& out, const std::string& labels) const {
+    out += "# TYPE feeder_verify_frames_total counter\n";
+    out += "feeder_verify_frames_total{" + labels + ",result=\"ok\"} " + std::to_string(stats_.ok.load(std::memory_order_relaxed)) + "\n";
+    out += "feeder_verify_frames_total{" + labels + ",result=\"failed\"} " + std::to_string(stats_.failed.load(std::memory_order_relaxed)) + "\n";
+    out += "feeder_verify_frames_total{" + labels + ",result=\"skipped\"} " + std::to_string(stats_.skipped.load(std::memory_order_relaxed)) + "\n";
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6f", stats_.decode_ns.load(std::memory_order_relaxed) / 1e9);
+    out += "# TYPE feeder_verify_decode_seconds_total counter\n";
+    out += "feeder_verify_decode_seconds_total{" + labels + "} " + buf + "\n";
+}
+
+void DecodeVerifier::report(std::ostream& os) const {
+    guint64 ok = stats_.ok.load(std::memory_order_relaxed);
+    guint64 failed = stats_.failed.load(std::memory_order_relaxed);
+    guint64 checked = ok + failed;
+    char mean[32];
+    snprintf(mean, sizeof(mean), "%.1f", checked ? stats_.decode_ns.load(std::memory_order_relaxed) / 1e6 / checked : 0.0);
+    os << "[verify] " << checked << " frames decoded (mean " << mean << " ms), " << failed << " failed";
+    if (failed) os << " (last: frame " << stats_.last_failed_index.load(std::memory_order_relaxed) << ")";
+    os << ", " << stats_.skipped.load(std::memory_order_relaxed) << " skipped\n";
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <gst/gst.h>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "param_sets.h"
+
+// --verify: decode a sample of the pushed frames in the background, to catch payloads
+// that pass the size heuristic but do not decode, while they are still on the RAMdisk
+// rather than in replay.
+//
+// video_probe offers every frame; one in `every`, and every ball-start frame (isStart
+// in the metadata, or the first frame of a new ball), is queued by reference (no copy).
+// A single worker thread pushes it through a private
+//   h265parse ! avdec_h265 max-threads=1 output-corrupt=false ! appsink
+// itself (no appsrc, so the decode runs synchronously on the worker) and fails it if
+// no picture comes out or the decoder reports an error or warning. Failures are logged
+// and appended to the failure CSV with the frame index.
+//
+// The verifier must never compete with the feeder. Its one thread runs at idle priority
+// (SCHED_IDLE / THREAD_PRIORITY_IDLE), optionally pinned to a spare core, and is held
+// to `budget_pct` percent of one core: after a decode that took d, the worker rests
+// d * (100 - budget_pct) / budget_pct. offer() never waits. A frame due while the
+// queue is full is skipped and counted; a ball-start frame takes the place of the
+// oldest sampled frame instead.
+
+struct VerifyStats {
+    std::atomic<guint64> ok{0};
+    std::atomic<guint64> failed{0};
+    std::atomic<guint64> skipped{0};     // due, but the queue was full (budget exhausted)
+    std::atomic<guint64> decode_ns{0};   // total decode time of the frames checked
+    std::atomic<guint64> last_failed_index{0};
+};
+
+class DecodeVerifier {
+public:
+    static constexpr size_t QUEUE_FRAMES = 8;
+
+    DecodeVerifier() = default;
+    ~DecodeVerifier() { stop(); }
+    DecodeVerifier(const DecodeVerifier&) = delete;
+    DecodeVerifier& operator=(const DecodeVerifier&) = delete;
+
+    // After gst_init. every: 1 in N pushed frames (0 = ball starts only); core: pin the
+    // verifier's threads to this CPU (-1 = anywhere); failures go to failures_csv;
+    // param_sets: the feeder's, for keyframes without in-band VPS/SPS/PPS.
+    bool start(guint every, guint budget_pct, int core, const std::string& failures_csv,
+               ParamSetCache& param_sets);
+    // Drops queued frames, waits for the one being decoded
+    void stop();
+    bool running() const { return worker_.joinable(); }
+
+    // Streaming thread: consider this pushed frame (index as in the file name)
+    void offer(GstBuffer* buffer, guint64 index, bool ball_start);
+
+    const VerifyStats& stats() const { return stats_; }
+    // Prometheus lines (feeder_verify_frames_total{result=}, feeder_verify_decode_seconds_total)
+    void collect(std::string& out, const std::string& labels) const;
+    // "[verify] 412 frames decoded (mean 6.1 ms), 1 failed (last: frame 2379123), 3 skipped"
+    void report(std::ostream& os) const;
+
+private:
+    struct Job {
+        GstBuffer* buffer;
+        guint64 index;
+        bool ball_start;
+    };
+
+    void run();
+    // true if the frame decoded; otherwise detail says why
+    bool decode(const Job& job, std::string& detail);
+    static GstBusSyncReply on_sync_message(GstBus* bus, GstMessage* msg, gpointer data);
+    void lower_priority() const;
+
+    guint every_ = 0;
+    guint budget_pct_ = 20;
+    int core_ = -1;
+    guint64 offered_ = 0;                    // streaming thread only
+
+    GstElement* pipeline_ = nullptr;
+    GstPad* src_ = nullptr;                  // feeds the parser from the worker thread
+    GstElement* sink_ = nullptr;
+    ParamSetCache* param_sets_ = nullptr;    // shared, kept up to date by the feeder
+    std::ofstream failures_;
+
+    std::vector<Job> queue_;                 // fixed capacity, offer() never allocates
+    size_t head_ = 0, count_ = 0;
+    bool stopping_ = false;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::thread worker_;
+    VerifyStats stats_;
+};
@@ -0,0 +1,134 @@
+#include "latency_trace.h"
+
+// ---------------------- FrameMeta ----------------------
+GType frame_meta_api_get_type() {
+    static const gchar* tags[] = { NULL };
+    static GType type = gst_meta_api_type_register("FrameMetaAPI", tags);
+    return type;
+}
+
+static gboolean frame_meta_init(GstMeta* meta, gpointer params, GstBuffer* buffer) {
+    (void)params; (void)buffer;
+    FrameMeta* fm = reinterpret_cast<FrameMeta*>(meta);
+    fm->seq = 0;
+    fm->file_index = 0;
+    fm->crc = 0;
+    fm->size = 0;
+    return TRUE;
+}
+
+// One access unit stays one access unit through h265parse, so any copy or region
+// copy of the buffer still describes the same frame.
+static gboolean frame_meta_transform(GstBuffer* dest, GstMeta* meta, GstBuffer* buffer,
+                                     GQuark type, gpointer data) {
+    (void)buffer; (void)type; (void)data;
+    const FrameMeta* src = reinterpret_cast<const FrameMeta*>(meta);
+    frame_meta_attach(dest, src->seq, src->file_index, src->crc, src->size);
+    return TRUE;
+}
+
+const GstMetaInfo* frame_meta_get_info() {
+    static const GstMetaInfo* info = gst_meta_register(
+        frame_meta_api_get_type(), "FrameMeta", sizeof(FrameMeta),
+        frame_meta_init, NULL, frame_meta_transform);
+    return info;
+}
+
+void frame_meta_attach(GstBuffer* buffer, guint64 seq, guint64 file_index, guint32 crc, guint32 size) {
+    FrameMeta* fm = reinterpret_cast<FrameMeta*>(gst_buffer_get_meta(buffer, frame_meta_api_get_type()));
+    if (!fm) {
+        fm = reinterpret_cast<FrameMeta*>(gst_buffer_add_meta(buffer, frame_meta_get_info(), NULL));
+        if (!fm) return;
+        // Stays on pooled buffers across reuse, so it is allocated once per pool buffer
+        GST_META_FLAG_SET(reinterpret_cast<GstMeta*>(fm), GST_META_FLAG_POOLED);
+    }
+    fm->seq = seq;
+    fm->file_index = file_index;
+    fm->crc = crc;
+    fm->size = size;
+}
+
+const FrameMeta* frame_meta_get(GstBuffer* buffer) {
+    return reinterpret_cast<const FrameMeta*>(gst_buffer_get_meta(buffer, frame_meta_api_get_type()));
+}
+
+// ---------------------- Probes ----------------------
+static void note_mux_input(GstBuffer* buffer) {
+    const FrameMeta* fm = frame_meta_get(buffer);
+    if (fm) trace_mux_input(fm->seq);
+}
+
+static gboolean note_mux_input_item(GstBuffer** buffer, guint idx, gpointer user_data) {
+    (void)idx; (void)user_data;
+    note_mux_input(*buffer);
+    return TRUE;
+}
+
+GstPadProbeReturn trace_mux_input_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+    (void)pad; (void)user_data;
+    if (!trace_enabled()) return GST_PAD_PROBE_OK;
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        note_mux_input(GST_PAD_PROBE_INFO_BUFFER(info));
+    } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        gst_buffer_list_foreach(GST_PAD_PROBE_INFO_BUFFER_LIST(info), note_mux_input_item, NULL);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+static guint32 video_pes_starts(GstBuffer* buffer) {
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) return 0;
+    guint32 n = ts_video_pes_starts(map.data, map.size);
+    gst_buffer_unmap(buffer, &map);
+    return n;
+}
+
+static gboolean count_video_pes_item(GstBuffer** buffer, guint idx, gpointer count) {
+    (void)idx;
+    *static_cast<guint32*>(count) += video_pes_starts(*buffer);
+    return TRUE;
+}
+
+// Only outputs that start a video PES mark frames muxed; audio and PSI buffers in
+// between (or, with --out's 7-packet buffers, the middle of a frame) mark nothing
+GstPadProbeReturn trace_mux_output_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+    (void)pad; (void)user_data;
+    if (!trace_enabled()) return GST_PAD_PROBE_OK;
+    guint32 n = 0;
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        n = video_pes_starts(GST_PAD_PROBE_INFO_BUFFER(info));
+    } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        gst_buffer_list_foreach(GST_PAD_PROBE_INFO_BUFFER_LIST(info), count_video_pes_item, &n);
+    }
+    trace_mux_output(n);
+    return GST_PAD_PROBE_OK;
+}
+
+// filesink sits on the mux streaming thread (no queue in front of it, also behind the
+// --out tee), and GstBaseSink renders inside its chain function. So when the chain
+// returns, the buffer the mux just pushed is on disk, and with it every frame muxed so
+// far. A pad probe would fire before the write.
+static GstPadChainFunction sink_chain = NULL;
+static GstPadChainListFunction sink_chain_list = NULL;
+
+static GstFlowReturn traced_sink_chain(GstPad* pad, GstObject* parent, GstBuffer* buffer) {
+    GstFlowReturn ret = sink_chain(pad, parent, buffer);
+    trace_written();
+    return ret;
+}
+
+static GstFlowReturn traced_sink_chain_list(GstPad* pad, GstObject* parent, GstBufferList* list) {
+    GstFlowReturn ret = sink_chain_list(pad, parent, list);
+    trace_written();
+    return ret;
+}
+
+void trace_wrap_sink(GstElement* filesink) {
+    GstPad* pad = gst_element_get_static_pad(filesink, "sink");
+    if (!pad) return;
+    sink_chain = GST_PAD_CHAINFUNC(pad);
+    sink_chain_list = GST_PAD_CHAINLISTFUNC(pad);
+    if (sink_chain) gst_pad_set_chain_function(pad, traced_sink_chain);
+    if (sink_chain_list) gst_pad_set_chain_list_function(pad, traced_sink_chain_list);
+    gst_object_unref(pad);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <gst/gst.h>
+
+#include "trace_ring.h"
+
+// Per-frame latency tracing: file arrival -> bytes on disk.
+//
+// Every pushed buffer carries a FrameMeta with its push sequence number and file
+// index, so probes downstream of h265parse (which rewrites GST_BUFFER_OFFSET) can
+// still tell which frame they are looking at. The stage ring and histograms are in
+// trace_ring.h; this file holds the meta and the probes that feed them.
+
+struct FrameMeta {
+    GstMeta meta;
+    guint64 seq;         // frame_counter at push time
+    guint64 file_index;  // index in frame_<cam>_<idx>.hevc
+    guint32 crc;         // CRC32C of the payload as loaded (--crc), else 0
+    guint32 size;        // payload bytes as loaded, before any parameter sets are prepended
+};
+
+GType frame_meta_api_get_type();
+const GstMetaInfo* frame_meta_get_info();
+void frame_meta_attach(GstBuffer* buffer, guint64 seq, guint64 file_index, guint32 crc = 0, guint32 size = 0);
+const FrameMeta* frame_meta_get(GstBuffer* buffer);
+
+// Probes that close the loop after the parser: queue1 src (frame handed to the mux)
+// and mpegtsmux src (mux output).
+GstPadProbeReturn trace_mux_input_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+GstPadProbeReturn trace_mux_output_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
+// Wraps the filesink's chain functions so the write stage is stamped when its write()
+// has returned. Call once, before the pipeline leaves NULL.
+void trace_wrap_sink(GstElement* filesink);
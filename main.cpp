@@ -10,8 +10,30 @@
 #include <string>
 #include <algorithm>
 #include <limits>
+#include <cstdlib>
+#include <future>
+#include <stdexcept>
 #include <hiredis/hiredis.h>
 
+#include "alloc_count.h"
+#include "feeder_core.h"
+#include "frame_arena.h"
+#include "frame_cleanup.h"
+#include "frame_net.h"
+#include "frame_ring.h"
+#include "latency_trace.h"
+#include "metrics.h"
+#include "numa_placement.h"
+#include "simulation.h"
+#include "thumbnails.h"
+#include "ts_outputs.h"
+#include "ts_http.h"
+#include "video_ring.h"
+#include "self_heal.h"
+#include "frame_stats.h"
+#include "frame_verify.h"
+#include "startup_timeline.h"
+
 namespace fs = std::filesystem;
 static guint64 frame_counter = 0;
 static guint64 audio_frame_counter = 0;
@@ -21,10 +43,68 @@ static guint64 current_index = 0;
 static guint TARGET_FPS = 0;
 static double FrameIntervalMs = 0.0;
 
+// Optional flags (parsed after the positional arguments)
+static guint BATCH_MAX = 1;          // --batch=N : max frames per gst_app_src_push_buffer_list call
+static bool OFFLINE_MODE = false;    // --offline : remux an existing folder as fast as possible
+static guint SKIP_MISSING_MS = 0;    // --skip-missing-ms=N : give up on a missing frame after N ms (0 = wait forever)
+static bool NO_AUDIO = false;        // --no-audio : video only (benchmarks, sites without the audio bridge)
+static bool FAST_START = false;      // --fast-start : video starts without waiting for live audio, which joins the mux later
+static std::string METRICS_ADDR;     // --metrics=[host:]port : Prometheus text endpoint
+static bool BYPASS_PARSE = false;    // --no-parse : feeder sets caps/flags itself, appsrc -> queue -> mux
+static std::string REDIS_ADDR = "192.168.5.102:6379";                 // --redis=HOST[:PORT] (off = no lookups)
+static std::string AUDIO_URL = "http://192.168.5.100:53354/audio";    // --audio-url=URL
+static double SIM_HOURS = 0.0;       // --sim-hours=H : virtual clock, cycle the input folder, stop after H simulated hours
+static std::vector<std::string> sim_frames;   // frame files cycled through with --sim-hours
+static std::string SHM_RING;         // --shm-ring=NAME : frames from a shared-memory ring instead of files
+static FrameRing frame_ring;
+static std::string LISTEN_ADDR;      // --listen=[HOST:]PORT / --listen-udp=[HOST:]PORT : frames over the network
+static bool LISTEN_UDP = false;
+static FrameReceiver frame_receiver;
+static bool CLEANUP = false;          // --cleanup[=KEEP] : remove consumed frame files, keeping the newest KEEP
+static guint64 CLEANUP_KEEP = 0;     // 0 = 10 s worth of frames
+static FrameCleaner frame_cleaner;
+static guint HUGE_PAGES_MB = 0;      // --huge-pages[=MB] : frame buffers from a huge-page arena (0 = off, the default; see frame_arena.h)
+static FrameArena frame_arena;
+static std::string NUMA_NODE;        // --numa-node=N|auto|IFACE : run this camera on one NUMA node
+static int numa_node = -1;           // resolved node, -1 = no placement
+static std::string THUMBS_DIR;       // --thumbnails=DIR : keyframe thumbnails for the operator preview
+static guint THUMB_EVERY = 0;        // --thumb-every=N : frames between thumbnails (0 = one per second)
+static guint THUMB_WIDTH = 320;      // --thumb-width=W
+static guint THUMB_WORKERS = 2;      // --thumb-workers=N : decode threads
+static bool THUMB_WEBP = false;      // --thumb-webp : WebP instead of JPEG
+static Thumbnailer thumbnailer;
+static guint VERIFY_EVERY = 0;       // --verify[=N] : decode 1 in N pushed frames (default 50) and every ball start in the background
+static guint VERIFY_BUDGET = 20;     // --verify-budget=PCT : share of one core the verifier may use
+static int VERIFY_CORE = -1;         // --verify-core=N : pin the verifier to this CPU
+static bool VERIFY = false;
+static DecodeVerifier verifier;
+static TsOutputs ts_outputs;         // --out=udp://|rtp://|srt://... : live copies of the TS (repeatable)
+static std::string HTTP_ADDR;        // --http=[HOST:]PORT : serve the growing recording at /live.ts
+static TsHttpServer ts_http;
+static std::string SHM_OUT;          // --shm-out=NAME : parsed AUs + metadata in a shared-memory ring for local consumers
+static guint SHM_OUT_SLOTS = 64;     // --shm-out-slots=N
+static guint SHM_OUT_SLOT_KB = 2048; // --shm-out-slot-kb=KB : largest AU
+static VideoRing video_ring;
+static bool SELF_HEAL = false;       // --self-heal[=STALL_MS] : restart a failed branch / the pipeline in-process
+static guint HEAL_STALL_MS = 2000;   // no output at filesink this long with frames pushed = stalled
+static guint HEAL_TEST_S = 0;        // --heal-test=SECONDS : inject an element error this often (bench/run_heal_test.sh)
+static PipelineSupervisor supervisor;
+static bool FRAME_CRC = false;       // --crc[=drop] : CRC32C per frame in the CSV, flag repeated / broken payloads
+static bool DROP_DUPLICATES = false; // --crc=drop : do not push a payload that was pushed recently
+static FrameStatsConfig STREAM_ALERTS;   // --bitrate-alert=LOW,HIGH|off, --jitter-alert-ms=MS : stream analytics alerts
+static FrameStats frame_stats;
+static const guint NET_REORDER_MS = 100;   // give up on a missing network frame after this (or --skip-missing-ms)
+
+
 static guint64 initial_pts_base = 0;
 static guint64 pts_increment = 0;
 
 static std::string FRAME_FOLDER;
+
+static const guint FRAME_POOL_BUFFER_SIZE = 512 * 1024;   // I-frames run 150-300 KB
+static const guint FRAME_POOL_MIN_BUFFERS = 32;
+static const guint64 ALLOC_WARMUP_FRAMES = 1000;           // allocations are counted from here on
+static const int REDIS_CONNECT_TIMEOUT_MS = 500;           // startup continues without Redis after this
 static std::ofstream csv_output;
 static std::ofstream csv_output_audio;
 static std::ofstream csv_output_summary;
@@ -38,133 +118,138 @@ struct ProbeData {
     redisContext *redis;          // redis context (may be nullptr)
 };
 
-// === Helper Functions ===
-guint64 find_first_index_fast(const std::string& folder) {
-    for (const auto& entry : fs::directory_iterator(folder)) {
-        if (entry.is_regular_file()) {
-            
-            std::string fname = entry.path().filename().string();
-            if (fname.find("frame_camera01_") == 0 && fname.find(".hevc") != std::string::npos) {
-                std::string number_str = fname.substr(
-                    std::string("frame_camera01_").size(),
-                    fname.size() - std::string("frame_camera01_").size() - 5
-                );
-                try {
-                    return std::stoull(number_str);
-                } catch (...) {
-                    throw std::runtime_error("[error] Invalid file name: " + fname);
-                }
-            }
-        }
-    }
-    throw std::runtime_error("[error] No valid files found in folder: " + folder);
+// What h265parse would otherwise do for us: delta flags, caps with the coded size,
+// and parameter sets in front of keyframes that arrive without them.
+static ParamSetCache param_sets;   // also what the thumbnail and --verify decoders prepend
+static int caps_width = 0, caps_height = 0;
+
+// A new parameter set was learned from this keyframe: caps follow the coded size
+static void update_caps(GstElement *appsrc, const guint8* data, const AuInfo& au) {
+    int w = 0, h = 0;
+    if (!parse_sps_dimensions(data + au.sps.offset, au.sps.size, w, h) || (w == caps_width && h == caps_height))
+        return;
+    caps_width = w;
+    caps_height = h;
+    GstCaps *caps = gst_caps_new_simple(
+        "video/x-h265",
+        "stream-format", G_TYPE_STRING, "byte-stream",
+        "alignment",    G_TYPE_STRING, "au",
+        "framerate",    GST_TYPE_FRACTION, TARGET_FPS, 1,
+        "width",        G_TYPE_INT, w,
+        "height",       G_TYPE_INT, h,
+        NULL);
+    gst_app_src_set_caps(GST_APP_SRC(appsrc), caps);
+    gst_caps_unref(caps);
+    std::cerr << "[feed] Caps from SPS: " << w << "x" << h << "\n";
 }
 
-std::string make_frame_filename(guint64 idx) {
-    char buf[256];
-    snprintf(buf, sizeof(buf),
-             "frame_%s_%09" G_GUINT64_FORMAT ".hevc", camera_prefix.c_str(), idx);
-    return std::string(buf);
+// au: the feed path's scan of this buffer, made before anything was prepended
+static void apply_au_info(GstBuffer *buffer, const AuInfo& au) {
+    if (!au.keyframe) {
+        GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+        return;
+    }
+    GST_BUFFER_FLAG_UNSET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    // Keyframes without in-band headers get the last set seen (shared memory, no payload copy)
+    if (!au.vps.size || !au.sps.size || !au.pps.size) param_sets.prepend(buffer);
 }
 
-bool is_file_ready(const fs::path& path, int max_attempts = 5, int delay_ms = 2) {
-    if (!fs::exists(path)) return false;
-    auto last_size = fs::file_size(path);
-    for (int i = 0; i < max_attempts; ++i) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
-        if (!fs::exists(path)) return false;
-        auto new_size = fs::file_size(path);
-        if (new_size == last_size) return true;
-        last_size = new_size;
-    }
-    return false;
+// ---------------------- Video probe (writes actual buffer PTS -> 90kHz and Redis fields) ----------------------
+// Remember the latest PTS of a stream and count any that fail to move forward
+static void note_pts(GstClockTime pts, std::atomic<guint64>& last, std::atomic<guint64>& regressions)
+{
+    guint64 prev = last.exchange(pts, std::memory_order_relaxed);
+    if (prev && pts <= prev) metric_inc(regressions);
 }
 
-static constexpr std::size_t IFRAME_MIN_SIZE = 30 * 1024; // 30 KB
-
-bool is_iframe(const fs::path& path) {
-    try {
-        if (!fs::exists(path)) return false;
-        return fs::file_size(path) >= IFRAME_MIN_SIZE;
-    } catch (...) {
-        return false;
-    }
+// --shm-out: one copy of the parsed AU straight into the next ring slot (never waits)
+static void publish_video_au(GstBuffer *buffer, guint64 index, std::string_view meta)
+{
+    gsize size = gst_buffer_get_size(buffer);
+    guint8* dst = video_ring.reserve(size);
+    if (!dst) return;
+    // Copies memory by memory, so a prepended parameter-set block needs no merge
+    gst_buffer_extract(buffer, 0, dst, size);
+    VideoRingAu au;
+    au.index = index;
+    au.pts_ns = GST_BUFFER_PTS(buffer) != GST_CLOCK_TIME_NONE ? static_cast<int64_t>(GST_BUFFER_PTS(buffer)) : -1;
+    au.dts_ns = GST_BUFFER_DTS(buffer) != GST_CLOCK_TIME_NONE ? static_cast<int64_t>(GST_BUFFER_DTS(buffer)) : -1;
+    au.duration_ns = GST_BUFFER_DURATION(buffer) != GST_CLOCK_TIME_NONE ? static_cast<int64_t>(GST_BUFFER_DURATION(buffer)) : -1;
+    if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) au.flags |= VIDEO_AU_DELTA;
+    au.size = size;
+    video_ring.commit(au, meta);
 }
 
-// ---------------------- Video probe (writes actual buffer PTS -> 90kHz and Redis fields) ----------------------
-static GstPadProbeReturn video_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
+static void log_video_buffer(GstBuffer *buffer, ProbeData* pdata)
 {
-    // user_data is a ProbeData*
-    ProbeData* pdata = static_cast<ProbeData*>(user_data);
+    // Reused every frame: after warm-up none of these allocate
     static std::string prev_ball = "0", prev_over = "0", prev_innings = "0";
-
-    if (!(info->type & GST_PAD_PROBE_TYPE_BUFFER)) {
-        return GST_PAD_PROBE_OK;
-    }
-
-    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
-    if (!buffer) return GST_PAD_PROBE_OK;
+    static FramePathTemplate names("", camera_prefix);
+    static FrameMetadata md;
+    static std::string md_json;
+    static thread_local guint64 allocs_base = 0;
 
     // Get PTS
     GstClockTime pts = GST_BUFFER_PTS(buffer);
 
-    // Read offset (we set it in feed_frames to the file index)
-    std::string fname = make_frame_filename(frame_counter);
-    std::string redis_key = fname.substr(0, fname.find_last_of('.'));
+    // Frame identity travels with the buffer (h265parse rewrites GST_BUFFER_OFFSET);
+    // fall back to the push counter for buffers without a FrameMeta
+    const FrameMeta* fmeta = frame_meta_get(buffer);
+    guint64 seq = fmeta ? fmeta->seq : frame_counter;
+    trace_mark(seq, STAGE_PARSED);
+    names.at(fmeta ? fmeta->file_index : frame_counter);
+    std::string_view fname = names.name();
+    std::string_view redis_key = names.key();
+    const guint32* frame_crc = FRAME_CRC && fmeta ? &fmeta->crc : nullptr;
 
     // Prepare CSV fields with defaults
-    std::string ball = "1", frame_name = "NA", innings = "1", isStart = "false", matchID = "123", over = "1", ptp_timestamp = "NA", received_at = "NA";
+    md.reset();
+    md_json.clear();
 
     // If we have a redisContext, try GET
     if (pdata && pdata->redis) {
-        redisReply* reply = (redisReply*)redisCommand(pdata->redis, "GET %s", redis_key.c_str());
+        gint64 t0 = trace_now_ns();
+        redisReply* reply = (redisReply*)redisCommand(pdata->redis, "GET %b", redis_key.data(), redis_key.size());
+        metrics.redis_latency.observe_ns(trace_now_ns() - t0);
+        if (!reply || reply->type == REDIS_REPLY_ERROR) metric_inc(metrics.redis_errors);
+        else if (reply->type == REDIS_REPLY_STRING) metric_inc(metrics.redis_hits);
+        else metric_inc(metrics.redis_misses);
         if (reply && reply->type == REDIS_REPLY_STRING) {
-            std::string json = reply->str;
-            auto extract = [&](const std::string& key) -> std::string {
-                size_t pos = json.find("\"" + key + "\":");
-                if (pos == std::string::npos) return "NA";
-                pos += key.size() + 3; // move past "key":
-                if (pos >= json.size()) return "NA";
-                // detect value type
-                if (json[pos] == '"') {
-                    size_t end = json.find('"', pos + 1);
-                    if (end == std::string::npos) return "NA";
-                    return json.substr(pos + 1, end - pos - 1);
-                } else {
-                    size_t end = json.find_first_of(",}", pos);
-                    if (end == std::string::npos) return json.substr(pos);
-                    return json.substr(pos, end - pos);
-                }
-            };
-
-            ball          = extract("ball");
-            innings       = extract("innings");
-            isStart       = extract("isStart");
-            matchID       = extract("matchID");
-            over          = extract("over");
-            frame_name    = extract("frame_name");
-            ptp_timestamp = extract("ptp_timestamp");
-            received_at   = extract("received_at");
+            parse_frame_metadata(std::string_view(reply->str, reply->len), md);
+            if (video_ring.is_open()) md_json.assign(reply->str, reply->len);
         }
         if (reply) freeReplyObject(reply);
     }
 
+    // The writer's size / CRC32C, when it records them, against what was loaded: a
+    // frame read while still being written is shorter or differs
+    if (fmeta && fmeta->size) {
+        bool short_read = md.size != "NA" && std::strtoull(md.size.c_str(), nullptr, 10) != fmeta->size;
+        bool crc_differs = frame_crc && md.crc32c != "NA" && std::strtoul(md.crc32c.c_str(), nullptr, 16) != fmeta->crc;
+        if (short_read || crc_differs) {
+            metric_inc(metrics.corrupt_frames);
+            std::cerr << "[probe] Warning: " << fname << " loaded as " << fmeta->size << " bytes";
+            if (short_read) std::cerr << ", metadata says " << md.size;
+            if (crc_differs) std::cerr << ", crc32c differs from metadata " << md.crc32c;
+            std::cerr << "\n";
+        }
+    }
+
     // Convert PTS (ns) to 90kHz ticks
     if (pts != GST_CLOCK_TIME_NONE) {
+        note_pts(pts, metrics.last_video_pts, metrics.video_pts_regressions);
         guint64 pts_90k = gst_util_uint64_scale(pts, 90000, GST_SECOND);
 
         // Write one line to the main CSV
         if (pdata && pdata->csv && pdata->csv->is_open()) {
-            *(pdata->csv) << frame_counter << "," << pts_90k << "," << fname << ","
-                          << ball << "," << frame_name << "," << innings << "," << isStart << ","
-                          << matchID << "," << over << "," << ptp_timestamp << "," << received_at << "\n";
+            write_video_csv_row(*(pdata->csv), seq, true, pts_90k, fname, md, frame_crc);
             pdata->csv->flush();
         }
 
         // Write summary when values change
         if (pdata && pdata->csv_summary && pdata->csv_summary->is_open()) {
-            if (ball != prev_ball || over != prev_over || innings != prev_innings) {
-                *(pdata->csv_summary) << frame_counter << "," << pts_90k << "," << over << "," << ball << "," << innings << "," << matchID << "\n";
+            if (md.ball != prev_ball || md.over != prev_over || md.innings != prev_innings) {
+                write_summary_csv_row(*(pdata->csv_summary), seq, pts_90k, md);
                 pdata->csv_summary->flush();
             }
         }
@@ -174,19 +259,47 @@ static GstPadProbeReturn video_probe(GstPad *pad, GstPadProbeInfo *info, gpointe
     } else {
         // No PTS, still write NA entry for PTS
         if (pdata && pdata->csv && pdata->csv->is_open()) {
-            *(pdata->csv) << frame_counter << ",NA," << fname << ","
-                          << ball << "," << frame_name << "," << innings << "," << isStart << ","
-                          << matchID << "," << over << "," << ptp_timestamp << "," << received_at << "\n";
+            write_video_csv_row(*(pdata->csv), seq, false, 0, fname, md, frame_crc);
             pdata->csv->flush();
         }
         // std::cout << "[VIDEO] FrameIndex: " << frame_counter << " PTS: NONE File: " << fname << std::endl;
     }
 
+    if (video_ring.is_open()) publish_video_au(buffer, fmeta ? fmeta->file_index : frame_counter, md_json);
+
+    // Ball changes get a thumbnail at the next keyframe
+    thumbnailer.offer(buffer, fmeta ? fmeta->file_index : frame_counter, md.ball != prev_ball);
+    verifier.offer(buffer, fmeta ? fmeta->file_index : frame_counter, md.isStart == "true" || md.ball != prev_ball);
+
     // update previous-tracked values for summary
-    prev_ball = ball;
-    prev_over = over;
-    prev_innings = innings;
+    prev_ball = md.ball;
+    prev_over = md.over;
+    prev_innings = md.innings;
+
+    if (seq == ALLOC_WARMUP_FRAMES) allocs_base = thread_alloc_count();
+    else if (seq > ALLOC_WARMUP_FRAMES) metrics.probe_allocs.store(thread_alloc_count() - allocs_base, std::memory_order_relaxed);
+}
+
+static gboolean log_video_list_item(GstBuffer **buffer, guint idx, gpointer user_data)
+{
+    (void)idx;
+    log_video_buffer(*buffer, static_cast<ProbeData*>(user_data));
+    return TRUE;
+}
 
+static GstPadProbeReturn video_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
+{
+    // user_data is a ProbeData*
+    ProbeData* pdata = static_cast<ProbeData*>(user_data);
+
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        if (buffer) log_video_buffer(buffer, pdata);
+    } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        // Without h265parse, batched pushes reach the probe as lists
+        GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        if (list) gst_buffer_list_foreach(list, log_video_list_item, pdata);
+    }
     return GST_PAD_PROBE_OK;
 }
 
@@ -198,14 +311,16 @@ static GstPadProbeReturn audio_probe(GstPad *pad, GstPadProbeInfo *info, gpointe
         GstClockTime pts = GST_BUFFER_PTS(buffer);
 
         if (pts != GST_CLOCK_TIME_NONE) {
+            note_pts(pts, metrics.last_audio_pts, metrics.audio_pts_regressions);
             guint64 pts_90k = gst_util_uint64_scale(pts, 90000, GST_SECOND); // Convert ns → 90kHz
             std::ofstream* csv_audio = static_cast<std::ofstream*>(user_data);
 
             // Log to CSV
-            *csv_audio << audio_frame_counter<< ","<< pts_90k << "\n";
+            write_audio_csv_row(*csv_audio, audio_frame_counter, pts_90k);
             csv_audio->flush();
 
             audio_frame_counter++;
+            metric_inc(metrics.audio_packets);
 
             // Log to console
             // std::cout << "[AUDIO] Real PTS: " << pts_90k << std::endl;
@@ -214,6 +329,54 @@ static GstPadProbeReturn audio_probe(GstPad *pad, GstPadProbeInfo *info, gpointe
     return GST_PAD_PROBE_OK;
 }
 
+static gboolean trace_dump_timeout(gpointer data) {
+    (void)data;
+    trace_dump(std::cerr);
+    return TRUE;   // keep dumping every interval
+}
+
+static GstPadProbeReturn bytes_written_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    (void)pad; (void)user_data;
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        metric_inc(metrics.bytes_written, gst_buffer_get_size(GST_PAD_PROBE_INFO_BUFFER(info)));
+    } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        metric_inc(metrics.bytes_written, gst_buffer_list_calculate_size(GST_PAD_PROBE_INFO_BUFFER_LIST(info)));
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+// One-shot on filesink: the first TS bytes reach the file, which completes the startup breakdown
+static GstPadProbeReturn first_byte_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    (void)pad; (void)info; (void)user_data;
+    startup_mark(STARTUP_FIRST_BYTE);
+    startup_report(std::cout);
+    if (startup_ms(STARTUP_FIRST_BYTE) > STARTUP_TARGET_MS) {
+        std::cerr << "[startup] First frame on disk missed the " << STARTUP_TARGET_MS << " ms target\n";
+    }
+    return GST_PAD_PROBE_REMOVE;
+}
+
+// Blocks a-queue2 until live audio has its first buffer, then links it into the running
+// mux. The pad re-sends its sticky events (stream-start, caps, segment) to the new mux
+// pad after a blocking probe, so the buffer follows them in order.
+static GstPadProbeReturn audio_join_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    (void)info;
+    GstElement *queue = gst_pad_get_parent_element(pad);
+    bool linked = queue && gst_element_link(queue, GST_ELEMENT(user_data));
+    if (queue) gst_object_unref(queue);
+    startup_mark(STARTUP_AUDIO);
+    if (linked) {
+        double video_ms = startup_ms(STARTUP_FIRST_PUSH);
+        std::cout << "[startup] Audio joined the mux at " << static_cast<gint64>(startup_ms(STARTUP_AUDIO)) << " ms";
+        if (video_ms >= 0) std::cout << ", " << static_cast<gint64>(startup_ms(STARTUP_AUDIO) - video_ms) << " ms after the first frame";
+        std::cout << "\n";
+    } else {
+        // The buffer goes on to an unlinked pad; the audio branch errors out as with any other failure
+        std::cerr << "[error] Cannot link the audio branch into the mux\n";
+    }
+    return GST_PAD_PROBE_REMOVE;
+}
+
 static gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
     GMainLoop *loop = (GMainLoop *)data;
     switch (GST_MESSAGE_TYPE(msg)) {
@@ -225,6 +388,7 @@ static gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
         if (dbg) g_printerr("Debug details: %s\n", dbg);
         g_error_free(err);
         g_free(dbg);
+        if (supervisor.on_error(msg)) break;
         g_main_loop_quit(loop);
         break;
     }
@@ -238,10 +402,67 @@ static gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
     return TRUE;
 }
 
+// Running time of the pipeline clock, i.e. what do-timestamp would stamp right now
+static GstClockTime running_time_now(GstElement *element) {
+    GstClock *clk = gst_element_get_clock(element);
+    if (!clk) return GST_CLOCK_TIME_NONE;
+    GstClockTime now = gst_clock_get_time(clk);
+    gst_object_unref(clk);
+    GstClockTime base = gst_element_get_base_time(element);
+    return now > base ? now - base : 0;
+}
+
+// Push the pending batch (if any) in one call. Returns false on a flow error.
+static bool flush_batch(GstElement *appsrc, GstBufferList *&batch) {
+    if (!batch) return true;
+    guint n = gst_buffer_list_length(batch);
+    supervisor.wait_ready();
+    guint64 generation = supervisor.generation();
+    // push_buffer_list takes ownership of the list
+    GstFlowReturn ret = gst_app_src_push_buffer_list(GST_APP_SRC(appsrc), batch);
+    batch = nullptr;
+    metric_inc(metrics.push_calls);
+    metric_inc(metrics.frames_pushed, n);
+    startup_mark(STARTUP_FIRST_PUSH);
+    gint64 now_ns = trace_now_ns();
+    for (guint64 seq = frame_counter - n; seq < frame_counter; ++seq) trace_mark(seq, STAGE_PUSHED, now_ns);
+    if (ret != GST_FLOW_OK) {
+        std::cerr << "[feed] appsrc_push_buffer_list returned " << ret << "\n";
+        if (supervisor.recover_push(generation, ret)) {
+            std::cerr << "[feed] " << n << " frames up to frame " << frame_counter - 1 << " lost in the restart\n";
+            return true;
+        }
+        return false;
+    }
+    std::cerr << "[feed] Pushed batch of " << n << " frames (up to frame " << frame_counter - 1 << ")\n";
+    return true;
+}
+
+// GDestroyNotify of a buffer wrapping an arena chunk
+static void release_arena_chunk(gpointer chunk) {
+    frame_arena.release(static_cast<uint8_t*>(chunk));
+}
+
+// Frames are read into buffers from this pool; it grows to however many are in flight
+// (queue1 + mux) during warm-up and then recycles them
+static GstBufferPool* make_frame_pool() {
+    GstBufferPool *pool = gst_buffer_pool_new();
+    GstStructure *config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, NULL, FRAME_POOL_BUFFER_SIZE, FRAME_POOL_MIN_BUFFERS, 0);
+    if (!gst_buffer_pool_set_config(pool, config) || !gst_buffer_pool_set_active(pool, TRUE)) {
+        std::cerr << "[feed] Buffer pool unavailable, allocating per frame\n";
+        gst_object_unref(pool);
+        return nullptr;
+    }
+    return pool;
+}
+
 void feed_frames(GstElement *appsrc, redisContext* context){
-    using clock = std::chrono::steady_clock;
-    auto start_time = clock::now();
-    auto frame_duration = std::chrono::microseconds(static_cast<int>(FrameIntervalMs * 1000));
+    // Pacing runs on the (possibly virtual) process pace clock
+    FramePacer pacer(pace_source(), TARGET_FPS);
+    const guint64 sim_total_frames = static_cast<guint64>(SIM_HOURS * 3600.0 * TARGET_FPS);
+    // The side decoders need the parameter sets even when nothing else scans the frames
+    const bool learn_param_sets = thumbnailer.running() || verifier.running();
     // custom PTS removed — we rely on actual buffer PTS as set below
     static const std::vector<guint64> increments =
         (TARGET_FPS == 150) ? std::vector<guint64>{599, 600, 601}
@@ -249,150 +470,690 @@ void feed_frames(GstElement *appsrc, redisContext* context){
 
     std::string prev_ball="0", prev_over="0", prev_innings="0";
 
+    // Frames loaded while catching up (or in offline mode), pushed together
+    GstBufferList *batch = nullptr;
+
+    // Per-frame state that is reused instead of reallocated
+    FramePathTemplate frame_paths(FRAME_FOLDER, camera_prefix);
+    GstBufferPool *pool = make_frame_pool();
+    guint64 allocs_base = 0;
+
+    // When we started waiting for the current index (only with --skip-missing-ms)
+    guint64 waiting_index = G_MAXUINT64;
+    auto wait_start = pace_now();
+    // Ring / network input: whether current_index has been taken from the producer yet
+    bool ring_started = false, net_started = false;
+    uint64_t net_generation = 0;
+    const guint net_skip_ms = SKIP_MISSING_MS ? SKIP_MISSING_MS : NET_REORDER_MS;
+    // --crc: CRC32C of the last frames pushed (~1 s at 300 fps)
+    RecentPayloads recent_payloads(FRAME_CRC ? 256 : 0);
+    // Stream analytics see each index once, however often its read is retried
+    guint64 stats_index = G_MAXUINT64;
+    auto observe_frame = [&](uint64_t size, bool key, int64_t arrival_ns) {
+        if (current_index == stats_index) return;
+        stats_index = current_index;
+        frame_stats.observe(current_index, size, key, arrival_ns);
+    };
+
     while (true) {
-        // Calculate the expected time for the current frame
-        auto expected_time = start_time + frame_counter * frame_duration;
-        auto now = clock::now();
+        // Everything below current_index has been pushed or skipped
+        if (CLEANUP) frame_cleaner.consumed_below(current_index);
+
+        if (SIM_HOURS > 0 && frame_counter >= sim_total_frames) {
+            if (!flush_batch(appsrc, batch)) break;
+            std::cerr << "[sim] " << SIM_HOURS << " simulated hours done. Sending EOS.\n";
+            gst_app_src_end_of_stream(GST_APP_SRC(appsrc));
+            break;
+        }
 
-        // Sleep until the expected time for the next frame
-        if (now < expected_time) {
-            std::this_thread::sleep_until(expected_time);
+        // Where the current frame stands against its slot
+        PaceSlot slot = pacer.slot(frame_counter);
+        bool catching_up = OFFLINE_MODE || slot.catching_up;
+        gint64 lateness_ns = OFFLINE_MODE ? 0 : slot.lateness_ns;
+
+        if (OFFLINE_MODE) {
+            // No pacing: read as fast as the disk and the pipeline allow
+        } else if (slot.early) {
+            // Never hold loaded frames while sleeping
+            if (!flush_batch(appsrc, batch)) break;
+            // Sleep until the expected time for the next frame
+            pacer.wait(slot);
         } else {
             // Log if we're significantly behind schedule
-            auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - expected_time).count();
+            auto delta = slot.lateness_ns / 1000000;
             if (delta > FrameIntervalMs) {
+                metric_inc(metrics.behind_schedule);
                 std::cerr << "[feed] Warning: Behind schedule by " << delta << " ms at frame " << frame_counter << "\n";
             }
         }
 
-        // Construct the frame filename (use current_index)
-        std::string fname = make_frame_filename(current_index);
-        fs::path fullpath = fs::path(FRAME_FOLDER) / fname;
+        if (frame_counter == ALLOC_WARMUP_FRAMES && !allocs_base) allocs_base = thread_alloc_count();
+        else if (frame_counter > ALLOC_WARMUP_FRAMES) metrics.feeder_allocs.store(thread_alloc_count() - allocs_base, std::memory_order_relaxed);
+
+        GstBuffer *buffer = nullptr;
+        std::string_view fname;
+        if (frame_ring.is_open()) {
+            // Next frame the receiver published; the slot itself becomes the buffer
+            FrameRingFrame rf;
+            if (!frame_ring.acquire(rf, 100)) {
+                if (!flush_batch(appsrc, batch)) break;
+                if (frame_ring.replaced()) {
+                    // The producer restarted under the same name; our buffers keep the old mapping
+                    if (frame_ring.open(SHM_RING)) {
+                        std::cerr << "[shm] Ring " << SHM_RING << " was recreated by its producer; re-opened\n";
+                    } else {
+                        std::cerr << "[shm] Ring " << SHM_RING << " was recreated but cannot be opened; stopping\n";
+                        break;
+                    }
+                    continue;
+                }
+                metric_inc(metrics.missing_waits);
+                std::cerr << "[feed] Shared-memory ring " << SHM_RING << " empty. Waiting...\n";
+                continue;
+            }
+            // The receiver's index is authoritative; a jump means frames it never delivered
+            if (ring_started && rf.index > current_index) {
+                metric_inc(metrics.skipped_missing, rf.index - current_index);
+                std::cerr << "[feed] SKIP " << rf.index - current_index << " frames missing from the ring before "
+                          << rf.index << "\n";
+            }
+            ring_started = true;
+            current_index = rf.index;
+            frame_paths.at(current_index);
+            fname = frame_paths.name();
+            trace_mark(frame_counter, STAGE_APPEAR, rf.publish_ns);
+            trace_mark(frame_counter, STAGE_READY);
+            observe_frame(rf.size, !(rf.flags & FRAME_FLAG_DELTA) && rf.size >= IFRAME_MIN_SIZE, rf.publish_ns);
+
+            if ((rf.flags & FRAME_FLAG_DELTA) || rf.size < IFRAME_MIN_SIZE) {
+                frame_ring.release(rf.slot);
+                metric_inc(metrics.skipped_pb);
+                std::cerr << "[feed] SKIP P/B-frame: " << fname << " (" << rf.size/1024 << " KB)\n";
+                current_index++;
+                continue;
+            }
+            // The buffer owns the frame's hold on the ring, however late it is freed
+            buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, rf.data, rf.size, 0, rf.size,
+                                                 rf.ref, FrameRing::release_ref);
+            trace_mark(frame_counter, STAGE_READ);
+        } else if (frame_receiver.running()) {
+            // Frames in index order from the receiver's reorder window
+            if (!net_started) {
+                uint64_t first = 0;
+                net_generation = frame_receiver.generation();
+                if (!frame_receiver.next_ready(0, first, 100)) {
+                    if (!flush_batch(appsrc, batch)) break;
+                    metric_inc(metrics.missing_waits);
+                    std::cerr << "[feed] No frames received on " << LISTEN_ADDR << " yet. Waiting...\n";
+                    continue;
+                }
+                current_index = first;
+                net_started = true;
+            }
+            NetFrame nf;
+            if (!frame_receiver.take(current_index, nf, 20)) {
+                if (!flush_batch(appsrc, batch)) break;
+                if (frame_receiver.generation() != net_generation) {
+                    // The sender restarted at other indices; its index is authoritative
+                    std::cerr << "[feed] Sender moved away from frame " << current_index
+                              << "; continuing from its first frame\n";
+                    net_started = false;
+                    continue;
+                }
+                // Later frames are already here: the missing one is lost or very late
+                auto t = pace_now();
+                if (waiting_index != current_index) {
+                    waiting_index = current_index;
+                    wait_start = t;
+                }
+                uint64_t next = 0;
+                if (t - wait_start >= std::chrono::milliseconds(net_skip_ms) &&
+                    frame_receiver.next_ready(current_index + 1, next, 0)) {
+                    metric_inc(metrics.skipped_missing, next - current_index);
+                    std::cerr << "[feed] SKIP " << next - current_index << " frames not received before "
+                              << next << " after " << net_skip_ms << " ms\n";
+                    current_index = next;
+                    continue;
+                }
+                metric_inc(metrics.missing_waits);
+                continue;
+            }
+            frame_paths.at(current_index);
+            fname = frame_paths.name();
+            trace_mark(frame_counter, STAGE_APPEAR, nf.arrival_ns);
+            trace_mark(frame_counter, STAGE_READY);
+            observe_frame(nf.size, !(nf.flags & FRAME_FLAG_DELTA) && nf.size >= IFRAME_MIN_SIZE, nf.arrival_ns);
+
+            if ((nf.flags & FRAME_FLAG_DELTA) || nf.size < IFRAME_MIN_SIZE) {
+                free(nf.data);
+                metric_inc(metrics.skipped_pb);
+                std::cerr << "[feed] SKIP P/B-frame: " << fname << " (" << nf.size/1024 << " KB)\n";
+                current_index++;
+                continue;
+            }
+            // The block the payload was received into becomes the buffer's memory
+            buffer = gst_buffer_new_wrapped_full(static_cast<GstMemoryFlags>(0), nf.data, nf.size, 0, nf.size,
+                                                 nf.data, free);
+            trace_mark(frame_counter, STAGE_READ);
+        } else {
+            // Construct the frame filename (use current_index); rewritten in place
+            const std::string& real_path = frame_paths.at(current_index);
+            fname = frame_paths.name();
+            const char* fullpath = SIM_HOURS > 0 ? sim_frames[current_index % sim_frames.size()].c_str()
+                                                 : real_path.c_str();
+
+            // Check if file is ready (simulated runs cycle a static folder)
+            if (SIM_HOURS == 0 && !is_file_ready(fullpath)) {
+                if (!flush_batch(appsrc, batch)) break;
+                if (OFFLINE_MODE) {
+                    // Recorded folder is exhausted: finish the file cleanly
+                    std::cerr << "[feed] No more frames at " << fullpath << ". Sending EOS.\n";
+                    gst_app_src_end_of_stream(GST_APP_SRC(appsrc));
+                    break;
+                }
+                if (SKIP_MISSING_MS) {
+                    auto t = pace_now();
+                    if (waiting_index != current_index) {
+                        waiting_index = current_index;
+                        wait_start = t;
+                    } else if (t - wait_start >= std::chrono::milliseconds(SKIP_MISSING_MS)) {
+                        metric_inc(metrics.skipped_missing);
+                        std::cerr << "[feed] SKIP missing frame: " << fname << " after " << SKIP_MISSING_MS << " ms\n";
+                        current_index++;
+                        continue;
+                    }
+                }
+                metric_inc(metrics.missing_waits);
+                std::cerr << "[feed] File not found or not ready: " << fullpath << ". Waiting...\n";
+                // Short wait before retry
+                pace_sleep_for(std::chrono::milliseconds(SKIP_MISSING_MS ? std::min(SKIP_MISSING_MS, 100u) : 100u));
+                continue; // Retry the same frame
+            }
 
-        // Check if file is ready
-        if (!is_file_ready(fullpath)) {
-            std::cerr << "[feed] File not found or not ready: " << fullpath << ". Waiting...\n";
-            std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Short wait before retry
-            continue; // Retry the same frame
-        }
+            if (trace_enabled()) {
+                // Arrival = when the receiver last wrote the file (no fs event source on the RAMdisk)
+                std::error_code ec;
+                auto mtime = fs::last_write_time(fs::path(fullpath), ec);   // allocates; tracing only
+                gint64 now_ns = trace_now_ns();
+                gint64 age_ns = ec ? 0 : std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             fs::file_time_type::clock::now() - mtime).count();
+                trace_mark(frame_counter, STAGE_APPEAR, now_ns - std::max<gint64>(age_ns, 0));
+                trace_mark(frame_counter, STAGE_READY, now_ns);
+            }
 
-        // === SKIP NON-I-FRAMES ===
-        if (!is_iframe(fullpath)) {
-            std::cerr << "[feed] SKIP P/B-frame: " << fname
-                      << " (" << fs::file_size(fullpath)/1024 << " KB)\n";
-            current_index++;
-            continue;
+            // === SKIP NON-I-FRAMES ===
+            // One stat for the size heuristic and the analytics; the files of a recorded or
+            // cycled folder say nothing about when frames arrived
+            uint64_t file_size = 0;
+            int64_t mtime_ns = -1;
+            if (file_size_of(fullpath, file_size, mtime_ns)) {
+                observe_frame(file_size, file_size >= IFRAME_MIN_SIZE, OFFLINE_MODE || SIM_HOURS > 0 ? -1 : mtime_ns);
+            }
+            if (file_size < IFRAME_MIN_SIZE) {
+                metric_inc(metrics.skipped_pb);
+                std::cerr << "[feed] SKIP P/B-frame: " << fname
+                          << " (" << file_size/1024 << " KB)\n";
+                current_index++;
+                continue;
+            }
+            // === END SKIP ===
+
+            // Read straight into a pooled GstBuffer (no intermediate vector, no copy);
+            // frames bigger than the pool buffers get a buffer of their own.
+            // With --huge-pages the arena comes first and the pool covers its overflow.
+            gint64 read_start = trace_now_ns();
+            if (uint8_t* chunk = frame_arena.acquire()) {
+                buffer = gst_buffer_new_wrapped_full(static_cast<GstMemoryFlags>(0), chunk, frame_arena.chunk_size(), 0,
+                                                     frame_arena.chunk_size(), chunk, release_arena_chunk);
+            } else if (HUGE_PAGES_MB) {
+                metric_inc(metrics.arena_exhausted);
+            }
+            if (!buffer && pool && gst_buffer_pool_acquire_buffer(pool, &buffer, NULL) != GST_FLOW_OK) buffer = nullptr;
+            if (!buffer) buffer = gst_buffer_new_allocate(NULL, FRAME_POOL_BUFFER_SIZE, NULL);
+            GstMapInfo map;
+            if (!gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+                std::cerr << "[feed] Buffer map failed\n";
+                gst_buffer_unref(buffer);
+                break; // Exit on critical error
+            }
+            gsize size = 0;
+            FrameReadStatus rs = read_frame_into(fullpath, map.data, map.size, size);
+            gst_buffer_unmap(buffer, &map);
+            if (rs == FRAME_TOO_LARGE) {
+                gst_buffer_unref(buffer);
+                buffer = gst_buffer_new_allocate(NULL, size, NULL);
+                if (gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+                    rs = read_frame_into(fullpath, map.data, map.size, size);
+                    gst_buffer_unmap(buffer, &map);
+                } else {
+                    rs = FRAME_READ_FAILED;
+                }
+            }
+            if (rs != FRAME_READ_OK) {
+                gst_buffer_unref(buffer);
+                std::cerr << "[feed] Failed " << (rs == FRAME_OPEN_FAILED ? "to open " : "reading ") << fullpath << ". Retrying...\n";
+                pace_sleep_for(std::chrono::milliseconds(100));
+                continue; // Retry the same frame
+            }
+            gst_buffer_set_size(buffer, size);
+            metrics.read_latency.observe_ns(trace_now_ns() - read_start);
+            trace_mark(frame_counter, STAGE_READ);
         }
-        // === END SKIP ===
 
-        std::ifstream ifs(fullpath, std::ios::binary | std::ios::ate);
-        if (!ifs) {
-            std::cerr << "[feed] Failed to open " << fullpath << ". Retrying...\n";
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue; // Retry the same frame
-        }
-        std::streamsize size = ifs.tellg();
-        ifs.seekg(0, std::ios::beg);
-        std::vector<uint8_t> bufferdata(size);
-        if (!ifs.read(reinterpret_cast<char*>(bufferdata.data()), size)) {
-            std::cerr << "[feed] Failed reading " << fullpath << ". Retrying...\n";
-            ifs.close();
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue; // Retry the same frame
-        }
-        ifs.close();
-
-        // Create and fill GStreamer buffer
-        GstBuffer *buffer = gst_buffer_new_allocate(NULL, size, NULL);
-        GstMapInfo map;
-        if (!gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
-            std::cerr << "[feed] Buffer map failed\n";
-            gst_buffer_unref(buffer);
-            break; // Exit on critical error
+        // One NAL header scan per frame, shared by the checks below, --no-parse and the
+        // parameter-set cache. Hashed while the payload is still in cache from the read,
+        // before any parameter sets are prepended. A simulated run cycles its folder, so
+        // repeats are expected there.
+        guint32 payload_crc = 0;
+        const gsize payload_size = gst_buffer_get_size(buffer);
+        AuInfo au;
+        bool scanned = false;
+        if (FRAME_CRC || BYPASS_PARSE || learn_param_sets) {
+            GstMapInfo cmap;
+            if (gst_buffer_map(buffer, &cmap, GST_MAP_READ)) {
+                au = scan_hevc_au(cmap.data, cmap.size);
+                scanned = true;
+                if (au.keyframe && param_sets.learn(cmap.data, au) && BYPASS_PARSE) update_caps(appsrc, cmap.data, au);
+                AuTail tail = AU_TAIL_OK;
+                guint64 first_index = 0;
+                bool duplicate = false;
+                if (FRAME_CRC) {
+                    payload_crc = crc32c(cmap.data, cmap.size);
+                    tail = hevc_au_tail(cmap.data, cmap.size);
+                    duplicate = SIM_HOURS == 0 && recent_payloads.seen(payload_crc, cmap.size, current_index, first_index);
+                }
+                gst_buffer_unmap(buffer, &cmap);
+                bool has_slice = !FRAME_CRC || au.found_vcl;
+                if (!has_slice || tail != AU_TAIL_OK) {
+                    metric_inc(metrics.corrupt_frames);
+                    std::cerr << "[feed] Warning: " << fname << " (" << payload_size << " bytes) "
+                              << (!has_slice ? "has no slice data"
+                                  : tail == AU_TAIL_ZERO_FILLED ? "ends in zero bytes (not fully written?)"
+                                                                : "ends inside a NAL header (cut short?)") << "\n";
+                }
+                if (duplicate) {
+                    metric_inc(metrics.duplicate_frames);
+                    std::cerr << "[feed] " << (DROP_DUPLICATES ? "SKIP duplicate: " : "Warning: duplicate ") << fname
+                              << " repeats frame " << first_index << " (crc32c " << std::hex << payload_crc << std::dec << ")\n";
+                    if (DROP_DUPLICATES) {
+                        gst_buffer_unref(buffer);
+                        current_index++;
+                        continue;
+                    }
+                }
+            }
         }
-        memcpy(map.data, bufferdata.data(), size);
-        gst_buffer_unmap(buffer, &map);
 
-        // Set buffer timestamps (use clock-based PTS derived from frame_counter)
-        // GstClockTime pts = gst_util_uint64_scale(frame_counter, GST_SECOND, TARGET_FPS);
-        // GST_BUFFER_PTS(buffer) = pts;
-        // GST_BUFFER_DTS(buffer) = pts;
-        // GST_BUFFER_DURATION(buffer) = gst_util_uint64_scale(1, GST_SECOND, TARGET_FPS);
+        if (BYPASS_PARSE && scanned) apply_au_info(buffer, au);
+
+        // Set buffer timestamps. Live single pushes are stamped by appsrc (do-timestamp),
+        // but do-timestamp only stamps the first buffer of a list, so batched frames are
+        // stamped here with the same running time appsrc would have used.
+        if (OFFLINE_MODE) {
+            GstClockTime pts = gst_util_uint64_scale(frame_counter, GST_SECOND, TARGET_FPS);
+            GST_BUFFER_PTS(buffer) = pts;
+            GST_BUFFER_DTS(buffer) = pts;
+            GST_BUFFER_DURATION(buffer) = gst_util_uint64_scale(1, GST_SECOND, TARGET_FPS);
+        } else if (SIM_HOURS > 0) {
+            // What do-timestamp would stamp, on the virtual clock
+            GstClockTime pts = pacer.elapsed_ns();
+            GST_BUFFER_PTS(buffer) = pts;
+            GST_BUFFER_DTS(buffer) = pts;
+        } else if (BATCH_MAX > 1 && (catching_up || batch)) {
+            GST_BUFFER_PTS(buffer) = running_time_now(appsrc);
+        }
 
         // Attach the file index to the buffer so the probe can reconstruct filename
         GST_BUFFER_OFFSET(buffer) = current_index;
+        frame_meta_attach(buffer, frame_counter, current_index, payload_crc, static_cast<guint32>(payload_size));
+
+        if (BATCH_MAX > 1 && (catching_up || batch)) {
+            // Queue into the batch; push once it is full or we are back on schedule
+            if (!batch) batch = gst_buffer_list_new_sized(BATCH_MAX);
+            gst_buffer_list_add(batch, buffer);
+            metrics.push_lateness.observe_ns(lateness_ns);
+            frame_counter++;
+            current_index++;
+            if (gst_buffer_list_length(batch) >= BATCH_MAX || !catching_up) {
+                if (!flush_batch(appsrc, batch)) break;
+            }
+        } else {
+            // Push buffer to appsrc
+            supervisor.wait_ready();
+            guint64 generation = supervisor.generation();
+            GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(appsrc), buffer);
+            metric_inc(metrics.push_calls);
+            trace_mark(frame_counter, STAGE_PUSHED);
+            if (ret != GST_FLOW_OK) {
+                // push_buffer takes ownership of the buffer even on failure
+                std::cerr << "[feed] appsrc_push_buffer returned " << ret << "\n";
+                if (supervisor.recover_push(generation, ret)) {
+                    // Pipeline is back; this frame went down with it, carry on with the next
+                    std::cerr << "[feed] Frame " << frame_counter << " (" << fname << ") lost in the restart\n";
+                    current_index++;
+                    continue;
+                }
+                break; // Exit on critical error
+            }
 
-        // Push buffer to appsrc
-        GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(appsrc), buffer);
-        if (ret != GST_FLOW_OK) {
-            std::cerr << "[feed] appsrc_push_buffer returned " << ret << "\n";
-            gst_buffer_unref(buffer);
-            break; // Exit on critical error
-        }
+            std::cerr << "[feed] Pushed frame " << frame_counter << " (" << fname << ")\n";
 
-        std::cerr << "[feed] Pushed frame " << frame_counter << " (" << fname << ")\n";
+            // Increment counters AFTER setting offset and pushing
+            frame_counter++;
+            current_index++;
+            metric_inc(metrics.frames_pushed);
+            startup_mark(STARTUP_FIRST_PUSH);
+            metrics.push_lateness.observe_ns(lateness_ns);
+        }
 
-        // Increment counters AFTER setting offset and pushing
-        frame_counter++;
-        current_index++;
+        // RSS once per simulated minute; the first sample is the growth baseline
+        if (SIM_HOURS > 0 && frame_counter % (TARGET_FPS * 60) == 0) sim_sample_rss();
 
-        // Log FPS statistics
-        static auto last_log = clock::now();
+        // Log FPS statistics (wall clock, also under --sim-hours)
+        static auto last_log = std::chrono::steady_clock::now();
+        static guint64 last_push_calls = 0;
         if (frame_counter % TARGET_FPS == 0) {
-            auto now2 = clock::now();
+            auto now2 = std::chrono::steady_clock::now();
             auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now2 - last_log).count();
-            std::cerr << "[stats] Last " << TARGET_FPS << " frames in " << delta << " ms (FPS: " << (TARGET_FPS * 1000.0 / delta) << ")\n";
+            guint64 push_calls = metrics.push_calls.load(std::memory_order_relaxed);
+            guint64 calls = push_calls - last_push_calls;
+            std::cerr << "[stats] Last " << TARGET_FPS << " frames in " << delta << " ms (FPS: " << (TARGET_FPS * 1000.0 / delta)
+                      << ", frames/push: " << (calls ? static_cast<double>(TARGET_FPS) / calls : 0.0) << ")";
+            if (frame_stats.snapshot().seconds) {
+                std::cerr << " | ";
+                frame_stats.summary(std::cerr);
+            }
+            std::cerr << "\n";
             last_log = now2;
+            last_push_calls = push_calls;
         }
     }
+
+    // Drop anything still pending if we bailed out on an error
+    if (batch) gst_buffer_list_unref(batch);
+    if (pool) {
+        // Buffers still downstream return to the pool and are freed with it
+        gst_buffer_pool_set_active(pool, FALSE);
+        gst_object_unref(pool);
+    }
+}
+
+static void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+                  << " <start_index> <target_fps> <input_folder> <output_ts_file> <output_csv_file> <camera_id>"
+                  << " [--batch=N] [--offline] [--no-audio] [--skip-missing-ms=N] [--no-parse] [--trace] [--metrics=[HOST:]PORT]"
+                  << " [--redis=HOST[:PORT]|off] [--audio-url=URL] [--sim-hours=H] [--shm-ring=NAME]"
+                  << " [--listen=[HOST:]PORT | --listen-udp=[HOST:]PORT] [--cleanup[=KEEP]] [--huge-pages[=MB]]"
+                  << " [--numa-node=N|auto|IFACE]"
+                  << " [--thumbnails=DIR] [--thumb-every=N] [--thumb-width=W] [--thumb-workers=N] [--thumb-webp] [--crc[=drop]]"
+                  << " [--out=udp://HOST:PORT|rtp://HOST:PORT|srt://[HOST]:PORT ...] [--http=[HOST:]PORT]"
+                  << " [--shm-out=NAME] [--shm-out-slots=N] [--shm-out-slot-kb=KB]"
+                  << " [--self-heal[=STALL_MS]] [--heal-test=SECONDS] [--bitrate-alert=LOW,HIGH|off] [--jitter-alert-ms=MS]"
+                  << " [--verify[=N]] [--verify-budget=PCT] [--verify-core=N] [--fast-start]\n";
 }
 
 int main(int argc, char *argv[]) {
     // Check for proper usage
     if (argc < 7) {
-        std::cerr << "Usage: " << argv[0]
-                  << " <start_index> <target_fps> <input_folder> <output_ts_file> <output_csv_file> <camera_id>\n";
+        usage(argv[0]);
         return 1;
     }
-    // Connect to DragonflyDB (Redis-compatible)
-    redisContext* context = redisConnect("192.168.5.102", 6379);
-    if (context == nullptr || context->err) {
-        if (context) {
-            std::cerr << "Redis connection error: " << context->errstr << std::endl;
-            redisFree(context);
-        } else {
-            std::cerr << "Cannot allocate Redis context" << std::endl;
+    // Parse arguments; a number that does not parse (std::stoi and friends throw) names
+    // the argument and prints the usage instead of terminating on an uncaught exception
+    std::string output_ts_path = argv[4];     // e.g. E:\output.ts
+    std::string csv_filename = argv[5];       // e.g. output_full.csv
+    std::string camera_id = argv[6];          // e.g. camera02
+    const char* parsing = argv[1];
+    std::string redis_host = REDIS_ADDR;
+    int redis_port = 6379;
+    try {
+        FRAME_FOLDER = argv[3];                   // e.g. D:\path\to\Camera_1
+
+        current_index = std::stoull(argv[1]);    // e.g. 2379000
+
+        parsing = argv[2];
+        int fps = std::stoi(argv[2]);            // e.g. 300
+        if (fps < 1) throw std::out_of_range("target_fps");
+        TARGET_FPS = static_cast<guint>(fps);
+        FrameIntervalMs = 1000.0 / TARGET_FPS;
+
+        pts_increment = 90000 / TARGET_FPS;
+
+        // Optional flags
+        for (int i = 7; i < argc; ++i) {
+            std::string arg = argv[i];
+            parsing = argv[i];
+            if (arg.rfind("--batch=", 0) == 0) {
+                BATCH_MAX = static_cast<guint>(std::max(1, std::stoi(arg.substr(8))));
+            } else if (arg == "--offline") {
+                OFFLINE_MODE = true;
+            } else if (arg == "--no-audio") {
+                NO_AUDIO = true;
+            } else if (arg == "--fast-start") {
+                FAST_START = true;
+            } else if (arg.rfind("--skip-missing-ms=", 0) == 0) {
+                SKIP_MISSING_MS = static_cast<guint>(std::stoul(arg.substr(18)));
+            } else if (arg == "--no-parse") {
+                BYPASS_PARSE = true;
+            } else if (arg == "--trace") {
+                trace_enable(true);
+            } else if (arg.rfind("--metrics=", 0) == 0) {
+                METRICS_ADDR = arg.substr(10);
+            } else if (arg.rfind("--redis=", 0) == 0) {
+                REDIS_ADDR = arg.substr(8);
+            } else if (arg.rfind("--audio-url=", 0) == 0) {
+                AUDIO_URL = arg.substr(12);
+            } else if (arg.rfind("--sim-hours=", 0) == 0) {
+                SIM_HOURS = std::stod(arg.substr(12));
+            } else if (arg.rfind("--shm-ring=", 0) == 0) {
+                SHM_RING = arg.substr(11);
+            } else if (arg == "--huge-pages") {
+                HUGE_PAGES_MB = 64;
+            } else if (arg.rfind("--huge-pages=", 0) == 0) {
+                HUGE_PAGES_MB = static_cast<guint>(std::stoul(arg.substr(13)));
+            } else if (arg == "--cleanup") {
+                CLEANUP = true;
+            } else if (arg.rfind("--cleanup=", 0) == 0) {
+                CLEANUP = true;
+                CLEANUP_KEEP = std::stoull(arg.substr(10));
+            } else if (arg.rfind("--out=", 0) == 0) {
+                std::string error;
+                if (!ts_outputs.add(arg.substr(6), error)) {
+                    std::cerr << "[config] " << arg << ": " << error << "\n";
+                    return 1;
+                }
+            } else if (arg.rfind("--shm-out=", 0) == 0) {
+                SHM_OUT = arg.substr(10);
+            } else if (arg.rfind("--shm-out-slots=", 0) == 0) {
+                SHM_OUT_SLOTS = static_cast<guint>(std::max(2, std::stoi(arg.substr(16))));
+            } else if (arg.rfind("--shm-out-slot-kb=", 0) == 0) {
+                SHM_OUT_SLOT_KB = static_cast<guint>(std::max(1, std::stoi(arg.substr(18))));
+            } else if (arg == "--self-heal") {
+                SELF_HEAL = true;
+            } else if (arg.rfind("--self-heal=", 0) == 0) {
+                SELF_HEAL = true;
+                HEAL_STALL_MS = static_cast<guint>(std::max(100, std::stoi(arg.substr(12))));
+            } else if (arg.rfind("--heal-test=", 0) == 0) {
+                SELF_HEAL = true;
+                HEAL_TEST_S = static_cast<guint>(std::max(1, std::stoi(arg.substr(12))));
+            } else if (arg == "--bitrate-alert=off") {
+                STREAM_ALERTS.low_ratio = STREAM_ALERTS.high_ratio = 0.0;
+            } else if (arg.rfind("--bitrate-alert=", 0) == 0) {
+                std::string v = arg.substr(16);
+                size_t comma = v.find(',');
+                STREAM_ALERTS.low_ratio = std::stod(v.substr(0, comma));
+                if (comma != std::string::npos) STREAM_ALERTS.high_ratio = std::stod(v.substr(comma + 1));
+            } else if (arg.rfind("--jitter-alert-ms=", 0) == 0) {
+                STREAM_ALERTS.jitter_ms = std::max(0.0, std::stod(arg.substr(18)));
+            } else if (arg.rfind("--http=", 0) == 0) {
+                HTTP_ADDR = arg.substr(7);
+            } else if (arg == "--crc") {
+                FRAME_CRC = true;
+            } else if (arg == "--crc=drop") {
+                FRAME_CRC = true;
+                DROP_DUPLICATES = true;
+            } else if (arg.rfind("--thumbnails=", 0) == 0) {
+                THUMBS_DIR = arg.substr(13);
+            } else if (arg.rfind("--thumb-every=", 0) == 0) {
+                THUMB_EVERY = static_cast<guint>(std::stoul(arg.substr(14)));
+            } else if (arg.rfind("--thumb-width=", 0) == 0) {
+                THUMB_WIDTH = static_cast<guint>(std::max(16, std::stoi(arg.substr(14))));
+            } else if (arg.rfind("--thumb-workers=", 0) == 0) {
+                THUMB_WORKERS = static_cast<guint>(std::max(1, std::stoi(arg.substr(16))));
+            } else if (arg == "--verify") {
+                VERIFY = true;
+                VERIFY_EVERY = 50;
+            } else if (arg.rfind("--verify=", 0) == 0) {
+                VERIFY = true;
+                VERIFY_EVERY = static_cast<guint>(std::stoul(arg.substr(9)));
+            } else if (arg.rfind("--verify-budget=", 0) == 0) {
+                VERIFY_BUDGET = static_cast<guint>(std::max(1, std::min(100, std::stoi(arg.substr(16)))));
+            } else if (arg.rfind("--verify-core=", 0) == 0) {
+                VERIFY_CORE = std::stoi(arg.substr(14));
+            } else if (arg == "--thumb-webp") {
+                THUMB_WEBP = true;
+            } else if (arg.rfind("--numa-node=", 0) == 0) {
+                NUMA_NODE = arg.substr(12);
+                if (NUMA_NODE.empty() || (NUMA_NODE.find_first_not_of("0123456789") == std::string::npos && NUMA_NODE.size() > 4)) {
+                    std::cerr << "[config] --numa-node needs a node number, an interface name or auto\n";
+                    return 1;
+                }
+            } else if (arg.rfind("--listen=", 0) == 0) {
+                LISTEN_ADDR = arg.substr(9);
+            } else if (arg.rfind("--listen-udp=", 0) == 0) {
+                LISTEN_ADDR = arg.substr(13);
+                LISTEN_UDP = true;
+            } else {
+                std::cerr << "[config] Ignoring unknown option: " << arg << "\n";
+            }
         }
-        // Not fatal if Redis unavailable — we can proceed without Redis lookups if desired.
-        context = nullptr;
-    } else {
-        std::cout << "[redis] Connected successfully to DragonflyDB\n";
+
+        if (REDIS_ADDR != "off") {
+            parsing = REDIS_ADDR.c_str();
+            redis_host = REDIS_ADDR;
+            size_t colon = REDIS_ADDR.rfind(':');
+            if (colon != std::string::npos) {
+                redis_host = REDIS_ADDR.substr(0, colon);
+                redis_port = std::stoi(REDIS_ADDR.substr(colon + 1));
+                if (redis_port < 1 || redis_port > 65535) throw std::out_of_range("redis port");
+            }
+        }
+
+    } catch (const std::exception&) {
+        std::cerr << "[config] Bad value in " << parsing << "\n";
+        usage(argv[0]);
+        return 1;
     }
 
-    // Parse arguments
-    
- 
-    FRAME_FOLDER = argv[3];                   // e.g. D:\path\to\Camera_1
+    if ((!SHM_RING.empty() || !LISTEN_ADDR.empty()) && (OFFLINE_MODE || SIM_HOURS > 0)) {
+        std::cerr << "[config] --shm-ring and --listen are live inputs; they cannot be combined with --offline or --sim-hours\n";
+        return 1;
+    }
+    if (CLEANUP && (OFFLINE_MODE || SIM_HOURS > 0 || !SHM_RING.empty() || !LISTEN_ADDR.empty())) {
+        // Never delete a recorded folder; ring / network input has no files
+        std::cerr << "[config] --cleanup only applies to live file input; ignored\n";
+        CLEANUP = false;
+    }
+    if (!SHM_RING.empty() && !LISTEN_ADDR.empty()) {
+        std::cerr << "[config] Use either --shm-ring or --listen\n";
+        return 1;
+    }
 
-    current_index = std::stoull(argv[1]);    // e.g. 2379000
-    if(current_index == 0){
-        current_index = find_first_index_fast(FRAME_FOLDER) + 6000;
+    frame_stats.configure(TARGET_FPS, STREAM_ALERTS, &std::cerr);
+
+    if (!NUMA_NODE.empty()) {
+        // Before Redis, the ring, the receiver, the arena and GStreamer: every thread and
+        // buffer created from here on inherits the node
+        if (NUMA_NODE == "auto") {
+            // The NIC owning the --listen address (for 0.0.0.0 or a bare port, the one the default
+            // route goes out on), else the device holding the frame folder;
+            // a shared-memory ring lives wherever its producer put it
+            size_t colon = LISTEN_ADDR.rfind(':');
+            if (!LISTEN_ADDR.empty()) numa_node = numa_node_of_address(colon == std::string::npos ? "" : LISTEN_ADDR.substr(0, colon));
+            else if (SHM_RING.empty()) numa_node = numa_node_of_path(FRAME_FOLDER);
+        } else if (NUMA_NODE.find_first_not_of("0123456789") == std::string::npos) {
+            numa_node = std::stoi(NUMA_NODE);
+        } else {
+            numa_node = numa_node_of_interface(NUMA_NODE);
+        }
+        std::string detail;
+        if (numa_node < 0) {
+            std::cerr << "[numa] Cannot tell which node " << (NUMA_NODE == "auto" ? "the input is on" : NUMA_NODE + " is on")
+                      << "; not binding\n";
+        } else if (numa_bind(numa_node, detail)) {
+            std::cout << "[config] NUMA node " << numa_node << ": " << detail << "\n";
+        } else {
+            std::cerr << "[numa] Cannot bind to node " << numa_node << ": " << detail << "\n";
+            numa_node = -1;
+        }
     }
-    std::cout <<current_index;
 
-    // Parse start_index safely
+    // Live audio is linked into the mux up front, so the mux waits for it before writing.
+    // --fast-start has it join once it is flowing instead (see audio_join_probe); a
+    // simulated run always links up front so the mux interleaves it deterministically
+    const bool with_audio = !OFFLINE_MODE && !NO_AUDIO;
+    const bool late_audio = with_audio && SIM_HOURS <= 0 && FAST_START;
+
+    // gst_init and the plugin loads (the bulk of element creation) run on their own thread
+    // while this one connects to Redis, scans for the first index and sets up the inputs.
+    // After the NUMA binding, which the thread inherits.
+    std::vector<const char*> plugin_features = {"appsrc", "queue", "mpegtsmux", "filesink"};
+    if (!BYPASS_PARSE) plugin_features.push_back("h265parse");
+    if (with_audio) {
+        plugin_features.insert(plugin_features.end(), {SIM_HOURS > 0 ? "audiotestsrc" : "souphttpsrc", "capsfilter",
+                               "audioconvert", "audioresample", "audiorate", "audiobuffersplit", "opusenc", "opusparse"});
+    }
+    if (!THUMBS_DIR.empty() || VERIFY) plugin_features.push_back("avdec_h265");
+    std::future<void> gst_ready = std::async(std::launch::async, [&argc, &argv, &plugin_features] {
+        startup_begin(STARTUP_GST_INIT);
+        gst_init(&argc, &argv);
+        for (const char* name : plugin_features) {
+            GstElementFactory *factory = gst_element_factory_find(name);
+            if (!factory) continue;   // reported when the element is created
+            GstPluginFeature *loaded = gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+            if (loaded) gst_object_unref(loaded);
+            gst_object_unref(factory);
+        }
+        startup_end(STARTUP_GST_INIT);
+    });
+
+    // With --shm-ring / --listen the first frame that arrives sets the index
+    std::future<guint64> first_index;
+    if (current_index == 0 && SHM_RING.empty() && LISTEN_ADDR.empty()) {
+        first_index = std::async(std::launch::async, [] {
+            startup_begin(STARTUP_INDEX_SCAN);
+            guint64 index = find_first_index_fast(FRAME_FOLDER) + 6000;
+            startup_end(STARTUP_INDEX_SCAN);
+            return index;
+        });
+    }
 
-    TARGET_FPS = static_cast<guint>(std::stoi(argv[2]));  // e.g. 300
-    FrameIntervalMs = 1000.0 / TARGET_FPS;
+    // Connect to DragonflyDB (Redis-compatible); an unreachable host costs at most
+    // REDIS_CONNECT_TIMEOUT_MS of startup instead of the OS connect timeout
+    redisContext* context = nullptr;
+    if (REDIS_ADDR != "off") {
+        startup_begin(STARTUP_REDIS);
+        timeval connect_timeout = {0, REDIS_CONNECT_TIMEOUT_MS * 1000};
+        context = redisConnectWithTimeout(redis_host.c_str(), redis_port, connect_timeout);
+        startup_end(STARTUP_REDIS);
+        if (context == nullptr || context->err) {
+            if (context) {
+                std::cerr << "Redis connection error: " << context->errstr << std::endl;
+                redisFree(context);
+            } else {
+                std::cerr << "Cannot allocate Redis context" << std::endl;
+            }
+            // Not fatal if Redis unavailable — we can proceed without Redis lookups if desired.
+            context = nullptr;
+        } else {
+            std::cout << "[redis] Connected successfully to DragonflyDB at " << redis_host << ":" << redis_port << "\n";
+        }
+    }
+
+    if (first_index.valid()) current_index = first_index.get();
 
     // Calculate PTS values for MPEG-TS (90kHz clock)
     initial_pts_base = current_index * 100;
-    pts_increment = 90000 / TARGET_FPS;
-
-
-    std::string output_ts_path = argv[4];     // e.g. E:\output.ts
-    std::string csv_filename = argv[5];       // e.g. output_full.csv
-    std::string camera_id = argv[6];          // e.g. camera02
 
     // Second CSV file (summary)
     std::string csv_filename_summary = "summary_" + camera_id + ".csv";
@@ -401,36 +1162,141 @@ int main(int argc, char *argv[]) {
     std::cout << "[config] Starting from index: " << current_index << "\n";
     std::cout << "[config] Target FPS: " << TARGET_FPS << "\n";
     std::cout << "[config] Frame Interval (ms): " << FrameIntervalMs << "\n";
+    std::cout << "[config] Max frames per push: " << BATCH_MAX << (OFFLINE_MODE ? " (offline)" : "") << "\n";
+    std::cout << "[config] h265parse: " << (BYPASS_PARSE ? "bypassed" : "enabled") << "\n";
+    if (FRAME_CRC) {
+        std::cout << "[config] CRC32C per frame (" << crc32c_impl() << "), duplicates "
+                  << (DROP_DUPLICATES ? "dropped" : "flagged") << "\n";
+    }
 
-    gst_init(&argc, &argv);
+    if (SIM_HOURS > 0) {
+        for (const fs::path& p : list_frame_files(FRAME_FOLDER, camera_id)) sim_frames.push_back(p.string());
+        if (sim_frames.empty()) {
+            std::cerr << "[sim] No frame_" << camera_id << "_*.hevc files in " << FRAME_FOLDER << "\n";
+            if (context) redisFree(context);
+            return 1;
+        }
+        pace_set_virtual(true);
+        std::cout << "[config] Simulating " << SIM_HOURS << " h on a virtual clock, cycling "
+                  << sim_frames.size() << " frames\n";
+    }
+
+    if (!SHM_RING.empty()) {
+        // The receiver may come up after us
+        bool announced = false;
+        while (!frame_ring.open(SHM_RING)) {
+            if (!announced && frame_ring.busy_pid()) {
+                std::cout << "[shm] Ring " << SHM_RING << " is in use by feeder pid " << frame_ring.busy_pid()
+                          << ". Waiting for it to exit...\n";
+            } else if (!announced) {
+                std::cout << "[shm] Waiting for ring " << SHM_RING << " to be created...\n";
+            }
+            announced = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+        std::cout << "[config] Input: shared-memory ring " << SHM_RING << " (" << frame_ring.slot_count()
+                  << " slots x " << frame_ring.slot_size() / 1024 << " KB)\n";
+    }
+
+    if (!SHM_OUT.empty()) {
+        if (!video_ring.create(SHM_OUT, SHM_OUT_SLOTS, SHM_OUT_SLOT_KB * 1024)) {
+            std::cerr << "[shm] Cannot create video ring " << SHM_OUT << "\n";
+            if (context) redisFree(context);
+            return 1;
+        }
+        std::cout << "[config] Output: shared-memory video ring " << SHM_OUT << " (" << SHM_OUT_SLOTS
+                  << " slots x " << SHM_OUT_SLOT_KB << " KB)\n";
+    }
+
+    if (!LISTEN_ADDR.empty()) {
+        if (!frame_receiver.start(LISTEN_ADDR, LISTEN_UDP)) {
+            if (context) redisFree(context);
+            return 1;
+        }
+        std::cout << "[config] Input: network (" << (LISTEN_UDP ? "udp" : "tcp") << " " << LISTEN_ADDR
+                  << "), missing frames skipped after " << (SKIP_MISSING_MS ? SKIP_MISSING_MS : NET_REORDER_MS) << " ms\n";
+    }
+
+    if (HUGE_PAGES_MB) {
+        // Arena chunks match the pool buffers; enough of them for what queue1 + mux hold
+        size_t chunks = std::max<size_t>(1, static_cast<size_t>(HUGE_PAGES_MB) * 1024 * 1024 / FRAME_POOL_BUFFER_SIZE);
+        if (frame_arena.init(FRAME_POOL_BUFFER_SIZE, chunks)) {
+            std::cout << "[hugepages] " << frame_arena.report() << "\n";
+        } else {
+            std::cerr << "[hugepages] Cannot map " << HUGE_PAGES_MB << " MB; using the regular buffer pool\n";
+            HUGE_PAGES_MB = 0;
+        }
+    }
+
+    if (CLEANUP) {
+        if (!CLEANUP_KEEP) CLEANUP_KEEP = static_cast<guint64>(TARGET_FPS) * 10;
+        if (!frame_cleaner.start(FRAME_FOLDER, camera_id, current_index, CLEANUP_KEEP)) {
+            if (context) redisFree(context);
+            return 1;
+        }
+        std::cout << "[config] Removing consumed frame files, keeping the newest " << CLEANUP_KEEP << "\n";
+    }
+
+    // Ring, arena and receiver windows are mapped by now; the exit report covers the rest
+    if (numa_node >= 0) std::cout << numa_report(numa_node) << "\n";
+
+    gst_ready.get();
+    startup_begin(STARTUP_PIPELINE);
+
+    if (!THUMBS_DIR.empty()) {
+        if (!THUMB_EVERY) THUMB_EVERY = TARGET_FPS;
+        if (thumbnailer.start(THUMBS_DIR, camera_id, THUMB_EVERY, THUMB_WIDTH, THUMB_WORKERS, THUMB_WEBP, param_sets)) {
+            std::cout << "[config] Thumbnails: every " << THUMB_EVERY << " frames and on ball changes, " << THUMB_WIDTH
+                      << " px wide, " << THUMB_WORKERS << " decode threads -> " << THUMBS_DIR << "\n";
+        } else {
+            std::cerr << "[thumbs] Disabled\n";
+        }
+    }
+    if (VERIFY) {
+        std::string failures_csv = "verify_failures_" + camera_id + ".csv";
+        if (verifier.start(VERIFY_EVERY, VERIFY_BUDGET, VERIFY_CORE, failures_csv, param_sets)) {
+            std::cout << "[config] Decode verification: " << (VERIFY_EVERY ? "1 in " + std::to_string(VERIFY_EVERY) + " frames and " : "")
+                      << "ball starts, at most " << VERIFY_BUDGET << "% of one core"
+                      << (VERIFY_CORE >= 0 ? " on CPU " + std::to_string(VERIFY_CORE) : "") << ", failures -> " << failures_csv << "\n";
+        } else {
+            std::cerr << "[verify] Disabled\n";
+        }
+    }
 
     GMainLoop *loop = g_main_loop_new(NULL, FALSE);
 
     //===============Video-Pipeline===========================//
     GstElement *pipeline = gst_pipeline_new("appsrc-pipeline");
     GstElement *appsrc    = gst_element_factory_make("appsrc", "my-appsrc");
-    GstElement *h265parser = gst_element_factory_make("h265parse", "parser");
+    GstElement *h265parser = BYPASS_PARSE ? nullptr : gst_element_factory_make("h265parse", "parser");
     GstElement *queue1 = gst_element_factory_make("queue", "queue1");  // add queue
     GstElement *mpegtsmux = gst_element_factory_make("mpegtsmux", "ts-muxer");
     GstElement *filesink = gst_element_factory_make("filesink", "ts-output");
 
     //=======================Audio-pipeline (OPUS)=============================//
-    GstElement *a_src          = gst_element_factory_make("souphttpsrc", "a-http");
-    GstElement *a_caps         = gst_element_factory_make("capsfilter", "a-caps");
-    GstElement *a_queue1       = gst_element_factory_make("queue", "a-queue1");
-    GstElement *a_convert      = gst_element_factory_make("audioconvert", "a-convert");
-    GstElement *a_resample     = gst_element_factory_make("audioresample", "a-resample");
-    GstElement *a_rate         = gst_element_factory_make("audiorate", "a-rate");
-    GstElement *a_split        = gst_element_factory_make("audiobuffersplit", "a-split");
-    GstElement *a_enc          = gst_element_factory_make("opusenc", "a-opusenc");   // OPUS
-    GstElement *a_parse        = gst_element_factory_make("opusparse", "a-opusparse"); // OPUS
-    GstElement *a_queue3       = gst_element_factory_make("queue", "a-queue3");
-    GstElement *a_queue2       = gst_element_factory_make("queue", "a-queue2");
-
-    if (!pipeline || !appsrc || !h265parser || !queue1 || !mpegtsmux ||
-        !a_src || !a_caps || !a_queue1 || !a_convert || !a_resample ||
-        !a_rate || !a_split || !a_enc  || !a_parse ||
-        !a_queue3 || !a_queue2 || !filesink) {
+    // Live audio only; an offline remux has no audio source to pair with. Simulated runs
+    // use generated silence so the mux still interleaves (and the A/V skew can be checked).
+    GstElement *a_src = nullptr, *a_caps = nullptr, *a_queue1 = nullptr, *a_convert = nullptr,
+               *a_resample = nullptr, *a_rate = nullptr, *a_split = nullptr, *a_enc = nullptr,
+               *a_parse = nullptr, *a_queue3 = nullptr, *a_queue2 = nullptr;
+    if (with_audio) {
+        a_src          = gst_element_factory_make(SIM_HOURS > 0 ? "audiotestsrc" : "souphttpsrc", "a-http");
+        a_caps         = gst_element_factory_make("capsfilter", "a-caps");
+        a_queue1       = gst_element_factory_make("queue", "a-queue1");
+        a_convert      = gst_element_factory_make("audioconvert", "a-convert");
+        a_resample     = gst_element_factory_make("audioresample", "a-resample");
+        a_rate         = gst_element_factory_make("audiorate", "a-rate");
+        a_split        = gst_element_factory_make("audiobuffersplit", "a-split");
+        a_enc          = gst_element_factory_make("opusenc", "a-opusenc");   // OPUS
+        a_parse        = gst_element_factory_make("opusparse", "a-opusparse"); // OPUS
+        a_queue3       = gst_element_factory_make("queue", "a-queue3");
+        a_queue2       = gst_element_factory_make("queue", "a-queue2");
+    }
+
+    if (!pipeline || !appsrc || (!BYPASS_PARSE && !h265parser) || !queue1 || !mpegtsmux || !filesink ||
+        (with_audio && (!a_src || !a_caps || !a_queue1 || !a_convert || !a_resample ||
+                           !a_rate || !a_split || !a_enc  || !a_parse ||
+                           !a_queue3 || !a_queue2))) {
         std::cerr << "[error] Failed to create elements\n";
         if (context) redisFree(context);
         return -1;
@@ -443,6 +1309,10 @@ int main(int argc, char *argv[]) {
                 "do-timestamp", TRUE,   // <--- IMPORTANT
                  "stream-type", GST_APP_STREAM_TYPE_STREAM,
                  NULL);
+    if (OFFLINE_MODE || SIM_HOURS > 0) {
+        // Feeder sets PTS (frame counter / virtual clock); block instead of queueing the whole folder
+        g_object_set(G_OBJECT(appsrc), "is-live", FALSE, "do-timestamp", FALSE, "block", TRUE, NULL);
+    }
 
     GstCaps * caps = gst_caps_new_simple(
         "video/x-h265",
@@ -453,28 +1323,38 @@ int main(int argc, char *argv[]) {
     g_object_set(G_OBJECT(appsrc), "caps", caps, NULL);
     gst_caps_unref(caps);
 
-    g_object_set(G_OBJECT(a_src),
-             "location", "http://192.168.5.100:53354/audio",
-             "is-live", TRUE, "do-timestamp", TRUE, NULL);
+    if (with_audio && SIM_HOURS > 0) {
+        // Exactly the simulated duration of 10 ms buffers, paced by the mux like the video
+        gst_util_set_object_arg(G_OBJECT(a_src), "wave", "silence");
+        g_object_set(G_OBJECT(a_src), "is-live", FALSE, "samplesperbuffer", 480,
+                     "num-buffers", static_cast<gint>(SIM_HOURS * 3600.0 * 100.0), NULL);
+    } else if (with_audio) {
+        g_object_set(G_OBJECT(a_src),
+                 "location", AUDIO_URL.c_str(),
+                 "is-live", TRUE, "do-timestamp", TRUE, NULL);
+    }
+    if (with_audio) {
 
-    GstCaps *a_capsfilter = gst_caps_new_simple("audio/x-raw",
-        "format", G_TYPE_STRING, "S16LE", "channels", G_TYPE_INT, 2,
-        "rate", G_TYPE_INT, 48000, "layout", G_TYPE_STRING, "interleaved", NULL);
-    g_object_set(G_OBJECT(a_caps), "caps", a_capsfilter, NULL);
-    gst_caps_unref(a_capsfilter);
+        GstCaps *a_capsfilter = gst_caps_new_simple("audio/x-raw",
+            "format", G_TYPE_STRING, "S16LE", "channels", G_TYPE_INT, 2,
+            "rate", G_TYPE_INT, 48000, "layout", G_TYPE_STRING, "interleaved", NULL);
+        g_object_set(G_OBJECT(a_caps), "caps", a_capsfilter, NULL);
+        gst_caps_unref(a_capsfilter);
 
-    g_object_set(G_OBJECT(a_rate), "skip-to-first", TRUE, NULL);
-    g_object_set(G_OBJECT(a_split), "output-buffer-samples", 120, NULL);
+        g_object_set(G_OBJECT(a_rate), "skip-to-first", TRUE, NULL);
+        g_object_set(G_OBJECT(a_split), "output-buffer-samples", 120, NULL);
 
-    g_object_set(G_OBJECT(a_enc),
-                "frame-size", 2.5, "bitrate", 128000, NULL);
+        g_object_set(G_OBJECT(a_enc),
+                    "frame-size", 2.5, "bitrate", 128000, NULL);
+    }
 
     // Set output
     g_object_set(G_OBJECT(filesink), "location", output_ts_path.c_str(), NULL);
 
     if (!csv_output.is_open()) {
         csv_output.open(csv_filename);
-        csv_output << "FrameIndex,PTS_90k,Filename,ball,frame_name,innings,isStart,matchID,over,ptp_timestamp,received_at\n";
+        csv_output << "FrameIndex,PTS_90k,Filename,ball,frame_name,innings,isStart,matchID,over,ptp_timestamp,received_at"
+                   << (FRAME_CRC ? ",crc32c\n" : "\n");
     }
 
     if (!csv_output_audio.is_open()) {
@@ -487,29 +1367,38 @@ int main(int argc, char *argv[]) {
         csv_output_summary << "FrameIndex,PTS_90k,over,ball,innings,matchID\n";
     }
 
-    gst_bin_add_many(GST_BIN(pipeline), appsrc, h265parser, queue1,
-                a_src, a_caps, a_queue1, a_convert, a_resample, a_rate,
-                a_split, a_enc, a_parse, a_queue3, a_queue2,
+    gst_bin_add_many(GST_BIN(pipeline), appsrc, queue1,
                 mpegtsmux, filesink, NULL);
+    if (!BYPASS_PARSE) gst_bin_add(GST_BIN(pipeline), h265parser);
+    if (with_audio) {
+        gst_bin_add_many(GST_BIN(pipeline),
+                    a_src, a_caps, a_queue1, a_convert, a_resample, a_rate,
+                    a_split, a_enc, a_parse, a_queue3, a_queue2, NULL);
+    }
 
-    // Link video branch (appsrc -> parser -> queue -> mpegtsmux)
-    if (!gst_element_link_many(appsrc, h265parser, queue1, mpegtsmux, NULL)) {
+    // Link video branch (appsrc -> parser -> queue -> mpegtsmux, or appsrc -> queue -> mpegtsmux)
+    gboolean video_linked = BYPASS_PARSE
+        ? gst_element_link_many(appsrc, queue1, mpegtsmux, NULL)
+        : gst_element_link_many(appsrc, h265parser, queue1, mpegtsmux, NULL);
+    if (!video_linked) {
         std::cerr << "Failed to link video elements\n";
         if (context) redisFree(context);
         gst_object_unref(pipeline);
         return -1;
     }
 
-    // Link audio branch
-    if (!gst_element_link_many(a_src, a_caps, a_queue1, a_convert, a_resample, a_rate,
-                           a_split, a_enc, a_parse, a_queue3, a_queue2, mpegtsmux, NULL)) {
+    // Link audio branch (live audio up to a-queue2 only; it joins the mux when it flows)
+    if (with_audio && (!gst_element_link_many(a_src, a_caps, a_queue1, a_convert, a_resample, a_rate,
+                                              a_split, a_enc, a_parse, a_queue3, a_queue2, NULL) ||
+                       (!late_audio && !gst_element_link(a_queue2, mpegtsmux)))) {
         std::cerr << "[error] Failed to link audio branch (Opus)\n";
         if (context) redisFree(context);
         return -1;
     }
 
-    // Link mux to sink
-    if (!gst_element_link(mpegtsmux, filesink)) {
+    // Link mux to sink (through a tee when there are live outputs)
+    if (ts_outputs.empty() ? !gst_element_link(mpegtsmux, filesink)
+                           : !ts_outputs.link(pipeline, mpegtsmux, filesink)) {
         std::cerr << "[error] Failed to link mux to sink\n";
         if (context) redisFree(context);
         return -1;
@@ -518,6 +1407,20 @@ int main(int argc, char *argv[]) {
     GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
     gst_bus_add_watch(bus, bus_call, loop);
 
+    if (SELF_HEAL) {
+        std::vector<GstElement*> audio_branch;
+        if (with_audio) audio_branch = {a_src, a_caps, a_queue1, a_convert, a_resample, a_rate,
+                                        a_split, a_enc, a_parse, a_queue3, a_queue2};
+        supervisor.start(pipeline, filesink, {appsrc, queue1}, audio_branch, HEAL_STALL_MS,
+                         output_ts_path + ".splices.csv");
+        std::cout << "[config] Self-healing: errors restart the failed branch or the pipeline, stall after "
+                  << HEAL_STALL_MS << " ms without output\n";
+        if (HEAL_TEST_S) {
+            supervisor.inject_errors(queue1, HEAL_TEST_S);
+            std::cout << "[config] Fault injection: an error from queue1 every " << HEAL_TEST_S << " s\n";
+        }
+    }
+
     // Prepare probe data
     ProbeData pdata;
     pdata.csv = &csv_output;
@@ -525,16 +1428,142 @@ int main(int argc, char *argv[]) {
     pdata.redis = context;
 
     // Add audio pad probe (existing)
-    GstPad *audio_pad = gst_element_get_static_pad(a_parse, "src");
-    gst_pad_add_probe(audio_pad, GST_PAD_PROBE_TYPE_BUFFER, audio_probe, &csv_output_audio, NULL);
-    gst_object_unref(audio_pad);
+    if (with_audio) {
+        GstPad *audio_pad = gst_element_get_static_pad(a_parse, "src");
+        gst_pad_add_probe(audio_pad, GST_PAD_PROBE_TYPE_BUFFER, audio_probe, &csv_output_audio, NULL);
+        gst_object_unref(audio_pad);
+    }
+    if (late_audio) {
+        GstPad *join_pad = gst_element_get_static_pad(a_queue2, "src");
+        gst_pad_add_probe(join_pad,
+                          static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BLOCK | GST_PAD_PROBE_TYPE_BUFFER |
+                                                       GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                          audio_join_probe, mpegtsmux, NULL);
+        gst_object_unref(join_pad);
+        std::cout << "[config] Video starts without waiting for audio; audio joins the mux when it flows\n";
+    }
+
+    GstPad *first_byte_pad = gst_element_get_static_pad(filesink, "sink");
+    gst_pad_add_probe(first_byte_pad,
+                      static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                      first_byte_probe, NULL, NULL);
+    gst_object_unref(first_byte_pad);
 
     // Add video pad probe - attach to parser src so we see parsed h265 buffers with their PTS
-    GstPad *video_pad = gst_element_get_static_pad(h265parser, "src");
-    gst_pad_add_probe(video_pad, GST_PAD_PROBE_TYPE_BUFFER, video_probe, &pdata, NULL);
+    // (appsrc src when the parser is bypassed; buffers are already timestamped there)
+    GstPad *video_pad = gst_element_get_static_pad(BYPASS_PARSE ? appsrc : h265parser, "src");
+    gst_pad_add_probe(video_pad,
+                      static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                      video_probe, &pdata, NULL);
     gst_object_unref(video_pad);
 
+    // Latency tracing: frame handed to the mux, mux output, and filesink done writing it
+    if (trace_enabled()) {
+        GstPad *mux_in_pad = gst_element_get_static_pad(queue1, "src");
+        gst_pad_add_probe(mux_in_pad,
+                          static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                          trace_mux_input_probe, NULL, NULL);
+        gst_object_unref(mux_in_pad);
+        GstPad *mux_out_pad = gst_element_get_static_pad(mpegtsmux, "src");
+        gst_pad_add_probe(mux_out_pad,
+                          static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                          trace_mux_output_probe, NULL, NULL);
+        gst_object_unref(mux_out_pad);
+        trace_wrap_sink(filesink);
+        g_timeout_add_seconds(10, trace_dump_timeout, NULL);
+    }
+
+    // Metrics: bytes reaching the sink are counted in a probe, queue levels at scrape time
+    if (!METRICS_ADDR.empty()) {
+        GstPad *sink_pad = gst_element_get_static_pad(filesink, "sink");
+        gst_pad_add_probe(sink_pad,
+                          static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                          bytes_written_probe, NULL, NULL);
+        gst_object_unref(sink_pad);
+        metrics_add_collector([appsrc, queue1](std::string& out, const std::string& labels) {
+            guint64 appsrc_bytes = gst_app_src_get_current_level_bytes(GST_APP_SRC(appsrc));
+            guint q_buffers = 0, q_bytes = 0;
+            g_object_get(G_OBJECT(queue1), "current-level-buffers", &q_buffers, "current-level-bytes", &q_bytes, NULL);
+            out += "# TYPE feeder_queue_level_bytes gauge\n";
+            out += "feeder_queue_level_bytes{" + labels + ",queue=\"appsrc\"} " + std::to_string(appsrc_bytes) + "\n";
+            out += "feeder_queue_level_bytes{" + labels + ",queue=\"queue1\"} " + std::to_string(q_bytes) + "\n";
+            out += "# TYPE feeder_queue_level_buffers gauge\n";
+            out += "feeder_queue_level_buffers{" + labels + ",queue=\"queue1\"} " + std::to_string(q_buffers) + "\n";
+            if (frame_ring.is_open()) {
+                out += "# TYPE feeder_shm_ring_overruns_total counter\n";
+                out += "feeder_shm_ring_overruns_total{" + labels + "} " + std::to_string(frame_ring.overruns()) + "\n";
+            }
+            if (video_ring.is_open()) {
+                out += "# TYPE feeder_shm_out_aus_total counter\n";
+                out += "feeder_shm_out_aus_total{" + labels + ",result=\"published\"} " + std::to_string(video_ring.published()) + "\n";
+                out += "feeder_shm_out_aus_total{" + labels + ",result=\"oversize\"} " + std::to_string(video_ring.oversize()) + "\n";
+            }
+            if (CLEANUP) {
+                out += "# TYPE feeder_files_removed_total counter\n";
+                out += "feeder_files_removed_total{" + labels + ",result=\"removed\"} " + std::to_string(frame_cleaner.removed()) + "\n";
+                out += "feeder_files_removed_total{" + labels + ",result=\"absent\"} " + std::to_string(frame_cleaner.absent()) + "\n";
+                out += "feeder_files_removed_total{" + labels + ",result=\"failed\"} " + std::to_string(frame_cleaner.failed()) + "\n";
+            }
+            if (frame_receiver.running()) {
+                const FrameReceiverStats& st = frame_receiver.stats();
+                out += "# TYPE feeder_net_frames_total counter\n";
+                const std::pair<const char*, const std::atomic<uint64_t>*> results[] = {
+                    {"received", &st.frames}, {"late", &st.late}, {"duplicate", &st.duplicates},
+                    {"overflow", &st.overflow}, {"incomplete", &st.incomplete}, {"malformed", &st.malformed}};
+                for (const auto& r : results) {
+                    out += "feeder_net_frames_total{" + labels + ",result=\"" + r.first + "\"} " +
+                           std::to_string(r.second->load(std::memory_order_relaxed)) + "\n";
+                }
+                out += "# TYPE feeder_net_rebases_total counter\n";
+                out += "feeder_net_rebases_total{" + labels + "} " + std::to_string(st.rebases.load(std::memory_order_relaxed)) + "\n";
+                out += "# TYPE feeder_net_bytes_total counter\n";
+                out += "feeder_net_bytes_total{" + labels + "} " + std::to_string(st.bytes.load(std::memory_order_relaxed)) + "\n";
+                out += "# TYPE feeder_net_connections_total counter\n";
+                out += "feeder_net_connections_total{" + labels + "} " + std::to_string(st.connections.load(std::memory_order_relaxed)) + "\n";
+            }
+            ts_outputs.collect(out, labels);
+            supervisor.collect(out, labels);
+            if (verifier.running()) verifier.collect(out, labels);
+            frame_stats.collect(out, labels);
+            startup_collect(out, labels);
+            if (ts_http.running()) {
+                const TsHttpStats& st = ts_http.stats();
+                out += "# TYPE feeder_http_clients gauge\n";
+                out += "feeder_http_clients{" + labels + "} " + std::to_string(st.clients.load(std::memory_order_relaxed)) + "\n";
+                out += "# TYPE feeder_http_bytes_total counter\n";
+                out += "feeder_http_bytes_total{" + labels + "} " + std::to_string(st.bytes.load(std::memory_order_relaxed)) + "\n";
+                out += "# TYPE feeder_http_connections_total counter\n";
+                out += "feeder_http_connections_total{" + labels + "} " + std::to_string(st.connections.load(std::memory_order_relaxed)) + "\n";
+            }
+            if (thumbnailer.running()) {
+                const ThumbnailStats& st = thumbnailer.stats();
+                out += "# TYPE feeder_thumbnails_total counter\n";
+                out += "feeder_thumbnails_total{" + labels + ",result=\"written\"} " + std::to_string(st.written.load(std::memory_order_relaxed)) + "\n";
+                out += "feeder_thumbnails_total{" + labels + ",result=\"dropped\"} " + std::to_string(st.dropped.load(std::memory_order_relaxed)) + "\n";
+                out += "feeder_thumbnails_total{" + labels + ",result=\"failed\"} " + std::to_string(st.failed.load(std::memory_order_relaxed)) + "\n";
+            }
+            if (numa_node >= 0) {
+                double ratio = numa_local_ratio(numa_node);
+                if (ratio >= 0) {
+                    out += "# TYPE feeder_numa_local_ratio gauge\n";
+                    out += "feeder_numa_local_ratio{" + labels + ",node=\"" + std::to_string(numa_node) + "\"} " +
+                           std::to_string(ratio) + "\n";
+                }
+            }
+        });
+        if (!metrics_start(METRICS_ADDR, camera_id)) {
+            // Monitoring that was asked for and is not there would only be noticed mid-match
+            std::cerr << "[error] --metrics=" << METRICS_ADDR << " could not be started (port in use?)\n";
+            if (context) redisFree(context);
+            return -1;
+        }
+    }
+
+    auto wall_start = std::chrono::steady_clock::now();
     gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    startup_end(STARTUP_PIPELINE);
+    // After PLAYING so filesink has already created (or truncated) the file being served
+    if (!HTTP_ADDR.empty()) ts_http.start(HTTP_ADDR, output_ts_path);
 
     // Start feeder thread (pass redis context so feeder can also read redis if needed)
     std::thread feeder(feed_frames, appsrc, context ? context : nullptr);
@@ -544,8 +1573,21 @@ int main(int argc, char *argv[]) {
 
     // Cleanup
     feeder.join();
+    frame_cleaner.stop();
+    if (numa_node >= 0) std::cout << numa_report(numa_node) << "\n";
+    trace_dump(std::cerr);
+    metrics_stop();
+    ts_http.stop();
+    ts_outputs.report(std::cout);
+    supervisor.report(std::cout);
+    frame_stats.report(std::cout);
+    if (verifier.running()) verifier.report(std::cout);
     gst_element_set_state(pipeline, GST_STATE_NULL);
     gst_object_unref(pipeline);
+    thumbnailer.stop();
+    verifier.stop();
+    param_sets.reset();
+    frame_receiver.stop();
 
     if (csv_output.is_open()) csv_output.close();
     if (csv_output_summary.is_open()) csv_output_summary.close();
@@ -554,5 +1596,27 @@ int main(int argc, char *argv[]) {
     if (context) redisFree(context);
     gst_deinit();
 
+    if (SIM_HOURS > 0) {
+        SimResult r;
+        r.frames = metrics.frames_pushed.load();
+        r.simulated_s = static_cast<double>(r.frames) / TARGET_FPS;
+        r.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+        double last_video = static_cast<double>(metrics.last_video_pts.load());
+        double ideal_last = r.frames ? (r.frames - 1) * 1e9 / TARGET_FPS : 0.0;
+        r.drift_ms = (last_video - ideal_last) / 1e6;
+        r.have_audio = with_audio;
+        r.av_skew_ms = (last_video - static_cast<double>(metrics.last_audio_pts.load())) / 1e6;
+        r.video_pts_regressions = metrics.video_pts_regressions.load();
+        r.audio_pts_regressions = metrics.audio_pts_regressions.load();
+        r.feeder_allocs = metrics.feeder_allocs.load();
+        r.probe_allocs = metrics.probe_allocs.load();
+        sim_collect_rss(r);
+        for (const std::string& f : {output_ts_path, csv_filename, csv_filename_summary, csv_filename_audio}) {
+            std::error_code ec;
+            if (fs::is_regular_file(f, ec)) r.files.emplace_back(f, fs::file_size(f, ec));
+        }
+        return sim_report(std::cout, r, SimBudget{}) ? 0 : 2;
+    }
+
     return 0;
 }
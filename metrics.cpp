@@ -0,0 +1,221 @@
+#include "metrics.h"
+
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+static void close_socket(socket_t s) { closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+static constexpr socket_t INVALID_SOCKET = -1;
+static void close_socket(socket_t s) { close(s); }
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+FeederMetrics metrics;
+
+const double LatencyHistogram::BOUNDS[LatencyHistogram::BUCKETS] = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 1.0
+};
+
+void LatencyHistogram::observe_ns(gint64 ns) {
+    if (ns < 0) ns = 0;
+    double s = ns / 1e9;
+    int b = 0;
+    while (b < BUCKETS && s > BOUNDS[b]) b++;
+    counts[b].fetch_add(1, std::memory_order_relaxed);
+    sum_ns.fetch_add(static_cast<guint64>(ns), std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+namespace {
+
+std::vector<MetricsCollector> collectors;
+std::string camera_label;
+std::atomic<bool> running{false};
+std::thread server;
+socket_t listen_fd = INVALID_SOCKET;
+
+void counter(std::string& out, const char* name, const char* help, const std::string& labels,
+             const std::atomic<guint64>& v) {
+    out += "# HELP "; out += name; out += " "; out += help; out += "\n";
+    out += "# TYPE "; out += name; out += " counter\n";
+    out += name; out += "{" + labels + "} " + std::to_string(v.load(std::memory_order_relaxed)) + "\n";
+}
+
+void histogram(std::string& out, const char* name, const char* help, const std::string& labels,
+               const LatencyHistogram& h) {
+    out += "# HELP "; out += name; out += " "; out += help; out += "\n";
+    out += "# TYPE "; out += name; out += " histogram\n";
+    guint64 cumulative = 0;
+    for (int b = 0; b <= LatencyHistogram::BUCKETS; ++b) {
+        cumulative += h.counts[b].load(std::memory_order_relaxed);
+        std::string le = b < LatencyHistogram::BUCKETS ? std::to_string(LatencyHistogram::BOUNDS[b]) : "+Inf";
+        out += name; out += "_bucket{" + labels + ",le=\"" + le + "\"} " + std::to_string(cumulative) + "\n";
+    }
+    out += name; out += "_sum{" + labels + "} " + std::to_string(h.sum_ns.load(std::memory_order_relaxed) / 1e9) + "\n";
+    out += name; out += "_count{" + labels + "} " + std::to_string(h.count.load(std::memory_order_relaxed)) + "\n";
+}
+
+std::string render() {
+    std::string out;
+    out.reserve(8192);
+    const std::string l = "camera=\"" + camera_label + "\"";
+    counter(out, "feeder_frames_pushed_total", "Frames pushed into appsrc", l, metrics.frames_pushed);
+    out += "# HELP feeder_frames_skipped_total Frames not pushed, by reason\n";
+    out += "# TYPE feeder_frames_skipped_total counter\n";
+    out += "feeder_frames_skipped_total{" + l + ",reason=\"pb\"} " +
+           std::to_string(metrics.skipped_pb.load(std::memory_order_relaxed)) + "\n";
+    out += "feeder_frames_skipped_total{" + l + ",reason=\"missing\"} " +
+           std::to_string(metrics.skipped_missing.load(std::memory_order_relaxed)) + "\n";
+    counter(out, "feeder_missing_waits_total", "Retries because the next frame file was absent or still growing", l, metrics.missing_waits);
+    counter(out, "feeder_behind_schedule_total", "Frames pushed more than one interval late", l, metrics.behind_schedule);
+    counter(out, "feeder_push_calls_total", "appsrc push calls (buffers or lists)", l, metrics.push_calls);
+    histogram(out, "feeder_frame_read_seconds", "Open and read of one frame file", l, metrics.read_latency);
+    histogram(out, "feeder_push_lateness_seconds", "Time past the frame slot when the frame was handled", l, metrics.push_lateness);
+    counter(out, "feeder_redis_hits_total", "Redis metadata lookups that returned a value", l, metrics.redis_hits);
+    counter(out, "feeder_redis_misses_total", "Redis metadata lookups with no value", l, metrics.redis_misses);
+    counter(out, "feeder_redis_errors_total", "Redis metadata lookups that failed", l, metrics.redis_errors);
+    histogram(out, "feeder_redis_lookup_seconds", "Redis GET latency per frame", l, metrics.redis_latency);
+    counter(out, "feeder_audio_packets_total", "Audio packets seen after opusparse", l, metrics.audio_packets);
+    counter(out, "feeder_bytes_written_total", "Bytes handed to filesink", l, metrics.bytes_written);
+    counter(out, "feeder_huge_page_arena_exhausted_total", "Frames read into a regular pool buffer because the huge-page arena was empty", l, metrics.arena_exhausted);
+    counter(out, "feeder_duplicate_frames_total", "Frames whose payload repeated one pushed recently (--crc)", l, metrics.duplicate_frames);
+    counter(out, "feeder_corrupt_frames_total", "Frames without slice data (--crc)", l, metrics.corrupt_frames);
+    out += "# HELP feeder_pts_regressions_total Buffers whose PTS was not above the previous one\n";
+    out += "# TYPE feeder_pts_regressions_total counter\n";
+    out += "feeder_pts_regressions_total{" + l + ",stream=\"video\"} " +
+           std::to_string(metrics.video_pts_regressions.load(std::memory_order_relaxed)) + "\n";
+    out += "feeder_pts_regressions_total{" + l + ",stream=\"audio\"} " +
+           std::to_string(metrics.audio_pts_regressions.load(std::memory_order_relaxed)) + "\n";
+    out += "# HELP feeder_steady_heap_allocs_total C++ heap allocations per thread after the warm-up frames\n";
+    out += "# TYPE feeder_steady_heap_allocs_total counter\n";
+    out += "feeder_steady_heap_allocs_total{" + l + ",thread=\"feeder\"} " +
+           std::to_string(metrics.feeder_allocs.load(std::memory_order_relaxed)) + "\n";
+    out += "feeder_steady_heap_allocs_total{" + l + ",thread=\"probe\"} " +
+           std::to_string(metrics.probe_allocs.load(std::memory_order_relaxed)) + "\n";
+    out += "# HELP feeder_last_pts_seconds Latest PTS seen by the CSV probes\n";
+    out += "# TYPE feeder_last_pts_seconds gauge\n";
+    out += "feeder_last_pts_seconds{" + l + ",stream=\"video\"} " +
+           std::to_string(metrics.last_video_pts.load(std::memory_order_relaxed) / 1e9) + "\n";
+    out += "feeder_last_pts_seconds{" + l + ",stream=\"audio\"} " +
+           std::to_string(metrics.last_audio_pts.load(std::memory_order_relaxed) / 1e9) + "\n";
+    for (const auto& c : collectors) c(out, l);
+    return out;
+}
+
+// Bound how long one scrape can hold the (single) server thread
+void set_timeouts(socket_t s, int ms) {
+#ifdef _WIN32
+    DWORD tv = static_cast<DWORD>(ms);
+#else
+    timeval tv{ms / 1000, (ms % 1000) * 1000};
+#endif
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+}
+
+void serve_one(socket_t client) {
+    // A client that connects and sends nothing (or stops reading) is dropped after 1 s
+    set_timeouts(client, 1000);
+    // We answer every request with the metrics page; just drain the request head
+    char req[2048];
+    recv(client, req, sizeof(req), 0);
+    std::string body = render();
+    std::string resp = "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: text/plain; version=0.0.4\r\n"
+                       "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                       "Connection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < resp.size()) {
+        int n = send(client, resp.data() + sent, static_cast<int>(resp.size() - sent), MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += n;
+    }
+    close_socket(client);
+}
+
+void serve_loop() {
+    while (running.load()) {
+        // Poll so metrics_stop() never waits on a blocking accept
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(listen_fd, &fds);
+        timeval tv{0, 200000};
+        int r = select(static_cast<int>(listen_fd + 1), &fds, NULL, NULL, &tv);
+        if (r <= 0) continue;
+        socket_t client = accept(listen_fd, NULL, NULL);
+        if (client == INVALID_SOCKET) continue;
+        serve_one(client);
+    }
+}
+
+} // namespace
+
+void metrics_add_collector(MetricsCollector collector) {
+    collectors.push_back(std::move(collector));
+}
+
+bool metrics_start(const std::string& addr, const std::string& camera) {
+    std::string host = "127.0.0.1", port = addr;
+    size_t colon = addr.rfind(':');
+    if (colon != std::string::npos) {
+        host = addr.substr(0, colon);
+        port = addr.substr(colon + 1);
+    }
+    camera_label = camera;
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "[metrics] WSAStartup failed\n";
+        return false;
+    }
+#endif
+    listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_fd == INVALID_SOCKET) {
+        std::cerr << "[metrics] socket() failed\n";
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(static_cast<unsigned short>(std::stoi(port)));
+    if (inet_pton(AF_INET, host.c_str(), &sa.sin_addr) != 1 ||
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0 ||
+        listen(listen_fd, 16) != 0) {
+        std::cerr << "[metrics] Cannot listen on " << host << ":" << port << "\n";
+        close_socket(listen_fd);
+        listen_fd = INVALID_SOCKET;
+        return false;
+    }
+
+    running = true;
+    server = std::thread(serve_loop);
+    std::cout << "[metrics] Serving http://" << host << ":" << port << "/metrics\n";
+    return true;
+}
+
+void metrics_stop() {
+    if (!running.exchange(false)) return;
+    if (server.joinable()) server.join();
+    close_socket(listen_fd);
+    listen_fd = INVALID_SOCKET;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
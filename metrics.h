@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glib.h>
+#include <atomic>
+#include <functional>
+#include <string>
+
+// Feeder metrics in Prometheus text format, served over a local HTTP port.
+//
+// Hot-path updates are relaxed atomic increments only; everything else (label
+// formatting, cumulative histogram buckets, element property reads) happens on the
+// scrape thread.
+
+// Fixed-bucket latency histogram (seconds, Prometheus semantics)
+struct LatencyHistogram {
+    static constexpr int BUCKETS = 12;
+    static const double BOUNDS[BUCKETS];     // upper bounds in seconds, +Inf implied
+
+    std::atomic<guint64> counts[BUCKETS + 1];
+    std::atomic<guint64> sum_ns{0};
+    std::atomic<guint64> count{0};
+
+    void observe_ns(gint64 ns);
+};
+
+struct FeederMetrics {
+    std::atomic<guint64> frames_pushed{0};
+    std::atomic<guint64> skipped_pb{0};          // P/B frames dropped by the size heuristic
+    std::atomic<guint64> missing_waits{0};       // frame file not there / not stable yet
+    std::atomic<guint64> skipped_missing{0};     // given up on after --skip-missing-ms
+    std::atomic<guint64> behind_schedule{0};     // "[feed] Warning: Behind schedule" events
+    std::atomic<guint64> push_calls{0};
+    std::atomic<guint64> redis_hits{0};
+    std::atomic<guint64> redis_misses{0};
+    std::atomic<guint64> redis_errors{0};
+    std::atomic<guint64> audio_packets{0};
+    std::atomic<guint64> bytes_written{0};       // bytes handed to filesink
+    std::atomic<guint64> video_pts_regressions{0};   // video_probe PTS not above the previous one
+    std::atomic<guint64> audio_pts_regressions{0};
+    std::atomic<guint64> last_video_pts{0};      // ns, latest PTS seen by video_probe
+    std::atomic<guint64> last_audio_pts{0};      // ns, latest PTS seen by audio_probe
+    std::atomic<guint64> feeder_allocs{0};       // operator new calls on the feeder thread after warm-up
+    std::atomic<guint64> probe_allocs{0};        // same for the video probe's streaming thread
+    std::atomic<guint64> arena_exhausted{0};     // --huge-pages: frames read into a pool buffer, arena empty
+    std::atomic<guint64> duplicate_frames{0};    // --crc: payload identical to one pushed recently
+    std::atomic<guint64> corrupt_frames{0};      // --crc: no slice NAL in the payload (empty / cut short)
+    LatencyHistogram read_latency;               // open + read of one frame file
+    LatencyHistogram push_lateness;              // pacing: how far past its slot a frame was handled
+    LatencyHistogram redis_latency;              // GET of one frame's metadata
+};
+
+extern FeederMetrics metrics;
+
+inline void metric_inc(std::atomic<guint64>& c, guint64 n = 1) {
+    c.fetch_add(n, std::memory_order_relaxed);
+}
+
+// Extra lines appended on every scrape (e.g. queue levels read from elements).
+// Must be registered before metrics_start().
+using MetricsCollector = std::function<void(std::string& out, const std::string& labels)>;
+void metrics_add_collector(MetricsCollector collector);
+
+// Start/stop the scrape thread. addr is "port" or "host:port" (host defaults to 127.0.0.1).
+// camera becomes a camera="..." label on every series.
+bool metrics_start(const std::string& addr, const std::string& camera);
+void metrics_stop();
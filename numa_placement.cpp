@@ -0,0 +1,244 @@
+#include "numa_placement.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+constexpr int MPOL_PREFERRED_MODE = 1;   // linux/mempolicy.h
+
+int read_int_file(const std::string& path) {
+    std::ifstream f(path);
+    int v = -1;
+    if (!(f >> v)) return -1;
+    return v;
+}
+
+// "0-15,32-47" -> CPU numbers
+std::vector<int> parse_cpulist(const std::string& s) {
+    std::vector<int> cpus;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        int a = 0, b = 0;
+        int n = sscanf(part.c_str(), "%d-%d", &a, &b);
+        if (n == 1) b = a;
+        if (n >= 1) for (int c = a; c <= b; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+// Interface of the lowest-metric IPv4 default route in /proc/net/route, "" if none
+std::string default_route_interface() {
+    std::ifstream f("/proc/net/route");
+    std::string line, best;
+    unsigned long best_metric = ULONG_MAX;
+    std::getline(f, line);   // header
+    while (std::getline(f, line)) {
+        char iface[IF_NAMESIZE + 1];
+        unsigned long dest = 0, gw = 0, flags = 0, refcnt = 0, use = 0, metric = 0, mask = 0;
+        if (sscanf(line.c_str(), "%16s %lx %lx %lx %lu %lu %lu %lx", iface, &dest, &gw, &flags, &refcnt, &use,
+                   &metric, &mask) != 8)
+            continue;
+        if (dest == 0 && mask == 0 && (flags & 0x1) && metric < best_metric) {   // 0x1 = RTF_UP
+            best = iface;
+            best_metric = metric;
+        }
+    }
+    return best;
+}
+#endif
+
+} // namespace
+
+int numa_node_count() {
+#ifdef _WIN32
+    ULONG highest = 0;
+    return GetNumaHighestNodeNumber(&highest) ? static_cast<int>(highest) + 1 : 1;
+#elif defined(__linux__)
+    int n = 0;
+    while (access(("/sys/devices/system/node/node" + std::to_string(n)).c_str(), F_OK) == 0) ++n;
+    return n ? n : 1;
+#else
+    return 1;
+#endif
+}
+
+int numa_node_of_path(const std::string& path) {
+#ifdef __linux__
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || major(st.st_dev) == 0) return -1;   // major 0: tmpfs & co
+    // /sys/dev/block/M:m is the partition or disk; numa_node sits on the controller above it
+    char buf[64];
+    snprintf(buf, sizeof(buf), "/sys/dev/block/%u:%u", major(st.st_dev), minor(st.st_dev));
+    char real[4096];
+    if (!realpath(buf, real)) return -1;
+    for (std::string dir = real; dir.size() > 1; dir = dir.substr(0, dir.rfind('/'))) {
+        int node = read_int_file(dir + "/device/numa_node");
+        if (node < 0) node = read_int_file(dir + "/numa_node");
+        if (node >= 0) return node;
+    }
+#else
+    (void)path;
+#endif
+    return -1;
+}
+
+int numa_node_of_interface(const std::string& ifname) {
+#ifdef __linux__
+    return read_int_file("/sys/class/net/" + ifname + "/device/numa_node");
+#else
+    (void)ifname;
+    return -1;
+#endif
+}
+
+int numa_node_of_address(const std::string& ip) {
+#ifdef __linux__
+    in_addr want{};
+    if (ip.empty() || ip == "0.0.0.0") {
+        // Listening on every address: frames most likely come in over the default route
+        std::string ifname = default_route_interface();
+        return ifname.empty() ? -1 : numa_node_of_interface(ifname);
+    }
+    if (inet_pton(AF_INET, ip.c_str(), &want) != 1) return -1;
+    ifaddrs* ifs = nullptr;
+    if (getifaddrs(&ifs) != 0) return -1;
+    int node = -1;
+    for (ifaddrs* i = ifs; i; i = i->ifa_next) {
+        if (!i->ifa_addr || i->ifa_addr->sa_family != AF_INET) continue;
+        if (reinterpret_cast<sockaddr_in*>(i->ifa_addr)->sin_addr.s_addr == want.s_addr) {
+            node = numa_node_of_interface(i->ifa_name);
+            break;
+        }
+    }
+    freeifaddrs(ifs);
+    return node;
+#else
+    (void)ip;
+    return -1;
+#endif
+}
+
+bool numa_bind(int node, std::string& detail) {
+    if (node < 0 || node >= numa_node_count()) {
+        detail = "no node " + std::to_string(node) + " (" + std::to_string(numa_node_count()) + " present)";
+        return false;
+    }
+#ifdef _WIN32
+    GROUP_AFFINITY ga{};
+    if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &ga) || !ga.Mask) {
+        detail = "cannot read the processors of node " + std::to_string(node);
+        return false;
+    }
+    WORD group = 0;
+    PROCESSOR_NUMBER pn{};
+    GetCurrentProcessorNumberEx(&pn);
+    group = pn.Group;
+    if (ga.Group != group || !SetProcessAffinityMask(GetCurrentProcess(), ga.Mask)) {
+        detail = "cannot set the process affinity to node " + std::to_string(node);
+        return false;
+    }
+    char mask[32];
+    snprintf(mask, sizeof(mask), "%llx", static_cast<unsigned long long>(ga.Mask));
+    detail = "CPUs 0x" + std::string(mask) + ", memory from the running node";
+    return true;
+#elif defined(__linux__)
+    std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    std::getline(f, list);
+    std::vector<int> cpus = parse_cpulist(list);
+    if (cpus.empty()) {
+        detail = "node " + std::to_string(node) + " has no CPUs";
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) if (c < CPU_SETSIZE) CPU_SET(c, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        detail = std::string("sched_setaffinity: ") + strerror(errno);
+        return false;
+    }
+    // Preferred rather than bound: allocations spill to the other node instead of failing
+    unsigned long mask[16] = {};
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, mask, sizeof(mask) * 8) != 0) {
+        detail = "CPUs " + list + ", set_mempolicy: " + strerror(errno);
+        return false;
+    }
+    detail = "CPUs " + list + ", memory preferred on node " + std::to_string(node);
+    return true;
+#else
+    detail = "not supported on this platform";
+    return false;
+#endif
+}
+
+bool numa_resident_bytes(std::vector<uint64_t>& bytes) {
+    bytes.assign(static_cast<size_t>(numa_node_count()), 0);
+#ifdef __linux__
+    // One mapping per line: "... N0=12 N1=3 kernelpagesize_kB=4"
+    std::ifstream f("/proc/self/numa_maps");
+    if (!f) return false;
+    std::string line, tok;
+    while (std::getline(f, line)) {
+        uint64_t page_kb = 4;
+        size_t k = line.find("kernelpagesize_kB=");
+        if (k != std::string::npos) page_kb = std::stoull(line.substr(k + 18));
+        std::istringstream ss(line);
+        while (ss >> tok) {
+            unsigned node = 0;
+            unsigned long long pages = 0;
+            if (sscanf(tok.c_str(), "N%u=%llu", &node, &pages) == 2) {
+                if (node >= bytes.size()) bytes.resize(node + 1, 0);
+                bytes[node] += pages * page_kb * 1024;
+            }
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+double numa_local_ratio(int node) {
+    std::vector<uint64_t> bytes;
+    if (node < 0 || !numa_resident_bytes(bytes) || static_cast<size_t>(node) >= bytes.size()) return -1.0;
+    uint64_t total = 0;
+    for (uint64_t b : bytes) total += b;
+    return total ? static_cast<double>(bytes[static_cast<size_t>(node)]) / static_cast<double>(total) : -1.0;
+}
+
+std::string numa_report(int node) {
+    std::vector<uint64_t> bytes;
+    if (node < 0 || !numa_resident_bytes(bytes) || static_cast<size_t>(node) >= bytes.size())
+        return "[numa] node " + std::to_string(node) + ": placement read-back not available";
+    uint64_t total = 0;
+    for (uint64_t b : bytes) total += b;
+    uint64_t local = bytes[static_cast<size_t>(node)];
+    const double MB = 1024.0 * 1024.0;
+    char line[160];
+    snprintf(line, sizeof(line), "[numa] node %d: %.1f%% of %.1f MB resident local (%.1f MB remote)", node,
+             total ? 100.0 * static_cast<double>(local) / static_cast<double>(total) : 0.0,
+             static_cast<double>(total) / MB, static_cast<double>(total - local) / MB);
+    return line;
+}
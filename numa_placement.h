@@ -0,0 +1,36 @@
+#pragma once
+
+// --numa-node: keep one camera's feeder on the NUMA node its frames arrive on.
+//
+// Each camera runs as its own appsrc_feeder process, so placement is process-wide:
+// numa_bind() is called on the main thread before any other thread or buffer memory
+// exists, and everything created afterwards (feeder thread, GStreamer streaming
+// threads, buffer pool, huge-page arena) inherits the node's CPUs and prefers its
+// memory. The node can be given as a number, as a network interface name, or "auto":
+// the node of the input folder's block device, or of the NIC owning the --listen address.
+//
+// Linux: sched_setaffinity + set_mempolicy(MPOL_PREFERRED), node topology from sysfs,
+// placement read back from /proc/self/numa_maps. Windows: process affinity to the node's
+// processors (memory then comes from the node of the running thread); no read-back.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+int numa_node_count();
+// Node of the block device holding path / of a network interface / of the interface
+// that owns a local IPv4 address ("" or 0.0.0.0: the default-route interface);
+// -1 if unknown (tmpfs, virtual devices, one node)
+int numa_node_of_path(const std::string& path);
+int numa_node_of_interface(const std::string& ifname);
+int numa_node_of_address(const std::string& ip);
+
+// Bind this thread (and every thread it creates later) to node; detail says what was done
+bool numa_bind(int node, std::string& detail);
+
+// Resident bytes of this process per node (index = node), false where not available
+bool numa_resident_bytes(std::vector<uint64_t>& bytes);
+// Share of resident memory on `node`, -1 if not available
+double numa_local_ratio(int node);
+// "[numa] node 1: 97.3% of 412.0 MB resident local (11.1 MB remote)"
+std::string numa_report(int node);
@@ -0,0 +1,54 @@
+#include "param_sets.h"
+
+#include "feeder_core.h"
+
+bool ParamSetCache::same(const uint8_t* data, const AuInfo& au) const {
+    if (!param_sets_ || gst_buffer_get_size(param_sets_) != au.vps.size + au.sps.size + au.pps.size) return false;
+    return gst_buffer_memcmp(param_sets_, 0, data + au.vps.offset, au.vps.size) == 0 &&
+           gst_buffer_memcmp(param_sets_, au.vps.size, data + au.sps.offset, au.sps.size) == 0 &&
+           gst_buffer_memcmp(param_sets_, au.vps.size + au.sps.size, data + au.pps.offset, au.pps.size) == 0;
+}
+
+bool ParamSetCache::learn(const uint8_t* data, const AuInfo& au) {
+    if (!au.vps.size || !au.sps.size || !au.pps.size) return false;
+    std::lock_guard<std::mutex> lock(mu_);
+    if (same(data, au)) return false;
+    GstBuffer* ps = gst_buffer_new_allocate(NULL, au.vps.size + au.sps.size + au.pps.size, NULL);
+    gst_buffer_fill(ps, 0, data + au.vps.offset, au.vps.size);
+    gst_buffer_fill(ps, au.vps.size, data + au.sps.offset, au.sps.size);
+    gst_buffer_fill(ps, au.vps.size + au.sps.size, data + au.pps.offset, au.pps.size);
+    // Buffers already given the old set keep their own reference to its memory
+    if (param_sets_) gst_buffer_unref(param_sets_);
+    param_sets_ = ps;
+    return true;
+}
+
+bool ParamSetCache::prepend(GstBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!param_sets_) return false;
+    gst_buffer_prepend_memory(buffer, gst_memory_ref(gst_buffer_peek_memory(param_sets_, 0)));
+    return true;
+}
+
+GstBuffer* ParamSetCache::decodable(GstBuffer* buffer) {
+    // Only to see whether the frame carries its own set; learning is the feeder's
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) return nullptr;
+    AuInfo au = scan_hevc_au(map.data, map.size);
+    gst_buffer_unmap(buffer, &map);
+    bool in_band = au.vps.size && au.sps.size && au.pps.size;
+
+    GstBuffer* out = gst_buffer_new();
+    gst_buffer_copy_into(out, buffer, GST_BUFFER_COPY_MEMORY, 0, static_cast<gsize>(-1));
+    if (!in_band && !prepend(out)) {
+        gst_buffer_unref(out);
+        return nullptr;
+    }
+    return out;
+}
+
+void ParamSetCache::reset() {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (param_sets_) gst_buffer_unref(param_sets_);
+    param_sets_ = nullptr;
+}
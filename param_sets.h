@@ -0,0 +1,37 @@
+#pragma once
+
+#include <gst/gst.h>
+#include <cstdint>
+#include <mutex>
+
+struct AuInfo;
+
+// The last complete in-band VPS/SPS/PPS set, one per process. The feeder thread teaches
+// it from the NAL scan it already makes of every frame; --no-parse prepends the set to
+// keyframes that arrive without one, and the side decoders (thumbnails, --verify) do
+// the same to make a keyframe decodable on its own. Not every camera repeats the sets
+// in each keyframe.
+class ParamSetCache {
+public:
+    ParamSetCache() = default;
+    ~ParamSetCache() { reset(); }
+    ParamSetCache(const ParamSetCache&) = delete;
+    ParamSetCache& operator=(const ParamSetCache&) = delete;
+
+    // Feeder thread, per keyframe with its scan: keeps the frame's complete set. Copies
+    // only when it differs from the one kept (usually every keyframe repeats it); true then.
+    bool learn(const uint8_t* data, const AuInfo& au);
+    // Shares the kept set in front of buffer, no payload copy; false if none seen yet
+    bool prepend(GstBuffer* buffer);
+    // New buffer sharing the frame's memory (the pipeline's timestamps and metas stay
+    // behind), parameter sets prepended if it has none; nullptr if none were seen yet.
+    // Any thread.
+    GstBuffer* decodable(GstBuffer* buffer);
+    void reset();
+
+private:
+    bool same(const uint8_t* data, const AuInfo& au) const;
+
+    std::mutex mu_;
+    GstBuffer* param_sets_ = nullptr;
+};
@@ -0,0 +1,304 @@
+#include "self_heal.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "metrics.h"
+
+namespace {
+
+const gint64 QUICK_REFAIL_NS = 2 * GST_SECOND;   // a failure this soon after a restart backs off
+const guint BACKOFF_MIN_MS = 100;
+const guint BACKOFF_MAX_MS = 5000;
+const guint WATCHDOG_MS = 100;
+
+const char* const SCOPE_NAMES[] = {"pipeline", "audio"};
+const char* const CAUSE_NAMES[] = {"error", "stall", "flow"};
+
+gint64 now_ns() { return g_get_monotonic_time() * 1000; }
+
+// Buffers queued in appsrc or a queue; the property is guint64 on appsrc (1.20+) and
+// guint on queue, so it is read through a GValue
+guint64 level_buffers(GstElement* e) {
+    GParamSpec* spec = g_object_class_find_property(G_OBJECT_GET_CLASS(e), "current-level-buffers");
+    if (!spec) return 0;
+    GValue v = G_VALUE_INIT, n = G_VALUE_INIT;
+    g_value_init(&v, spec->value_type);
+    g_object_get_property(G_OBJECT(e), "current-level-buffers", &v);
+    g_value_init(&n, G_TYPE_UINT64);
+    guint64 level = g_value_transform(&v, &n) ? g_value_get_uint64(&n) : 0;
+    g_value_unset(&v);
+    g_value_unset(&n);
+    return level;
+}
+
+} // namespace
+
+void PipelineSupervisor::start(GstElement* pipeline, GstElement* filesink, const std::vector<GstElement*>& video_queues,
+                               const std::vector<GstElement*>& audio_branch, guint stall_ms, const std::string& splice_log) {
+    pipeline_ = pipeline;
+    filesink_ = filesink;
+    video_queues_ = video_queues;
+    audio_ = audio_branch;
+    stall_ns_ = static_cast<gint64>(stall_ms) * 1000000;
+    // filesink truncates the recording at PLAYING; splices of an earlier run do not apply
+    splice_log_ = splice_log;
+    std::remove(splice_log_.c_str());
+
+    GstPad* pad = gst_element_get_static_pad(filesink, "sink");
+    gst_pad_add_probe(pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                      sink_probe, this, NULL);
+    gst_object_unref(pad);
+    if (!audio_.empty()) {
+        pad = gst_element_get_static_pad(audio_.back(), "src");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, audio_probe, this, NULL);
+        gst_object_unref(pad);
+    }
+    g_timeout_add(WATCHDOG_MS, watchdog, this);
+}
+
+GstPadProbeReturn PipelineSupervisor::sink_probe(GstPad* pad, GstPadProbeInfo* info, gpointer self) {
+    (void)pad; (void)info;
+    PipelineSupervisor* s = static_cast<PipelineSupervisor*>(self);
+    s->last_sink_ns_.store(now_ns(), std::memory_order_relaxed);
+    s->pushed_at_sink_.store(metrics.frames_pushed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    s->finished(s->pipeline_since_ns_, "pipeline");
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn PipelineSupervisor::audio_probe(GstPad* pad, GstPadProbeInfo* info, gpointer self) {
+    (void)pad; (void)info;
+    PipelineSupervisor* s = static_cast<PipelineSupervisor*>(self);
+    s->finished(s->audio_since_ns_, "audio branch");
+    return GST_PAD_PROBE_OK;
+}
+
+void PipelineSupervisor::finished(std::atomic<gint64>& since, const char* what) {
+    // Every buffer passes here; only the first one after a restart does any work
+    if (!since.load(std::memory_order_relaxed)) return;
+    gint64 t0 = since.exchange(0, std::memory_order_relaxed);
+    if (!t0) return;
+    guint64 d = static_cast<guint64>(std::max<gint64>(0, now_ns() - t0));
+    stats_.total_ns.fetch_add(d, std::memory_order_relaxed);
+    stats_.last_ns.store(d, std::memory_order_relaxed);
+    guint64 max = stats_.max_ns.load(std::memory_order_relaxed);
+    while (d > max && !stats_.max_ns.compare_exchange_weak(max, d, std::memory_order_relaxed)) {
+    }
+    stats_.completed.fetch_add(1, std::memory_order_relaxed);
+    std::cerr << "[heal] " << what << " recovered in " << d / 1000000 << " ms\n";
+}
+
+bool PipelineSupervisor::on_error(GstMessage* msg) {
+    if (!enabled()) return false;
+    GstObject* src = GST_MESSAGE_SRC(msg);
+    bool audio = std::find(audio_.begin(), audio_.end(), reinterpret_cast<GstElement*>(src)) != audio_.end();
+    std::cerr << "[heal] Restarting the " << (audio ? "audio branch" : "pipeline") << " after an error from "
+              << GST_OBJECT_NAME(src) << "\n";
+    schedule(audio ? HEAL_AUDIO : HEAL_PIPELINE, HEAL_ERROR);
+    return true;
+}
+
+bool PipelineSupervisor::recover_push(guint64 generation_before, GstFlowReturn ret) {
+    if (!enabled() || ret == GST_FLOW_EOS) return false;
+    // FLUSHING from a restart that began meanwhile needs no new one
+    if (generation() == generation_before) {
+        std::cerr << "[heal] Restarting the pipeline after a push returned " << gst_flow_get_name(ret) << "\n";
+        schedule(HEAL_PIPELINE, HEAL_FLOW);
+    }
+    wait_ready();
+    return true;
+}
+
+void PipelineSupervisor::inject_errors(GstElement* element, guint every_s) {
+    g_timeout_add_seconds(every_s, inject_error, element);
+}
+
+gboolean PipelineSupervisor::inject_error(gpointer element) {
+    GError* err = g_error_new_literal(GST_STREAM_ERROR, GST_STREAM_ERROR_FAILED, "Injected fault (--heal-test)");
+    gst_element_post_message(GST_ELEMENT(element),
+                             gst_message_new_error(GST_OBJECT(element), err, "bench/run_heal_test.sh"));
+    g_error_free(err);
+    return G_SOURCE_CONTINUE;
+}
+
+guint64 PipelineSupervisor::queued_frames() const {
+    guint64 n = 0;
+    for (GstElement* e : video_queues_) n += level_buffers(e);
+    return n;
+}
+
+void PipelineSupervisor::log_splice(guint64 discarded) {
+    if (splice_log_.empty()) return;
+    gchar* location = nullptr;
+    g_object_get(G_OBJECT(filesink_), "location", &location, NULL);
+    std::error_code ec;
+    uintmax_t offset = location ? std::filesystem::file_size(location, ec) : 0;
+    g_free(location);
+    if (ec) return;
+    std::ofstream log(splice_log_, std::ios::out | std::ios::app);
+    if (log.tellp() == 0) log << "ByteOffset,DiscardedFrames\n";
+    log << offset << "," << discarded << "\n";
+    if (!log) std::cerr << "[heal] Cannot write " << splice_log_ << "\n";
+}
+
+void PipelineSupervisor::wait_restart() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return !restarting_.load(std::memory_order_acquire); });
+}
+
+void PipelineSupervisor::schedule(HealScope scope, HealCause cause) {
+    guint delay_ms = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // One restart at a time; a pipeline restart also covers the audio branch
+        if (restarting_.load(std::memory_order_relaxed) || (scope == HEAL_AUDIO && audio_pending_)) return;
+        if (scope == HEAL_PIPELINE) restarting_.store(true, std::memory_order_release);
+        else audio_pending_ = true;
+        gint64 now = now_ns();
+        failures_ = last_done_ns_ && now - last_done_ns_ < QUICK_REFAIL_NS ? failures_ + 1 : 0;
+        if (failures_) delay_ms = std::min(BACKOFF_MAX_MS, BACKOFF_MIN_MS << std::min(failures_ - 1, 6u));
+    }
+    stats_.count[scope][cause].fetch_add(1, std::memory_order_relaxed);
+    if (delay_ms) std::cerr << "[heal] Failing again right after a restart; waiting " << delay_ms << " ms\n";
+
+    // Restarts run on the main loop, where the bus watch lives
+    Pending* p = new Pending{this, scope, cause, now_ns()};
+    if (delay_ms) g_timeout_add(delay_ms, run_pending, p);
+    else g_idle_add(run_pending, p);
+}
+
+gboolean PipelineSupervisor::run_pending(gpointer data) {
+    Pending* p = static_cast<Pending*>(data);
+    if (p->scope == HEAL_PIPELINE) p->self->restart_pipeline(p->detected_ns);
+    else p->self->restart_audio(p->detected_ns);
+    delete p;
+    return G_SOURCE_REMOVE;
+}
+
+void PipelineSupervisor::restart_pipeline(gint64 detected_ns) {
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+    GstClock* clock = gst_element_get_clock(pipeline_);
+    GstClockTime base = gst_element_get_base_time(pipeline_);
+
+    // Whatever is still queued goes down with the pipeline
+    guint64 discarded = queued_frames();
+    stats_.discarded.fetch_add(discarded, std::memory_order_relaxed);
+    if (discarded) std::cerr << "[heal] Restart discards " << discarded << " queued frames\n";
+
+    // Stops every streaming thread; the feeder's pushes return FLUSHING from here on
+    gst_element_set_state(pipeline_, GST_STATE_NULL);
+    // filesink has closed the file: its size is where the new mux run starts
+    log_splice(discarded);
+    // Messages the failed run left queued would only trigger another restart
+    GstBus* bus = gst_element_get_bus(pipeline_);
+    gst_bus_set_flushing(bus, TRUE);
+    gst_bus_set_flushing(bus, FALSE);
+    gst_object_unref(bus);
+
+    // Same file, same clock and base time: running time carries on instead of restarting at 0
+    g_object_set(G_OBJECT(filesink_), "append", TRUE, NULL);
+    if (clock) {
+        gst_pipeline_use_clock(GST_PIPELINE(pipeline_), clock);
+        gst_element_set_start_time(pipeline_, GST_CLOCK_TIME_NONE);
+        gst_element_set_base_time(pipeline_, base);
+        gst_object_unref(clock);
+    }
+    audio_since_ns_.store(0, std::memory_order_relaxed);
+    pipeline_since_ns_.store(detected_ns, std::memory_order_relaxed);
+    pending_since_ns_ = 0;
+    GstStateChangeReturn ret = gst_element_set_state(pipeline_, GST_STATE_PLAYING);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        restarting_.store(false, std::memory_order_release);
+        audio_pending_ = false;
+        last_done_ns_ = now_ns();
+    }
+    ready_.notify_all();
+    if (ret == GST_STATE_CHANGE_FAILURE) {
+        std::cerr << "[heal] Pipeline did not come back to PLAYING\n";
+        schedule(HEAL_PIPELINE, HEAL_ERROR);
+    }
+}
+
+void PipelineSupervisor::restart_audio(gint64 detected_ns) {
+    for (GstElement* e : audio_) gst_element_set_state(e, GST_STATE_NULL);
+    // Rejoin the running pipeline on its clock and base time, so audio PTS stay on the video's timeline
+    GstClock* clock = gst_element_get_clock(pipeline_);
+    GstClockTime base = gst_element_get_base_time(pipeline_);
+    audio_since_ns_.store(detected_ns, std::memory_order_relaxed);
+    // Downstream first, so the source never pushes into an element that is not running yet
+    for (auto it = audio_.rbegin(); it != audio_.rend(); ++it) {
+        if (clock) gst_element_set_clock(*it, clock);
+        gst_element_set_base_time(*it, base);
+        gst_element_sync_state_with_parent(*it);
+    }
+    if (clock) gst_object_unref(clock);
+    std::lock_guard<std::mutex> lock(mutex_);
+    audio_pending_ = false;
+    last_done_ns_ = now_ns();
+}
+
+gboolean PipelineSupervisor::watchdog(gpointer data) {
+    PipelineSupervisor* s = static_cast<PipelineSupervisor*>(data);
+    if (s->restarting_.load(std::memory_order_acquire)) return G_SOURCE_CONTINUE;
+    // Frames waiting in the pipeline while nothing reaches the sink; an idle feeder
+    // (input not there yet) pushes nothing and never counts as a stall
+    gint64 now = now_ns();
+    if (metrics.frames_pushed.load(std::memory_order_relaxed) <= s->pushed_at_sink_.load(std::memory_order_relaxed)) {
+        s->pending_since_ns_ = 0;
+    } else if (!s->pending_since_ns_ || s->last_sink_ns_.load(std::memory_order_relaxed) >= s->pending_since_ns_) {
+        s->pending_since_ns_ = now;
+    } else if (now - s->pending_since_ns_ > s->stall_ns_) {
+        std::cerr << "[heal] No output for " << (now - s->pending_since_ns_) / 1000000
+                  << " ms with frames pushed; restarting the pipeline\n";
+        s->pending_since_ns_ = 0;
+        s->schedule(HEAL_PIPELINE, HEAL_STALL);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+void PipelineSupervisor::collect(std::string& out, const std::string& labels) const {
+    if (!enabled()) return;
+    out += "# TYPE feeder_recoveries_total counter\n";
+    for (int scope = 0; scope < 2; ++scope) {
+        for (int cause = 0; cause < 3; ++cause) {
+            out += "feeder_recoveries_total{" + labels + ",scope=\"" + SCOPE_NAMES[scope] + "\",cause=\"" +
+                   CAUSE_NAMES[cause] + "\"} " +
+                   std::to_string(stats_.count[scope][cause].load(std::memory_order_relaxed)) + "\n";
+        }
+    }
+    out += "# TYPE feeder_recovery_seconds summary\n";
+    out += "feeder_recovery_seconds_sum{" + labels + "} " +
+           std::to_string(stats_.total_ns.load(std::memory_order_relaxed) / 1e9) + "\n";
+    out += "feeder_recovery_seconds_count{" + labels + "} " +
+           std::to_string(stats_.completed.load(std::memory_order_relaxed)) + "\n";
+    out += "# TYPE feeder_recovery_discarded_frames_total counter\n";
+    out += "feeder_recovery_discarded_frames_total{" + labels + "} " +
+           std::to_string(stats_.discarded.load(std::memory_order_relaxed)) + "\n";
+    out += "# TYPE feeder_recovery_max_seconds gauge\n";
+    out += "feeder_recovery_max_seconds{" + labels + "} " +
+           std::to_string(stats_.max_ns.load(std::memory_order_relaxed) / 1e9) + "\n";
+}
+
+void PipelineSupervisor::report(std::ostream& os) const {
+    if (!enabled()) return;
+    guint64 per_scope[2] = {0, 0};
+    for (int scope = 0; scope < 2; ++scope)
+        for (int cause = 0; cause < 3; ++cause) per_scope[scope] += stats_.count[scope][cause].load(std::memory_order_relaxed);
+    guint64 done = stats_.completed.load(std::memory_order_relaxed);
+    std::ostringstream line;
+    line << "[heal] " << per_scope[0] + per_scope[1] << " recoveries (" << per_scope[0] << " pipeline, " << per_scope[1]
+         << " audio)";
+    if (done) {
+        line << std::fixed << std::setprecision(0) << ", mean " << stats_.total_ns.load(std::memory_order_relaxed) / 1e6 / done
+             << " ms, max " << stats_.max_ns.load(std::memory_order_relaxed) / 1e6 << " ms";
+    }
+    if (per_scope[0]) line << ", " << stats_.discarded.load(std::memory_order_relaxed) << " queued frames discarded";
+    os << line.str() << "\n";
+}
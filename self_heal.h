@@ -0,0 +1,126 @@
+#pragma once
+
+#include <gst/gst.h>
+#include <atomic>
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// --self-heal: recover from element errors and stalls without leaving the process.
+//
+// Errors posted by an audio-branch element restart just that branch (its elements go
+// to NULL and back to the pipeline's state); the video keeps flowing meanwhile. Any
+// other error, a flow error seen by the feeder, or a stall (frames pushed but nothing
+// reaching filesink for stall_ms) restarts the whole pipeline in place: NULL, then
+// PLAYING again with filesink appending to the same file and the previous base time
+// kept, so running time (and with it every PTS in the TS and the CSVs) carries on
+// where it was instead of restarting at zero. The feeder waits out a restart and
+// continues with its next frame; frame_counter and the CSVs are unaffected.
+//
+// A pipeline restart loses every frame still queued in it: the one being pushed (the
+// feeder logs it) and whatever appsrc and queue1 hold when the pipeline goes to NULL,
+// which is read just before and counted in feeder_recovery_discarded_frames_total.
+// Frames already inside the mux are lost too and not counted (a few at most).
+//
+// The restarted mux begins a new PAT/PMT and continuity-counter run in the file. The
+// byte offset where it starts is appended to the splice log (ByteOffset,DiscardedFrames),
+// which ts_analyzer reads to exempt the splice from its continuity and PCR checks.
+// Restarts that fail again within 2 s back off, doubling from 100 ms up to 5 s.
+// Durations run from detection to the first buffer at filesink (audio branch: at the
+// end of the branch).
+
+enum HealScope { HEAL_PIPELINE = 0, HEAL_AUDIO = 1 };
+enum HealCause { HEAL_ERROR = 0, HEAL_STALL = 1, HEAL_FLOW = 2 };
+
+struct HealStats {
+    std::atomic<guint64> count[2][3] = {};       // [scope][cause]
+    std::atomic<guint64> total_ns{0};            // sum of completed recovery durations
+    std::atomic<guint64> max_ns{0};
+    std::atomic<guint64> last_ns{0};
+    std::atomic<guint64> completed{0};
+    std::atomic<guint64> discarded{0};           // frames queued in appsrc / queue1 at pipeline restarts
+};
+
+class PipelineSupervisor {
+public:
+    PipelineSupervisor() = default;
+    PipelineSupervisor(const PipelineSupervisor&) = delete;
+    PipelineSupervisor& operator=(const PipelineSupervisor&) = delete;
+
+    // Call once the pipeline is linked, before PLAYING. video_queues are the elements
+    // whose queued frames a restart discards (appsrc, queue1); audio_branch lists the
+    // audio elements source first (empty without audio). splice_log is recreated here.
+    void start(GstElement* pipeline, GstElement* filesink, const std::vector<GstElement*>& video_queues,
+               const std::vector<GstElement*>& audio_branch, guint stall_ms, const std::string& splice_log);
+    bool enabled() const { return pipeline_ != nullptr; }
+
+    // Bus watch, main thread: true if a recovery was scheduled (do not quit)
+    bool on_error(GstMessage* msg);
+    // Feeder: returns once no pipeline restart is pending or running
+    void wait_ready() {
+        if (restarting_.load(std::memory_order_acquire)) wait_restart();
+    }
+    // Pipeline restarts begun so far; read before a push
+    guint64 generation() const { return generation_.load(std::memory_order_acquire); }
+    // Feeder, after a push returned ret: true if it should carry on with its next frame.
+    // Requests a restart unless one has begun since generation_before, then waits it out.
+    bool recover_push(guint64 generation_before, GstFlowReturn ret);
+    // Fault injection for bench/run_heal_test.sh: post an error from element every
+    // every_s seconds, which takes the same path as a real one
+    void inject_errors(GstElement* element, guint every_s);
+
+    const HealStats& stats() const { return stats_; }
+    // Prometheus lines (feeder_recoveries_total{scope=,cause=}, feeder_recovery_seconds)
+    void collect(std::string& out, const std::string& labels) const;
+    // "[heal] 3 recoveries (2 pipeline, 1 audio), mean 140 ms, max 310 ms, 12 queued frames discarded"
+    void report(std::ostream& os) const;
+
+private:
+    struct Pending {
+        PipelineSupervisor* self;
+        HealScope scope;
+        HealCause cause;
+        gint64 detected_ns;
+    };
+    void schedule(HealScope scope, HealCause cause);
+    static gboolean run_pending(gpointer data);
+    static gboolean watchdog(gpointer data);
+    static GstPadProbeReturn sink_probe(GstPad* pad, GstPadProbeInfo* info, gpointer self);
+    static GstPadProbeReturn audio_probe(GstPad* pad, GstPadProbeInfo* info, gpointer self);
+    static gboolean inject_error(gpointer element);
+    guint64 queued_frames() const;
+    void log_splice(guint64 discarded);
+    void wait_restart();
+    void restart_pipeline(gint64 detected_ns);
+    void restart_audio(gint64 detected_ns);
+    void finished(std::atomic<gint64>& since, const char* what);
+
+    GstElement* pipeline_ = nullptr;
+    GstElement* filesink_ = nullptr;
+    std::vector<GstElement*> video_queues_;
+    std::vector<GstElement*> audio_;
+    std::string splice_log_;
+    gint64 stall_ns_ = 0;
+
+    // Feeder hand-off while the pipeline is down
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::atomic<bool> restarting_{false};        // a pipeline restart is pending or running
+    bool audio_pending_ = false;
+    std::atomic<guint64> generation_{0};
+
+    // Stall detection (sink probe writes, watchdog reads)
+    std::atomic<gint64> last_sink_ns_{0};
+    std::atomic<guint64> pushed_at_sink_{0};     // frames_pushed when the last buffer reached filesink
+    gint64 pending_since_ns_ = 0;                // watchdog: since when frames are waiting for the sink
+
+    // Recovery timing: detection time until the first buffer after the restart, 0 = none
+    std::atomic<gint64> pipeline_since_ns_{0};
+    std::atomic<gint64> audio_since_ns_{0};
+    gint64 last_done_ns_ = 0;                    // when the previous restart completed
+    guint failures_ = 0;                         // consecutive quick re-failures, for the backoff
+
+    HealStats stats_;
+};
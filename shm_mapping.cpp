@@ -0,0 +1,88 @@
+#include "shm_mapping.h"
+
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool ShmMapping::map(const std::string& name, bool create, size_t bytes, bool writable) {
+    unmap();
+    if (create) writable = true;
+#ifdef _WIN32
+    std::string path = "Local\\" + name;
+    DWORD access = writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ;
+    HANDLE h = create
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                             static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                             static_cast<DWORD>(bytes & 0xffffffffu), path.c_str())
+        : OpenFileMappingA(access, FALSE, path.c_str());
+    if (!h) return false;
+    if (create && GetLastError() == ERROR_ALREADY_EXISTS) {
+        // Still mapped by another process: sizes may not match
+        CloseHandle(h);
+        return false;
+    }
+    void* p = MapViewOfFile(h, access, 0, 0, create ? bytes : 0);
+    if (!p) {
+        CloseHandle(h);
+        return false;
+    }
+    if (!create) {
+        MEMORY_BASIC_INFORMATION mbi;
+        bytes = VirtualQuery(p, &mbi, sizeof(mbi)) ? mbi.RegionSize : 0;
+    }
+    handle_ = h;
+#else
+    std::string path = "/" + name;
+    if (create) shm_unlink(path.c_str());   // a stale object from a crashed owner
+    int fd = create ? shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)
+                    : shm_open(path.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) return false;
+    if (create && ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+    if (!create) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        bytes = static_cast<size_t>(st.st_size);
+    }
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* p = bytes ? mmap(NULL, bytes, prot, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);   // the mapping keeps the object alive
+    if (p == MAP_FAILED) {
+        if (create) shm_unlink(path.c_str());
+        return false;
+    }
+#endif
+    addr_ = p;
+    bytes_ = bytes;
+    owner_ = create;
+    name_ = name;
+    return true;
+}
+
+void ShmMapping::unmap() {
+    if (!addr_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(addr_);
+    CloseHandle(static_cast<HANDLE>(handle_));
+    handle_ = nullptr;
+#else
+    munmap(addr_, bytes_);
+    if (owner_) shm_unlink(("/" + name_).c_str());
+#endif
+    addr_ = nullptr;
+    bytes_ = 0;
+    owner_ = false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// Named shared memory for the same-host rings (frame_ring.h in, video_ring.h out).
+// POSIX shm_open/mmap on Linux ("/<name>"), a named file mapping on Windows ("Local\<name>").
+
+#include <cstddef>
+#include <string>
+
+class ShmMapping {
+public:
+    ShmMapping() = default;
+    ~ShmMapping() { unmap(); }
+    ShmMapping(const ShmMapping&) = delete;
+    ShmMapping& operator=(const ShmMapping&) = delete;
+
+    // create: a fresh zeroed object of `bytes` (a stale one from a crashed owner is replaced).
+    // Otherwise map an existing object whole; read-only when !writable.
+    bool map(const std::string& name, bool create, size_t bytes, bool writable = true);
+    // Unmap; the creator also removes the name
+    void unmap();
+
+    void* data() const { return addr_; }
+    size_t size() const { return bytes_; }
+
+private:
+    void* addr_ = nullptr;
+    size_t bytes_ = 0;
+    bool owner_ = false;
+    std::string name_;
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#endif
+};
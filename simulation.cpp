@@ -0,0 +1,145 @@
+#include "simulation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<bool> virtual_clock{false};
+std::atomic<int64_t> skipped_ns{0};      // idle time the virtual clock jumped over
+
+size_t rss_first = 0, rss_max = 0, rss_last = 0;
+
+class ProcessClock : public PaceSource {
+public:
+    PaceClock::time_point now() override {
+        return PaceClock::now() + std::chrono::nanoseconds(skipped_ns.load(std::memory_order_relaxed));
+    }
+    void sleep_until(PaceClock::time_point t) override {
+        if (!pace_virtual()) {
+            std::this_thread::sleep_until(t);
+            return;
+        }
+        auto ahead = std::chrono::duration_cast<std::chrono::nanoseconds>(t - now()).count();
+        if (ahead > 0) skipped_ns.fetch_add(ahead, std::memory_order_relaxed);
+    }
+} process_clock;
+
+} // namespace
+
+PaceSource& pace_source() { return process_clock; }
+void pace_set_virtual(bool on) { virtual_clock = on; }
+bool pace_virtual() { return virtual_clock.load(std::memory_order_relaxed); }
+PaceClock::time_point pace_now() { return process_clock.now(); }
+void pace_sleep_until(PaceClock::time_point t) { process_clock.sleep_until(t); }
+void pace_sleep_for(PaceClock::duration d) { pace_sleep_until(pace_now() + d); }
+
+FramePacer::FramePacer(PaceSource& clock, unsigned fps) : clock_(clock), fps_(fps), start_(clock.now()) {}
+
+PaceSlot FramePacer::slot(uint64_t frame) {
+    PaceSlot s;
+    // frame * 1e9 / fps without overflow for any frame count a session reaches
+    uint64_t ns = frame / fps_ * 1000000000ull + frame % fps_ * 1000000000ull / fps_;
+    s.expected = start_ + std::chrono::nanoseconds(ns);
+    auto now = clock_.now();
+    s.early = now < s.expected;
+    if (!s.early) {
+        s.lateness_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - s.expected).count();
+        s.catching_up = s.lateness_ns >= static_cast<int64_t>(1000000000ull / fps_);
+    }
+    return s;
+}
+
+int64_t FramePacer::elapsed_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_.now() - start_).count();
+}
+
+size_t process_rss_bytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return pmc.WorkingSetSize;
+    return 0;
+#elif defined(__linux__)
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long pages_total = 0, pages_resident = 0;
+    int n = fscanf(f, "%lu %lu", &pages_total, &pages_resident);
+    fclose(f);
+    return n == 2 ? pages_resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+void sim_sample_rss() {
+    size_t rss = process_rss_bytes();
+    if (!rss_first) rss_first = rss;
+    rss_max = std::max(rss_max, rss);
+    rss_last = rss;
+}
+
+void sim_collect_rss(SimResult& r) {
+    r.rss_start = rss_first;
+    r.rss_peak = rss_max;
+    r.rss_end = rss_last;
+}
+
+bool sim_report(std::ostream& os, const SimResult& r, const SimBudget& b) {
+    const double MB = 1024.0 * 1024.0;
+    double rss_growth_mb = (static_cast<double>(r.rss_end) - static_cast<double>(r.rss_start)) / MB;
+    bool drift_ok = std::fabs(r.drift_ms) <= b.max_drift_ms;
+    bool skew_ok = !r.have_audio || std::fabs(r.av_skew_ms) <= b.max_av_skew_ms;
+    bool rss_ok = !r.rss_start || rss_growth_mb <= b.max_rss_growth_mb;
+    bool pts_ok = r.video_pts_regressions == 0 && r.audio_pts_regressions == 0;
+    bool alloc_ok = r.feeder_allocs <= b.max_steady_allocs && r.probe_allocs <= b.max_steady_allocs;
+    auto verdict = [](bool ok) { return ok ? "ok" : "FAIL"; };
+    char line[256];
+
+    os << "[sim] ===== simulated session report =====\n";
+    snprintf(line, sizeof(line), "[sim] simulated %.2f h in %.1f s wall (x%.0f), %llu frames\n",
+             r.simulated_s / 3600.0, r.wall_s, r.wall_s > 0 ? r.simulated_s / r.wall_s : 0.0,
+             static_cast<unsigned long long>(r.frames));
+    os << line;
+    snprintf(line, sizeof(line), "[sim] video PTS drift    %+.3f ms (budget %.1f) %s\n",
+             r.drift_ms, b.max_drift_ms, verdict(drift_ok));
+    os << line;
+    if (r.have_audio) {
+        snprintf(line, sizeof(line), "[sim] A/V skew at end   %+.3f ms (budget %.1f) %s\n",
+                 r.av_skew_ms, b.max_av_skew_ms, verdict(skew_ok));
+        os << line;
+    }
+    snprintf(line, sizeof(line), "[sim] PTS regressions   video %llu, audio %llu %s\n",
+             static_cast<unsigned long long>(r.video_pts_regressions),
+             static_cast<unsigned long long>(r.audio_pts_regressions), verdict(pts_ok));
+    os << line;
+    snprintf(line, sizeof(line), "[sim] steady heap allocs feeder %llu, probe %llu (budget %llu) %s\n",
+             static_cast<unsigned long long>(r.feeder_allocs), static_cast<unsigned long long>(r.probe_allocs),
+             static_cast<unsigned long long>(b.max_steady_allocs), verdict(alloc_ok));
+    os << line;
+    if (r.rss_start) {
+        snprintf(line, sizeof(line), "[sim] RSS %.1f -> %.1f MB (peak %.1f), growth %+.1f MB (budget %.1f) %s\n",
+                 r.rss_start / MB, r.rss_end / MB, r.rss_peak / MB, rss_growth_mb, b.max_rss_growth_mb,
+                 verdict(rss_ok));
+    } else {
+        snprintf(line, sizeof(line), "[sim] RSS not available on this platform\n");
+    }
+    os << line;
+    for (const auto& f : r.files) {
+        snprintf(line, sizeof(line), "[sim] %-28s %10.1f MB (%.1f bytes/frame)\n", f.first.c_str(),
+                 f.second / MB, r.frames ? static_cast<double>(f.second) / r.frames : 0.0);
+        os << line;
+    }
+    bool ok = drift_ok && skew_ok && rss_ok && pts_ok && alloc_ok;
+    os << "[sim] result: " << (ok ? "PASS" : "FAIL") << "\n";
+    return ok;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// --sim-hours: run a multi-hour session faster than real time.
+//
+// feed_frames paces itself with a FramePacer on a PaceSource. The process source is
+// the steady clock; with the virtual clock a sleep returns immediately and moves the
+// clock forward instead. Work still costs real time but the idle time between frames
+// costs nothing, so a 300 fps session runs as fast as the pipeline can take it while
+// every timestamp the feeder produces is the one a real-time run would have produced.
+// Tests drive the same FramePacer from a SimulatedClock, where work costs only what
+// the test says.
+
+using PaceClock = std::chrono::steady_clock;
+
+// Time source the pacing runs on
+class PaceSource {
+public:
+    virtual ~PaceSource() = default;
+    virtual PaceClock::time_point now() = 0;
+    virtual void sleep_until(PaceClock::time_point t) = 0;
+};
+
+// Fully simulated time: nothing passes unless slept over or advanced
+class SimulatedClock : public PaceSource {
+public:
+    PaceClock::time_point now() override { return t_; }
+    void sleep_until(PaceClock::time_point t) override { t_ = std::max(t_, t); }
+    void advance(PaceClock::duration d) { t_ += d; }   // work done on this clock
+
+private:
+    PaceClock::time_point t_{};
+};
+
+// The process clock: steady, or virtual after pace_set_virtual(true)
+PaceSource& pace_source();
+void pace_set_virtual(bool on);
+bool pace_virtual();
+PaceClock::time_point pace_now();
+void pace_sleep_until(PaceClock::time_point t);
+void pace_sleep_for(PaceClock::duration d);
+
+// Where frame n stands against its slot; slot times are exact nanoseconds from the
+// frame count, so the schedule cannot accumulate rounding drift
+struct PaceSlot {
+    PaceClock::time_point expected;
+    int64_t lateness_ns = 0;             // 0 when early
+    bool early = false;                  // wait() sleeps until expected
+    bool catching_up = false;            // at least one interval late: part of a catch-up burst
+};
+
+class FramePacer {
+public:
+    FramePacer(PaceSource& clock, unsigned fps);
+    PaceSlot slot(uint64_t frame);
+    void wait(const PaceSlot& s) { clock_.sleep_until(s.expected); }
+    // Time since the first slot: what do-timestamp would stamp on this clock
+    int64_t elapsed_ns() const;
+
+private:
+    PaceSource& clock_;
+    unsigned fps_;
+    PaceClock::time_point start_;
+};
+
+// Resident set size of this process in bytes, 0 if the platform does not tell us
+size_t process_rss_bytes();
+
+// What a simulated run is checked against
+struct SimBudget {
+    double max_drift_ms = 10.0;          // last video PTS vs frame count / fps
+    double max_av_skew_ms = 100.0;       // last video PTS vs last audio PTS (when audio runs)
+    double max_rss_growth_mb = 64.0;     // RSS at the end vs after the first simulated minute
+    uint64_t max_steady_allocs = 0;      // C++ heap allocations on the feeder/probe threads after warm-up
+};
+
+struct SimResult {
+    double simulated_s = 0;
+    double wall_s = 0;
+    uint64_t frames = 0;
+    double drift_ms = 0;
+    bool have_audio = false;
+    double av_skew_ms = 0;
+    size_t rss_start = 0, rss_peak = 0, rss_end = 0;
+    uint64_t video_pts_regressions = 0, audio_pts_regressions = 0;
+    uint64_t feeder_allocs = 0, probe_allocs = 0;
+    std::vector<std::pair<std::string, uint64_t>> files;   // output name, bytes
+};
+
+// Record RSS; the first call is the growth baseline
+void sim_sample_rss();
+// Fill in the RSS figures gathered by sim_sample_rss()
+void sim_collect_rss(SimResult& r);
+
+// Print the result and return true if it is within budget
+bool sim_report(std::ostream& os, const SimResult& r, const SimBudget& b);
@@ -0,0 +1,92 @@
+#include "startup_timeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+
+namespace {
+
+const char* const STEP_NAMES[STARTUP_STEPS] = {"gst_init", "redis", "index_scan", "pipeline",
+                                               "first_push", "first_byte", "audio"};
+
+const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+// ns since t0, -1 = not yet
+std::atomic<int64_t> begin_ns[STARTUP_STEPS];
+std::atomic<int64_t> end_ns[STARTUP_STEPS];
+
+struct Init {
+    Init() {
+        for (int i = 0; i < STARTUP_STEPS; ++i) {
+            begin_ns[i].store(-1, std::memory_order_relaxed);
+            end_ns[i].store(-1, std::memory_order_relaxed);
+        }
+    }
+} init;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void set_once(std::atomic<int64_t>& slot, int64_t t) {
+    int64_t unset = -1;
+    slot.compare_exchange_strong(unset, t, std::memory_order_relaxed);
+}
+
+std::string ms(int64_t ns) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.0f", ns / 1e6);
+    return buf;
+}
+
+} // namespace
+
+void startup_begin(StartupStep step) {
+    if (begin_ns[step].load(std::memory_order_relaxed) < 0) set_once(begin_ns[step], now_ns());
+}
+
+void startup_end(StartupStep step) {
+    if (end_ns[step].load(std::memory_order_relaxed) < 0) set_once(end_ns[step], now_ns());
+}
+
+void startup_mark(StartupStep step) {
+    if (end_ns[step].load(std::memory_order_relaxed) >= 0) return;
+    int64_t t = now_ns();
+    set_once(begin_ns[step], t);
+    set_once(end_ns[step], t);
+}
+
+double startup_ms(StartupStep step) {
+    int64_t t = end_ns[step].load(std::memory_order_relaxed);
+    return t < 0 ? -1.0 : t / 1e6;
+}
+
+void startup_report(std::ostream& os) {
+    int64_t push = end_ns[STARTUP_FIRST_PUSH].load(std::memory_order_relaxed);
+    int64_t byte = end_ns[STARTUP_FIRST_BYTE].load(std::memory_order_relaxed);
+    os << "[startup] First frame pushed at " << (push < 0 ? "-" : ms(push)) << " ms, on disk at "
+       << (byte < 0 ? "-" : ms(byte)) << " ms (target " << ms(static_cast<int64_t>(STARTUP_TARGET_MS * 1e6)) << " ms)";
+    const char* sep = ": ";
+    for (int i = STARTUP_GST_INIT; i <= STARTUP_PIPELINE; ++i) {
+        int64_t b = begin_ns[i].load(std::memory_order_relaxed);
+        int64_t e = end_ns[i].load(std::memory_order_relaxed);
+        if (b < 0) continue;
+        os << sep << STEP_NAMES[i] << " " << ms(b) << "-" << (e < 0 ? "?" : ms(e));
+        sep = ", ";
+    }
+    if (*sep == ',') os << " ms";
+    os << "\n";
+}
+
+void startup_collect(std::string& out, const std::string& labels) {
+    out += "# TYPE feeder_startup_seconds gauge\n";
+    for (int i = 0; i < STARTUP_STEPS; ++i) {
+        int64_t e = end_ns[i].load(std::memory_order_relaxed);
+        if (e < 0) continue;
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.6f", e / 1e9);
+        out += "feeder_startup_seconds{" + labels + ",step=\"" + STEP_NAMES[i] + "\"} " + buf + "\n";
+    }
+}
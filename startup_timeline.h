@@ -0,0 +1,40 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+// Startup breakdown: when each startup step began and ended, in ms since the process
+// started (static initialisation of this module), up to the first frame pushed into
+// appsrc and the first bytes reaching filesink.
+//
+// Steps may run on any thread and concurrently (gst_init, the Redis connect and the
+// index scan overlap); the first begin / end of a step is kept, later calls are no-ops,
+// so the milestone marks on the push path cost one relaxed load once they are set.
+
+enum StartupStep {
+    STARTUP_GST_INIT = 0,    // gst_init and loading the plugins the pipeline uses
+    STARTUP_REDIS,           // connect to the metadata store
+    STARTUP_INDEX_SCAN,      // find_first_index_fast over the frame folder
+    STARTUP_PIPELINE,        // element creation, linking, probes, up to PLAYING
+    STARTUP_FIRST_PUSH,      // first frame handed to appsrc
+    STARTUP_FIRST_BYTE,      // first TS bytes handed to filesink
+    STARTUP_AUDIO,           // live audio joined the mux
+    STARTUP_STEPS
+};
+
+// First frame on disk within this is the goal; the breakdown says which step missed it
+constexpr double STARTUP_TARGET_MS = 300.0;
+
+void startup_begin(StartupStep step);
+void startup_end(StartupStep step);
+// Milestone: begin and end at once
+void startup_mark(StartupStep step);
+
+// ms since start at which the step ended, < 0 = not yet
+double startup_ms(StartupStep step);
+
+// "[startup] First frame pushed at 142 ms, on disk at 151 ms (target 300 ms): gst_init 0-118,
+//  redis 0-2, index_scan 0-1, pipeline 118-131 ms"
+void startup_report(std::ostream& os);
+// feeder_startup_seconds{step=...} for every step that has ended
+void startup_collect(std::string& out, const std::string& labels);
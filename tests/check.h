@@ -0,0 +1,37 @@
+#pragma once
+
+// Minimal assertions for the ctest targets: no framework, so the tests build wherever
+// feeder_core does. A failed CHECK prints where and carries on; test_exit() turns the
+// count into the exit code.
+
+#include <cstdio>
+
+inline int& check_failures() {
+    static int n = 0;
+    return n;
+}
+
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++check_failures();                                                         \
+        }                                                                               \
+    } while (0)
+
+// a == b, printing both (integers)
+#define CHECK_EQ(a, b)                                                                  \
+    do {                                                                                \
+        long long va_ = static_cast<long long>(a), vb_ = static_cast<long long>(b);     \
+        if (va_ != vb_) {                                                               \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",      \
+                         __FILE__, __LINE__, #a, #b, va_, vb_);                         \
+            ++check_failures();                                                         \
+        }                                                                               \
+    } while (0)
+
+inline int test_exit(const char* name) {
+    if (check_failures()) std::fprintf(stderr, "[%s] %d check(s) failed\n", name, check_failures());
+    else std::printf("[%s] passed\n", name);
+    return check_failures() ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+// --cleanup: consumed frames go once they are `keep` behind the feeder, and a frame
+// that was absent at its first sweep (skipped, written late) is removed when it turns up.
+
+#include "frame_cleanup.h"
+#include "check.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const uint64_t FIRST = 1000;
+
+void write_frame(const fs::path& dir, uint64_t index) {
+    std::ofstream(dir / make_frame_filename("camera01", index), std::ios::binary) << "frame";
+}
+
+bool exists(const fs::path& dir, uint64_t index) {
+    return fs::exists(dir / make_frame_filename("camera01", index));
+}
+
+void settle() { std::this_thread::sleep_for(std::chrono::milliseconds(4 * FrameCleaner::CLEANUP_PERIOD_MS)); }
+
+} // namespace
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / "feeder_test_frame_cleanup";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    // FIRST + 5 is missing: the feeder skipped it
+    for (uint64_t i = FIRST; i < FIRST + 20; ++i) {
+        if (i != FIRST + 5) write_frame(dir, i);
+    }
+
+    FrameCleaner cleaner;
+    CHECK(cleaner.start(dir.string(), "camera01", FIRST, 2));
+    cleaner.consumed_below(FIRST + 20);
+    settle();
+    for (uint64_t i = FIRST; i < FIRST + 18; ++i) CHECK(!exists(dir, i));
+    CHECK(exists(dir, FIRST + 18) && exists(dir, FIRST + 19));   // keep window
+    CHECK_EQ(cleaner.removed(), 17);
+    CHECK_EQ(cleaner.absent(), 0);                               // still being retried
+
+    // The skipped frame arrives late and is retired on a later sweep
+    write_frame(dir, FIRST + 5);
+    settle();
+    CHECK(!exists(dir, FIRST + 5));
+    CHECK_EQ(cleaner.removed(), 18);
+    CHECK_EQ(cleaner.failed(), 0);
+    cleaner.stop();
+
+    fs::remove_all(dir);
+    return test_exit("frame_cleanup");
+}
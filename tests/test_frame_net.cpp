@@ -0,0 +1,159 @@
+// FrameReceiver over loopback: UDP fragments complete a frame only once each one has
+// arrived (a repeated fragment does not count twice), misaligned fragments are
+// malformed, bad ports are refused, TCP connections come and go, and the window follows
+// a sender that restarts at other indices.
+
+#include "frame_net.h"
+#include "check.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+int main() {
+    std::printf("[frame_net] skipped on Windows\n");
+    return 0;
+}
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+const unsigned short UDP_PORT = 19231;
+const unsigned short TCP_PORT = 19232;
+const unsigned short JUMP_PORT = 19233;
+
+// One datagram as FrameSender builds it, but with any offset and length
+void send_fragment(int fd, uint64_t index, const std::vector<uint8_t>& frame, size_t offset, size_t len) {
+    NetFrameHeader h{NET_FRAME_MAGIC, 0, index, 0, static_cast<uint32_t>(frame.size()), static_cast<uint32_t>(offset)};
+    std::vector<uint8_t> d(sizeof(h) + len);
+    memcpy(d.data(), &h, sizeof(h));
+    memcpy(d.data() + sizeof(h), frame.data() + offset, len);
+    send(fd, d.data(), d.size(), 0);
+}
+
+} // namespace
+
+int main() {
+    {
+        FrameReceiver rx;
+        CHECK(!rx.start("not-a-port", true));
+        CHECK(!rx.start("127.0.0.1:", false));
+        CHECK(!rx.start("127.0.0.1:70000", true));
+        CHECK(!rx.start("127.0.0.1:12ab", false));
+    }
+
+    {
+        FrameReceiver rx(16);
+        CHECK(rx.start("127.0.0.1:" + std::to_string(UDP_PORT), true));
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in sa{};
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons(UDP_PORT);
+        inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr);
+        CHECK(connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == 0);
+
+        // Three fragments: 60000 + 60000 + 30000 bytes
+        std::vector<uint8_t> frame(2 * NET_UDP_PAYLOAD + NET_UDP_PAYLOAD / 2);
+        for (size_t i = 0; i < frame.size(); ++i) frame[i] = static_cast<uint8_t>(i * 7);
+        // First and last twice add up to the frame size without the middle one
+        send_fragment(fd, 5, frame, 0, NET_UDP_PAYLOAD);
+        send_fragment(fd, 5, frame, 0, NET_UDP_PAYLOAD);
+        send_fragment(fd, 5, frame, 2 * NET_UDP_PAYLOAD, NET_UDP_PAYLOAD / 2);
+        NetFrame out;
+        CHECK(!rx.take(5, out, 200));
+
+        send_fragment(fd, 5, frame, NET_UDP_PAYLOAD, NET_UDP_PAYLOAD);
+        CHECK(rx.take(5, out, 1000));
+        CHECK_EQ(out.size, frame.size());
+        CHECK(out.data && memcmp(out.data, frame.data(), frame.size()) == 0);
+        free(out.data);
+        CHECK_EQ(rx.stats().frames.load(), 1);
+
+        // Not on a fragment boundary, or shorter than a whole fragment
+        send_fragment(fd, 6, frame, 100, 1000);
+        send_fragment(fd, 6, frame, 0, 1000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        CHECK_EQ(rx.stats().malformed.load(), 2);
+        close(fd);
+        rx.stop();
+    }
+
+    {
+        FrameReceiver rx(16);
+        CHECK(rx.start("127.0.0.1:" + std::to_string(TCP_PORT), false));
+        std::vector<uint8_t> frame(1000, 0x5a);
+        // One connection per frame, each closed again: finished threads are joined on the way
+        for (uint64_t i = 0; i < 8; ++i) {
+            FrameSender tx;
+            CHECK(tx.connect("127.0.0.1:" + std::to_string(TCP_PORT), false));
+            CHECK(tx.send(i, frame.data(), frame.size(), 0));
+        }
+        for (uint64_t i = 0; i < 8; ++i) {
+            NetFrame out;
+            CHECK(rx.take(i, out, 1000));
+            free(out.data);
+        }
+        CHECK_EQ(rx.stats().connections.load(), 8);
+        rx.stop();
+    }
+
+    {
+        FrameReceiver rx(64);
+        CHECK(rx.start("127.0.0.1:" + std::to_string(JUMP_PORT), false));
+        FrameSender tx;
+        CHECK(tx.connect("127.0.0.1:" + std::to_string(JUMP_PORT), false));
+        std::vector<uint8_t> frame(1000, 0x33);
+        auto send_run = [&](std::vector<uint64_t> indices) {
+            for (uint64_t i : indices) CHECK(tx.send(i, frame.data(), frame.size(), 0));
+        };
+        auto take_from = [&](uint64_t first, uint64_t end) {
+            for (uint64_t i = first; i < end; ++i) {
+                NetFrame out;
+                CHECK(rx.take(i, out, 1000));
+                free(out.data);
+            }
+        };
+
+        // Warm-up: 1000 arrives after 1003 and is still the first frame
+        send_run({1003, 1000, 1001, 1002, 1004, 1005, 1006, 1007, 1008, 1009});
+        uint64_t first = 0;
+        for (int i = 0; i < 100 && rx.stats().frames.load() < 10; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(rx.next_ready(0, first, 1000));
+        CHECK_EQ(first, 1000);
+        take_from(1000, 1010);
+        CHECK_EQ(rx.stats().late.load(), 0);
+        CHECK_EQ(rx.generation(), 0);
+
+        // Sender restarts far ahead: the first NET_REBASE_AFTER - 1 are overflow, then the window moves
+        std::vector<uint64_t> ahead;
+        for (uint64_t i = 50000; i < 50040; ++i) ahead.push_back(i);
+        send_run(ahead);
+        NetFrame stale;
+        CHECK(!rx.take(1010, stale, 500));
+        CHECK_EQ(rx.generation(), 1);
+        CHECK(rx.next_ready(0, first, 1000));
+        CHECK_EQ(first, 50000 + NET_REBASE_AFTER - 1);
+        take_from(first, 50040);
+
+        // ...and back to the start
+        std::vector<uint64_t> back;
+        for (uint64_t i = 10; i < 50; ++i) back.push_back(i);
+        send_run(back);
+        CHECK(!rx.take(50040, stale, 500));
+        CHECK_EQ(rx.generation(), 2);
+        CHECK(rx.next_ready(0, first, 1000));
+        CHECK_EQ(first, 10 + NET_REBASE_AFTER - 1);
+        take_from(first, 50);
+        CHECK_EQ(rx.stats().rebases.load(), 2);
+        rx.stop();
+    }
+    return test_exit("frame_net");
+}
+#endif
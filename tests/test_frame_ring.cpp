@@ -0,0 +1,194 @@
+// --shm-ring: a producer and the feeder on one ring. Slots wrap in order, a full ring
+// counts overruns until the oldest slot is released, a taken frame stays mapped after
+// the FrameRing is gone, and IN_USE slots are reclaimed only from a dead consumer
+// (or one whose pid now belongs to another process). A producer that recreates the
+// ring under the same name is noticed and the new ring re-opened.
+
+#include "frame_ring.h"
+#include "shm_mapping.h"
+#include "check.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+int main() {
+    std::printf("[frame_ring] skipped on Windows\n");
+    return 0;
+}
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const uint32_t SLOTS = 4;
+const uint32_t SLOT_SIZE = 4096;
+
+std::vector<uint8_t> frame_data(uint64_t index, size_t size) {
+    std::vector<uint8_t> d(size);
+    for (size_t i = 0; i < size; ++i) d[i] = static_cast<uint8_t>(index * 31 + i);
+    return d;
+}
+
+bool publish(FrameRing& ring, uint64_t index, size_t size = 1000) {
+    std::vector<uint8_t> d = frame_data(index, size);
+    return ring.publish(index, d.data(), d.size(), 0);
+}
+
+bool frame_ok(const FrameRingFrame& f, uint64_t index, size_t size = 1000) {
+    std::vector<uint8_t> d = frame_data(index, size);
+    return f.index == index && f.size == size && memcmp(f.data, d.data(), size) == 0;
+}
+
+// A pid that is certainly not running: a child that has exited and been reaped
+uint32_t dead_pid() {
+    pid_t child = fork();
+    if (child == 0) _exit(0);
+    waitpid(child, nullptr, 0);
+    return static_cast<uint32_t>(child);
+}
+
+FrameRingSlot* slot_header(ShmMapping& m, uint32_t slot) {
+    auto* h = static_cast<FrameRingHeader*>(m.data());
+    uint8_t* base = static_cast<uint8_t*>(m.data()) + sizeof(FrameRingHeader);
+    return reinterpret_cast<FrameRingSlot*>(base + slot * h->slot_stride);
+}
+
+} // namespace
+
+int main() {
+    const std::string name = "feeder_test_ring_" + std::to_string(getpid());
+    FrameRing producer;
+    CHECK(producer.create(name, SLOTS, SLOT_SIZE));
+    ShmMapping peek;   // the header and slot states as another process sees them
+    CHECK(peek.map(name, false, 0));
+    auto* hdr = static_cast<FrameRingHeader*>(peek.data());
+
+    {
+        FrameRing feeder;
+        CHECK(feeder.open(name));
+        CHECK_EQ(hdr->consumer_pid.load(), getpid());
+
+        // Wrap: three times around the ring, each frame in order and intact
+        for (uint64_t i = 0; i < SLOTS * 3; ++i) {
+            CHECK(publish(producer, 100 + i));
+            FrameRingFrame f;
+            CHECK(feeder.acquire(f, 100));
+            CHECK(frame_ok(f, 100 + i));
+            CHECK_EQ(f.slot, i % SLOTS);
+            feeder.release(f.slot);
+        }
+        FrameRingFrame none;
+        CHECK(!feeder.acquire(none, 10));
+
+        // Full: every slot taken, the next frame is an overrun until the oldest goes back
+        std::vector<FrameRingFrame> held(SLOTS);
+        for (uint32_t i = 0; i < SLOTS; ++i) {
+            CHECK(publish(producer, 200 + i));
+            CHECK(feeder.acquire(held[i], 100));
+        }
+        CHECK(!publish(producer, 204));
+        CHECK_EQ(producer.overruns(), 1);
+        CHECK(!publish(producer, 204, SLOT_SIZE + 1));   // too big for a slot
+        FrameRing::release_ref(held[1].ref);             // out of order: still full
+        CHECK(!publish(producer, 204));
+        FrameRing::release_ref(held[0].ref);
+        CHECK(publish(producer, 204));
+        FrameRingFrame f;
+        CHECK(feeder.acquire(f, 100));
+        CHECK(frame_ok(f, 204));
+        feeder.release(f.slot);
+        feeder.release(held[2].slot);
+
+        // A second feeder while this one runs is refused and leaves its slots alone
+        CHECK(publish(producer, 205));
+        CHECK(publish(producer, 206));
+        uint32_t live = static_cast<uint32_t>(getppid());
+        uint64_t own_start = hdr->consumer_start;
+        hdr->consumer_pid.store(live);
+        hdr->consumer_start = 0;   // unknown: the pid alone decides
+        FrameRing second;
+        CHECK(!second.open(name));
+        CHECK_EQ(second.busy_pid(), live);
+        CHECK_EQ(slot_header(peek, 3)->state.load(), FRAME_SLOT_IN_USE);   // held[3]
+        hdr->consumer_pid.store(static_cast<uint32_t>(getpid()));
+        hdr->consumer_start = own_start;
+
+        // Release after close: the taken frame keeps the mapping until its hold goes
+        CHECK(feeder.acquire(f, 100));
+        CHECK(frame_ok(f, 205));
+        feeder.close();
+        CHECK(!feeder.is_open());
+        CHECK(frame_ok(f, 205));
+        CHECK_EQ(hdr->consumer_pid.load(), getpid());   // still registered: slots are out
+        FrameRing::release_ref(f.ref);
+        FrameRing::release_ref(held[3].ref);
+        CHECK_EQ(hdr->consumer_pid.load(), 0);          // last hold gone
+    }
+
+    {
+        // A consumer that died with a slot IN_USE: the next feeder takes the ring over
+        FrameRing crashed;
+        CHECK(crashed.open(name));
+        FrameRingFrame f;
+        CHECK(crashed.acquire(f, 100));
+        CHECK(frame_ok(f, 206));
+        CHECK_EQ(slot_header(peek, f.slot)->state.load(), FRAME_SLOT_IN_USE);
+        hdr->consumer_pid.store(dead_pid());
+        hdr->consumer_start = 0;
+
+        FrameRing next;
+        CHECK(next.open(name));
+        CHECK_EQ(next.busy_pid(), 0);
+        CHECK_EQ(hdr->consumer_pid.load(), getpid());
+        CHECK_EQ(slot_header(peek, f.slot)->state.load(), FRAME_SLOT_FREE);
+        CHECK(publish(producer, 207));
+        FrameRingFrame g;
+        CHECK(next.acquire(g, 100));
+        CHECK(frame_ok(g, 207));
+        next.release(g.slot);
+        next.close();
+        FrameRing::release_ref(f.ref);   // the "dead" one's hold, so the test leaks nothing
+    }
+
+    {
+        // A running process with another start time only reused the consumer's pid
+        hdr->consumer_pid.store(static_cast<uint32_t>(getppid()));
+        hdr->consumer_start = 1;
+        FrameRing reused;
+        CHECK(reused.open(name));
+        CHECK_EQ(hdr->consumer_pid.load(), getpid());
+    }
+
+    peek.unmap();
+
+    {
+        // Producer restart: the feeder's mapping is orphaned and stays empty
+        FrameRing feeder;
+        CHECK(feeder.open(name));
+        CHECK(!feeder.replaced());
+        CHECK(publish(producer, 208));
+        FrameRingFrame f;
+        CHECK(feeder.acquire(f, 100));
+        CHECK(frame_ok(f, 208));
+        feeder.release(f.slot);
+        producer.close();
+        CHECK(!feeder.replaced());       // gone, not back yet
+        CHECK(producer.create(name, SLOTS, SLOT_SIZE));
+        CHECK(publish(producer, 1));
+        FrameRingFrame none;
+        CHECK(!feeder.acquire(none, 10));
+        CHECK(feeder.replaced());
+        CHECK(feeder.open(name));
+        CHECK(!feeder.replaced());
+        CHECK(feeder.acquire(f, 100));
+        CHECK(frame_ok(f, 1));
+        feeder.release(f.slot);
+    }
+
+    producer.close();
+    return test_exit("frame_ring");
+}
+#endif
@@ -0,0 +1,241 @@
+// --no-parse conformance: scan_hevc_au and parse_sps_dimensions over a fixture stream,
+// against expectations modelled on h265parse's behaviour for the same access units.
+//
+// The fixture is built here bit by bit (complete VPS/SPS/PPS with emulation prevention,
+// AUD, SEI and slice NALs) so it needs no sample files. The expected values follow
+// h265parse's handling of alignment=au input, not a captured run of it: one output
+// buffer per input AU (the feeder's file boundaries), DELTA_UNIT clear exactly on IRAP
+// pictures (NAL types 16-23, GST_H265_IS_NAL_TYPE_IRAP), and width/height in the caps
+// cropped by the conformance window. PTS are not part of it: both paths take them from appsrc and h265parse passes
+// them through unchanged for the intra-only stream the feeder pushes.
+
+#include "feeder_core.h"
+#include "check.h"
+
+#include <vector>
+
+namespace {
+
+// Writes an RBSP MSB first; nal() adds the start code and emulation prevention
+struct BitWriter {
+    std::vector<uint8_t> bytes;
+    int bit = 0;
+
+    void u(uint32_t v, int n) {
+        while (n--) {
+            if (bit == 0) bytes.push_back(0);
+            bytes.back() |= static_cast<uint8_t>(((v >> n) & 1) << (7 - bit));
+            bit = (bit + 1) % 8;
+        }
+    }
+    void ue(uint32_t v) {
+        int len = 0;
+        while ((v + 1) >> (len + 1)) ++len;
+        u(0, len);
+        u(v + 1, len + 1);
+    }
+    void trailing() {
+        u(1, 1);
+        while (bit) u(0, 1);
+    }
+};
+
+void nal(std::vector<uint8_t>& out, uint8_t type, const std::vector<uint8_t>& rbsp, bool long_sc) {
+    if (long_sc) out.push_back(0);
+    out.insert(out.end(), {0, 0, 1, static_cast<uint8_t>(type << 1), 1});
+    int zeros = 0;
+    for (uint8_t b : rbsp) {
+        if (zeros >= 2 && b <= 3) {
+            out.push_back(3);
+            zeros = 0;
+        }
+        out.push_back(b);
+        zeros = b == 0 ? zeros + 1 : 0;
+    }
+}
+
+void profile_tier_level(BitWriter& w) {
+    w.u(0, 2); w.u(0, 1); w.u(1, 5);       // Main profile
+    w.u(0x60000000, 32);                    // compatible with Main, Main 10
+    w.u(0x9, 4);                            // progressive, frame only
+    w.u(0, 32); w.u(0, 12);                 // reserved: a zero run that needs emulation prevention
+    w.u(120, 8);                            // level 4.0
+}
+
+std::vector<uint8_t> vps() {
+    BitWriter w;
+    w.u(0, 4); w.u(1, 1); w.u(1, 1); w.u(0, 6); w.u(0, 3); w.u(1, 1); w.u(0xffff, 16);
+    profile_tier_level(w);
+    w.u(1, 1); w.ue(4); w.ue(0); w.ue(0);   // sub-layer ordering info
+    w.u(0, 6); w.ue(0); w.u(0, 1); w.u(0, 1);
+    w.trailing();
+    return w.bytes;
+}
+
+// Complete SPS; crop_bottom in luma rows (4:2:0, so the window offset is half of it)
+std::vector<uint8_t> sps(uint32_t width, uint32_t coded_height, uint32_t crop_bottom) {
+    BitWriter w;
+    w.u(0, 4); w.u(0, 3); w.u(1, 1);
+    profile_tier_level(w);
+    w.ue(0);                                // sps_seq_parameter_set_id
+    w.ue(1);                                // chroma_format_idc 4:2:0
+    w.ue(width); w.ue(coded_height);
+    w.u(crop_bottom ? 1 : 0, 1);
+    if (crop_bottom) { w.ue(0); w.ue(0); w.ue(0); w.ue(crop_bottom / 2); }
+    w.ue(0); w.ue(0);                       // bit depth 8
+    w.ue(4);                                // log2_max_pic_order_cnt_lsb_minus4
+    w.u(1, 1); w.ue(4); w.ue(0); w.ue(0);
+    w.ue(0); w.ue(3); w.ue(0); w.ue(3); w.ue(0); w.ue(0);
+    w.u(0, 1); w.u(0, 1); w.u(0, 1); w.u(0, 1);   // scaling list, AMP, SAO, PCM
+    w.ue(0); w.u(0, 1); w.u(0, 1); w.u(0, 1);     // no ref pic sets, long-term, TMVP, smoothing
+    w.u(0, 1); w.u(0, 1);                   // no VUI, no extension
+    w.trailing();
+    return w.bytes;
+}
+
+std::vector<uint8_t> pps() {
+    BitWriter w;
+    w.ue(0); w.ue(0); w.u(0, 1); w.u(0, 1); w.u(0, 3); w.u(0, 1); w.u(0, 1);
+    w.ue(0); w.ue(0); w.ue(0);              // ref idx defaults, init_qp 26
+    w.u(0, 1); w.u(0, 1); w.u(0, 1);        // constrained intra, transform skip, cu qp delta
+    w.ue(0); w.ue(0);
+    for (int i = 0; i < 6; ++i) w.u(0, 1);
+    w.u(0, 1); w.u(0, 1); w.u(0, 1); w.u(0, 1); w.ue(0); w.u(0, 1); w.u(0, 1);
+    w.trailing();
+    return w.bytes;
+}
+
+// Slice NAL: header bits plus payload standing in for the CABAC data
+std::vector<uint8_t> slice(uint8_t type) {
+    BitWriter w;
+    w.u(1, 1);                              // first_slice_segment_in_pic_flag
+    if (type >= 16 && type <= 23) w.u(0, 1);
+    w.ue(0); w.ue(type >= 16 && type <= 23 ? 2 : 1);
+    w.trailing();
+    for (int i = 0; i < 600; ++i) w.bytes.push_back(static_cast<uint8_t>(0x80 | (i * 37)));
+    return w.bytes;
+}
+
+struct FixtureAu {
+    std::vector<uint8_t> data;
+    bool keyframe;                          // h265parse: DELTA_UNIT clear
+    bool params;                            // VPS/SPS/PPS in band
+    int width, height;                      // h265parse caps (params only)
+    NalSpan vps, sps, pps;
+};
+
+FixtureAu make_au(uint8_t slice_type, bool params, bool long_sc, uint32_t w, uint32_t coded_h, uint32_t crop,
+                  bool aud = false, bool sei = false, size_t trailing_zeros = 0) {
+    FixtureAu au{{}, slice_type >= 16 && slice_type <= 23, params, 0, 0, {}, {}, {}};
+    if (aud) nal(au.data, 35, {0x50}, long_sc);
+    if (params) {
+        size_t at = au.data.size();
+        nal(au.data, 32, vps(), long_sc);
+        au.vps = {at, au.data.size() - at};
+        at = au.data.size();
+        nal(au.data, 33, sps(w, coded_h, crop), long_sc);
+        au.sps = {at, au.data.size() - at};
+        at = au.data.size();
+        nal(au.data, 34, pps(), long_sc);
+        au.pps = {at, au.data.size() - at};
+        au.width = static_cast<int>(w);
+        au.height = static_cast<int>(coded_h - crop);
+    }
+    if (sei) nal(au.data, 39, {0x05, 0x02, 0x11, 0x22, 0x80}, long_sc);
+    nal(au.data, slice_type, slice(slice_type), long_sc);
+    au.data.insert(au.data.end(), trailing_zeros, 0);
+    return au;
+}
+
+bool same(const NalSpan& a, const NalSpan& b) { return a.offset == b.offset && a.size == b.size; }
+
+} // namespace
+
+int main() {
+    // A GOP as the feeder sees it: one AU per frame file
+    std::vector<FixtureAu> stream = {
+        make_au(19, true, true, 1920, 1088, 8, true, true),   // IDR_W_RADL, AUD + headers + SEI
+        make_au(1, false, false, 0, 0, 0),                   // TRAIL_R, 3-byte start codes
+        make_au(0, false, false, 0, 0, 0),                   // TRAIL_N (type 0)
+        make_au(8, false, false, 0, 0, 0),                   // RASL_N
+        make_au(21, false, true, 0, 0, 0),                   // CRA without in-band headers
+        make_au(20, true, false, 1920, 1088, 8, false, false, 2),  // IDR_N_LP, trailing_zero_8bits
+        make_au(16, true, true, 3840, 2160, 0),              // BLA_W_LP, resolution change, no cropping
+        make_au(22, false, true, 0, 0, 0),                   // reserved IRAP type
+    };
+
+    for (size_t i = 0; i < stream.size(); ++i) {
+        const FixtureAu& f = stream[i];
+        AuInfo au = scan_hevc_au(f.data.data(), f.data.size());
+        CHECK(au.found_vcl);
+        CHECK_EQ(au.keyframe, f.keyframe);
+        CHECK_EQ(au.vps.size && au.sps.size && au.pps.size, f.params);
+        if (f.params) {
+            CHECK(same(au.vps, f.vps));
+            CHECK(same(au.sps, f.sps));
+            CHECK(same(au.pps, f.pps));
+            int w = 0, h = 0;
+            CHECK(parse_sps_dimensions(f.data.data() + au.sps.offset, au.sps.size, w, h));
+            CHECK_EQ(w, f.width);
+            CHECK_EQ(h, f.height);
+        }
+        if (check_failures()) std::fprintf(stderr, "  (fixture AU %zu)\n", i);
+    }
+
+    // AU boundaries: the whole stream split at the feeder's file boundaries rebuilds the
+    // same bytes, and no AU carries a second picture
+    size_t total = 0, pictures = 0;
+    for (const FixtureAu& f : stream) {
+        total += f.data.size();
+        for (size_t p = 0; p + 4 < f.data.size(); ++p) {
+            if (f.data[p] == 0 && f.data[p + 1] == 0 && f.data[p + 2] == 1 && ((f.data[p + 3] >> 1) & 0x3f) < 32 &&
+                (f.data[p + 5] & 0x80)) {
+                ++pictures;
+            }
+        }
+    }
+    CHECK_EQ(pictures, stream.size());
+    CHECK(total > 0);
+
+    // Malformed input is rejected, not read past
+    {
+        std::vector<uint8_t> none = {0, 0, 1};
+        CHECK(!scan_hevc_au(none.data(), none.size()).found_vcl);
+        CHECK(!scan_hevc_au(nullptr, 0).found_vcl);
+        const FixtureAu& f = stream[0];
+        int w = 0, h = 0;
+        for (size_t cut = 4; cut < f.sps.size; ++cut) {
+            // A truncated SPS either fails or (cut after the size fields) still parses
+            if (parse_sps_dimensions(f.data.data() + f.sps.offset, cut, w, h)) CHECK(w == 1920);
+        }
+        // Exp-Golomb prefix of 32+ zero bits: rejected (was 1u << 32)
+        // (header, profile_tier_level and level all ones, sps_id 0, then ~100 zero bits)
+        std::vector<uint8_t> zeros_sps = {0, 0, 0, 1, 0x42, 0x01, 0x01};
+        zeros_sps.insert(zeros_sps.end(), 12, 0xff);
+        zeros_sps.push_back(0x80);
+        for (int i = 0; i < 6; ++i) zeros_sps.insert(zeros_sps.end(), {0, 0, 3});
+        zeros_sps.insert(zeros_sps.end(), 8, 0xff);
+        CHECK(!parse_sps_dimensions(zeros_sps.data(), zeros_sps.size(), w, h));
+    }
+
+    // --crc integrity: every fixture AU ends cleanly (the IDR_N_LP one with 2 legal
+    // trailing zeros); a zero-filled tail or a NAL cut after its header does not
+    for (const FixtureAu& f : stream) CHECK(hevc_au_tail(f.data.data(), f.data.size()) == AU_TAIL_OK);
+    {
+        std::vector<uint8_t> au = stream[1].data;
+        au.insert(au.end(), 4096, 0);                          // preallocated, not yet written
+        CHECK(hevc_au_tail(au.data(), au.size()) == AU_TAIL_ZERO_FILLED);
+        au = stream[1].data;
+        au.insert(au.end(), {0, 0, 1, 0x02, 0x01});            // TRAIL_R header, no payload
+        CHECK(hevc_au_tail(au.data(), au.size()) == AU_TAIL_CUT_NAL);
+        au.resize(au.size() - 2);                              // cut inside the start code's NAL header
+        CHECK(hevc_au_tail(au.data(), au.size()) == AU_TAIL_CUT_NAL);
+        au = stream[1].data;
+        au.insert(au.end(), {0, 0, 1, 0x48, 0x01});            // end of sequence: header only, fine
+        CHECK(hevc_au_tail(au.data(), au.size()) == AU_TAIL_OK);
+        std::vector<uint8_t> zeros(16, 0);
+        CHECK(hevc_au_tail(zeros.data(), zeros.size()) == AU_TAIL_ZERO_FILLED);
+    }
+
+    return test_exit("hevc_au");
+}
@@ -0,0 +1,153 @@
+// A --sim-hours session on a SimulatedClock: 7 hours at 300 fps through the feeder's
+// per-frame path (frame file read, metadata parse, PTS stamp, CSV rows) from a
+// synthetic frame folder, with modelled per-frame work and periodic stalls. Drift and
+// PTS order come from the PTS_90k written into the CSV rows, checked against the
+// --sim-hours budget along with the RSS growth of the process doing the work.
+
+#include "simulation.h"
+#include "feeder_core.h"
+#include "check.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const unsigned FPS = 300;
+const uint64_t FRAMES = 7ull * 3600 * FPS;
+const uint64_t FIRST_INDEX = 2379000;
+const int FILES = 16;
+const uint64_t STALL_EVERY = 30000;                       // ~100 s
+const auto STALL = std::chrono::milliseconds(250);        // a disk hiccup: catch-up burst after
+
+// Deterministic "random" work, 0.2 to 1.2 ms
+uint32_t lcg = 12345;
+std::chrono::microseconds read_cost() {
+    lcg = lcg * 1664525u + 1013904223u;
+    return std::chrono::microseconds(200 + (lcg >> 8) % 1000);
+}
+
+// Metadata as DragonflyDB returns it for one delivery
+std::string metadata_json(int ball, size_t size) {
+    return "{\"ball\":\"" + std::to_string(1 + ball % 6) + "\",\"frame_name\":\"frame_" + std::to_string(ball) +
+           "\",\"innings\":\"" + std::to_string(1 + ball / 300) + "\",\"isStart\":\"" + (ball % 6 == 0 ? "true" : "false") +
+           "\",\"matchID\":\"m42\",\"over\":\"" + std::to_string(1 + ball / 6 % 50) + "\",\"size\":\"" +
+           std::to_string(size) + "\"}";
+}
+
+// PTS_90k column of a video CSV row
+uint64_t row_pts_90k(const std::string& row) {
+    size_t a = row.find(',');
+    return std::stoull(row.substr(a + 1, row.find(',', a + 1) - a - 1));
+}
+
+} // namespace
+
+int main() {
+    // Slot times are exact at any frame count (floor(n * 1e9 / fps))
+    {
+        SimulatedClock clock;
+        FramePacer pacer(clock, FPS);
+        CHECK_EQ((pacer.slot(1).expected - clock.now()).count(), 3333333);
+        CHECK_EQ((pacer.slot(3600 * FPS).expected - clock.now()).count(), 3600ll * 1000000000ll);
+        uint64_t far = 40ull * 24 * 3600 * FPS + 7;       // 40 days in
+        CHECK_EQ((pacer.slot(far).expected - clock.now()).count(), 40ll * 24 * 3600 * 1000000000ll + 23333333);
+        CHECK(pacer.slot(0).lateness_ns == 0 && !pacer.slot(0).early && !pacer.slot(0).catching_up);
+        CHECK(pacer.slot(1).early);
+    }
+
+    // The folder --sim-hours cycles through, and one delivery's metadata per 6 s
+    fs::path dir = fs::temp_directory_path() / "feeder_test_sim_pacing";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::vector<std::string> sim_frames;
+    for (int f = 0; f < FILES; ++f) {
+        fs::path p = dir / make_frame_filename("camera01", FIRST_INDEX + f);
+        std::ofstream(p, std::ios::binary) << std::string(4096 + f * 100, static_cast<char>('a' + f));
+        sim_frames.push_back(p.string());
+    }
+    std::vector<std::string> jsons;
+    for (int ball = 0; ball < 600; ++ball) jsons.push_back(metadata_json(ball, 0));
+
+    SimulatedClock clock;
+    FramePacer pacer(clock, FPS);
+    FramePathTemplate frame_paths(dir.string(), "camera01");
+    std::vector<uint8_t> buffer(64 * 1024);
+    FrameMetadata md;
+    std::string prev_ball, prev_over, prev_innings;
+    std::ostringstream row, summary;
+    SimResult r;
+    uint64_t last_pts_90k = 0, early = 0, summary_rows = 0, read_errors = 0, bursts = 0;
+    int64_t max_lateness_ns = 0;
+    auto wall_start = std::chrono::steady_clock::now();
+    sim_sample_rss();
+    for (uint64_t frame = 0; frame < FRAMES; ++frame) {
+        // As feed_frames: sleep when early, then read, stamp, push
+        PaceSlot slot = pacer.slot(frame);
+        if (slot.early) pacer.wait(slot);
+        if (slot.catching_up) ++bursts;
+        max_lateness_ns = std::max(max_lateness_ns, slot.lateness_ns);
+
+        uint64_t index = FIRST_INDEX + frame;
+        frame_paths.at(index);
+        std::string_view fname = frame_paths.name();
+        size_t size = 0;
+        if (read_frame_into(sim_frames[frame % FILES].c_str(), buffer.data(), buffer.size(), size) != FRAME_READ_OK)
+            ++read_errors;
+        clock.advance(read_cost());
+        if (frame && frame % STALL_EVERY == 0) clock.advance(STALL);
+        // What do-timestamp would stamp, on the simulated clock
+        int64_t pts = pacer.elapsed_ns();
+        clock.advance(std::chrono::microseconds(300));     // push
+
+        // The probe: metadata, 90 kHz PTS, the CSV rows
+        md.reset();
+        parse_frame_metadata(jsons[frame / (6 * FPS) % jsons.size()], md);
+        uint64_t pts_90k = static_cast<uint64_t>(pts) * 90000 / 1000000000;
+        row.str(std::string());
+        write_video_csv_row(row, frame, true, pts_90k, fname, md);
+        if (md.ball != prev_ball || md.over != prev_over || md.innings != prev_innings) {
+            summary.str(std::string());
+            write_summary_csv_row(summary, frame, pts_90k, md);
+            ++summary_rows;
+            prev_ball = md.ball;
+            prev_over = md.over;
+            prev_innings = md.innings;
+        }
+
+        // Checked from what was written
+        uint64_t written = row_pts_90k(row.str());
+        if (frame && written <= last_pts_90k) ++r.video_pts_regressions;
+        if (written < frame * 90000 / FPS) ++early;
+        last_pts_90k = written;
+
+        // RSS once per simulated minute; the first sample is the growth baseline
+        if ((frame + 1) % (FPS * 60) == 0) sim_sample_rss();
+    }
+    sim_sample_rss();
+
+    r.frames = FRAMES;
+    r.simulated_s = static_cast<double>(FRAMES) / FPS;
+    r.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    r.drift_ms = (static_cast<double>(last_pts_90k) - (FRAMES - 1) * 90000.0 / FPS) / 90.0;
+    sim_collect_rss(r);
+    CHECK(sim_report(std::cout, r, SimBudget{}));
+
+    CHECK_EQ(read_errors, 0);
+    CHECK_EQ(early, 0);
+    CHECK_EQ(summary_rows, FRAMES / (6 * FPS));
+    CHECK(row.str().find("," + make_frame_filename("camera01", FIRST_INDEX + FRAMES - 1) + ",") != std::string::npos);
+    // The stalls were caught up again: late frames only right after each one
+    CHECK(bursts > 0);
+    CHECK(bursts < FRAMES / STALL_EVERY * 200);
+    CHECK(max_lateness_ns < 300000000);
+
+    fs::remove_all(dir);
+    return test_exit("sim_pacing");
+}
@@ -0,0 +1,100 @@
+// The per-frame helpers the feeder thread and the video probe call must not touch the
+// heap once warmed up: linked with alloc_count.cpp, which counts every operator new on
+// this thread, including the aligned overloads.
+
+#include "alloc_count.h"
+#include "feeder_core.h"
+#include "check.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const uint64_t FIRST_INDEX = 2379000;
+const int FILES = 8;
+const int WARMUP_FRAMES = 100;
+const int FRAMES = 20000;
+
+void* volatile escape;   // see the overload check at the end
+
+// Metadata as DragonflyDB returns it; values vary in length across frames
+std::string metadata_json(int i) {
+    return "{\"ball\":\"" + std::to_string(1 + i % 6) + "\",\"frame_name\":\"frame_" + std::to_string(i) +
+           "\",\"innings\":\"1\",\"isStart\":\"" + (i % 6 == 0 ? "true" : "false") + "\",\"matchID\":\"m" +
+           std::to_string(i % 100) + "\",\"over\":\"" + std::to_string(i % 50) + "\",\"ptp_timestamp\":\"" +
+           std::to_string(1700000000000ULL + i) + "\",\"received_at\":\"" + std::to_string(i * 7) + "\"}";
+}
+
+} // namespace
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / "feeder_test_steady_allocs";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    for (int f = 0; f < FILES; ++f) {
+        std::ofstream out(dir / make_frame_filename("camera01", FIRST_INDEX + f), std::ios::binary);
+        out << std::string(40 * 1024 + f * 1000, static_cast<char>('a' + f));
+    }
+    // Built before counting: the probe gets its JSON from hiredis, not from operator new
+    std::vector<std::string> jsons;
+    for (int i = 0; i < 64; ++i) jsons.push_back(metadata_json(i));
+    std::vector<uint8_t> buffer(512 * 1024);
+
+    FramePathTemplate paths(dir.string(), "camera01");
+    FrameMetadata md;
+    // The probe's CSV files, opened once and flushed per row as it does
+    std::ofstream csv(dir / "out.csv"), summary(dir / "summary.csv");
+    std::string prev_ball, prev_over, prev_innings;
+    size_t bytes = 0;
+    uint64_t base = 0;
+    for (int i = 0; i < WARMUP_FRAMES + FRAMES; ++i) {
+        if (i == WARMUP_FRAMES) base = thread_alloc_count();
+        const std::string& path = paths.at(FIRST_INDEX + i % FILES);
+        size_t size = 0;
+        CHECK(read_frame_into(path.c_str(), buffer.data(), buffer.size(), size) == FRAME_READ_OK);
+        bytes += size;
+        const std::string& json = jsons[i % jsons.size()];
+        md.reset();
+        parse_frame_metadata(json, md);
+        CHECK(json_value(json, "isStart") == md.isStart);
+        uint64_t pts_90k = static_cast<uint64_t>(i) * 300;
+        write_video_csv_row(csv, i, true, pts_90k, paths.name(), md);
+        csv.flush();
+        if (md.ball != prev_ball || md.over != prev_over || md.innings != prev_innings) {
+            write_summary_csv_row(summary, i, pts_90k, md);
+            summary.flush();
+            prev_ball = md.ball;
+            prev_over = md.over;
+            prev_innings = md.innings;
+        }
+    }
+    CHECK(csv.good() && summary.good());
+    uint64_t allocs = thread_alloc_count() - base;
+    std::printf("%d frames (%zu MB) after warm-up: %llu heap allocations\n", FRAMES, bytes >> 20,
+                static_cast<unsigned long long>(allocs));
+    CHECK_EQ(allocs, 0);
+
+    // The hook sees every overload, so a zero above is not a blind spot. The pointers
+    // escape through a volatile so the optimiser cannot elide the new/delete pairs.
+    struct alignas(64) Line { char c[64]; };
+    base = thread_alloc_count();
+    Line* one = new Line;
+    escape = one;
+    Line* two = new Line[2];
+    escape = two;
+    std::string* str = new std::string(100, 'x');
+    escape = str;
+    CHECK_EQ(thread_alloc_count() - base, 4);
+    CHECK_EQ(reinterpret_cast<uintptr_t>(one) % 64, 0);
+    delete one;
+    delete[] two;
+    delete str;
+
+    fs::remove_all(dir);
+    return test_exit("steady_allocs");
+}
@@ -0,0 +1,144 @@
+#include "thumbnails.h"
+
+#include "feeder_core.h"
+#include "metrics.h"
+
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+bool Thumbnailer::start(const std::string& folder, const std::string& camera, guint every, guint width,
+                        guint workers, bool webp, ParamSetCache& param_sets) {
+    stop();
+    param_sets_ = &param_sets;
+    std::error_code ec;
+    fs::create_directories(folder, ec);
+    if (ec) {
+        std::cerr << "[thumbs] Cannot create " << folder << ": " << ec.message() << "\n";
+        return false;
+    }
+    folder_ = folder;
+    camera_ = camera;
+    ext_ = webp ? ".webp" : ".jpg";
+    every_ = every;
+    next_due_ = 0;
+    pending_ball_ = false;
+    stopping_ = false;
+    head_ = count_ = 0;
+    queue_.assign(std::max<guint>(1, workers) * 2, Job{nullptr, 0});
+
+    // max-threads=1: the pool is the parallelism, one decoder must not take every core
+    std::string desc =
+        "appsrc name=src format=time caps=video/x-h265,stream-format=byte-stream,alignment=au"
+        " ! h265parse ! avdec_h265 max-threads=1 ! videoscale ! videoconvert"
+        " ! video/x-raw,width=" + std::to_string(width) + ",pixel-aspect-ratio=1/1"
+        " ! " + (webp ? "webpenc quality=75" : "jpegenc quality=80") +
+        " ! appsink name=sink sync=false max-buffers=1";
+    workers_.resize(std::max<guint>(1, workers));
+    for (Worker& w : workers_) {
+        GError* err = nullptr;
+        w.pipeline = gst_parse_launch(desc.c_str(), &err);
+        if (!w.pipeline || err) {
+            std::cerr << "[thumbs] Cannot build the decode pipeline: " << (err ? err->message : "?") << "\n";
+            if (err) g_error_free(err);
+            stop();
+            return false;
+        }
+        w.src = gst_bin_get_by_name(GST_BIN(w.pipeline), "src");
+        w.sink = gst_bin_get_by_name(GST_BIN(w.pipeline), "sink");
+        gst_element_set_state(w.pipeline, GST_STATE_PLAYING);
+    }
+    for (Worker& w : workers_) w.thread = std::thread(&Thumbnailer::run, this, std::ref(w));
+    return true;
+}
+
+void Thumbnailer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stopping_ = true;
+        for (; count_; --count_, head_ = (head_ + 1) % queue_.size()) gst_buffer_unref(queue_[head_].buffer);
+    }
+    cv_.notify_all();
+    for (Worker& w : workers_) {
+        if (w.thread.joinable()) w.thread.join();
+        if (w.pipeline) gst_element_set_state(w.pipeline, GST_STATE_NULL);
+        if (w.src) gst_object_unref(w.src);
+        if (w.sink) gst_object_unref(w.sink);
+        if (w.pipeline) gst_object_unref(w.pipeline);
+    }
+    workers_.clear();
+}
+
+void Thumbnailer::offer(GstBuffer* buffer, guint64 index, bool ball_changed) {
+    if (workers_.empty()) return;
+    if (ball_changed) pending_ball_ = true;
+    bool due = pending_ball_ || (every_ && index >= next_due_);
+    // Only keyframes decode on their own; a due thumbnail waits for the next one
+    if (!due || GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) return;
+    pending_ball_ = false;
+    if (every_) next_due_ = index + every_;
+
+    std::unique_lock<std::mutex> lock(mu_, std::try_to_lock);
+    if (!lock.owns_lock() || count_ == queue_.size()) {
+        metric_inc(stats_.dropped);
+        return;
+    }
+    queue_[(head_ + count_) % queue_.size()] = Job{gst_buffer_ref(buffer), index};
+    ++count_;
+    lock.unlock();
+    cv_.notify_one();
+}
+
+void Thumbnailer::run(Worker& w) {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            cv_.wait(lock, [this] { return stopping_ || count_; });
+            if (stopping_) return;
+            job = queue_[head_];
+            head_ = (head_ + 1) % queue_.size();
+            --count_;
+        }
+        metric_inc(encode(w, job) ? stats_.written : stats_.failed);
+        gst_buffer_unref(job.buffer);
+    }
+}
+
+bool Thumbnailer::encode(Worker& w, const Job& job) {
+    GstBuffer* au = param_sets_->decodable(job.buffer);
+    if (!au) return false;
+    // EOS makes the decoder give up the frame instead of holding it for reordering;
+    // READY -> PLAYING afterwards re-arms the pipeline for the next keyframe
+    gst_app_src_push_buffer(GST_APP_SRC(w.src), au);
+    gst_app_src_end_of_stream(GST_APP_SRC(w.src));
+    GstSample* sample = gst_app_sink_try_pull_sample(GST_APP_SINK(w.sink), 2 * GST_SECOND);
+    bool ok = false;
+    if (sample) {
+        GstMapInfo map;
+        GstBuffer* img = gst_sample_get_buffer(sample);
+        if (img && gst_buffer_map(img, &map, GST_MAP_READ)) {
+            // Written under a temporary name so the preview never shows half a file
+            fs::path dst = fs::path(folder_) / ("thumb_" + camera_ + "_" + std::to_string(job.index) + ext_);
+            fs::path tmp = dst;
+            tmp += ".tmp";
+            {
+                std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+                f.write(reinterpret_cast<const char*>(map.data), static_cast<std::streamsize>(map.size));
+                ok = f.good();
+            }
+            gst_buffer_unmap(img, &map);
+            std::error_code ec;
+            if (ok) fs::rename(tmp, dst, ec);
+            ok = ok && !ec;
+        }
+        gst_sample_unref(sample);
+    }
+    gst_element_set_state(w.pipeline, GST_STATE_READY);
+    gst_element_set_state(w.pipeline, GST_STATE_PLAYING);
+    return ok;
+}
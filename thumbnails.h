@@ -0,0 +1,78 @@
+#pragma once
+
+#include <gst/gst.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "param_sets.h"
+
+// --thumbnails: keyframe thumbnails for the operator preview strip.
+//
+// video_probe offers every buffer; every N frames, and on the next keyframe after a
+// ball change, the buffer is queued by reference (no copy) for a small pool of worker
+// threads. Each worker owns a private CPU-only pipeline
+//   appsrc ! h265parse ! avdec_h265 ! videoscale ! videoconvert ! jpegenc|webpenc ! appsink
+// decodes the keyframe, scales it to the thumbnail width and writes
+// <folder>/thumb_<camera>_<index>.jpg (or .webp). offer() never waits: when the queue
+// is full or a worker holds its lock, the thumbnail is dropped and counted.
+
+struct ThumbnailStats {
+    std::atomic<guint64> written{0};
+    std::atomic<guint64> dropped{0};     // pool saturated when a thumbnail was due
+    std::atomic<guint64> failed{0};      // no parameter sets yet, decode or write error
+};
+
+class Thumbnailer {
+public:
+    Thumbnailer() = default;
+    ~Thumbnailer() { stop(); }
+    Thumbnailer(const Thumbnailer&) = delete;
+    Thumbnailer& operator=(const Thumbnailer&) = delete;
+
+    // After gst_init. every: frames between thumbnails (0 = ball changes only);
+    // param_sets: the feeder's, for keyframes without in-band VPS/SPS/PPS.
+    bool start(const std::string& folder, const std::string& camera, guint every, guint width,
+               guint workers, bool webp, ParamSetCache& param_sets);
+    // Drops queued work, waits for the frame in progress
+    void stop();
+    bool running() const { return !workers_.empty(); }
+
+    // Streaming thread: consider this access unit; ball_changed marks a transition seen on it
+    void offer(GstBuffer* buffer, guint64 index, bool ball_changed);
+
+    const ThumbnailStats& stats() const { return stats_; }
+
+private:
+    struct Job {
+        GstBuffer* buffer;
+        guint64 index;
+    };
+    struct Worker {
+        GstElement* pipeline = nullptr;
+        GstElement* src = nullptr;
+        GstElement* sink = nullptr;
+        std::thread thread;
+    };
+
+    void run(Worker& w);
+    bool encode(Worker& w, const Job& job);
+
+    std::string folder_, camera_, ext_;
+    guint every_ = 0;
+    guint64 next_due_ = 0;                   // streaming thread only
+    bool pending_ball_ = false;              // streaming thread only
+
+    std::vector<Job> queue_;                 // fixed capacity, offer() never allocates
+    size_t head_ = 0, count_ = 0;
+    bool stopping_ = false;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::vector<Worker> workers_;
+
+    ParamSetCache* param_sets_ = nullptr;    // shared, kept up to date by the feeder
+    ThumbnailStats stats_;
+};
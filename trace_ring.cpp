@@ -0,0 +1,155 @@
+#include "trace_ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+namespace {
+
+constexpr uint64_t RING_SIZE = 4096;   // ~13 s at 300 fps, far beyond pipeline latency
+constexpr int BUCKETS = 32;            // log2 microseconds: [0,1), [1,2), [2,4) ... up to ~35 min
+
+struct TraceSlot {
+    std::atomic<uint64_t> seq{UINT64_MAX};
+    std::atomic<int64_t> t[STAGE_COUNT];
+};
+
+struct Histogram {
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum_us{0};
+    std::atomic<uint64_t> max_us{0};
+
+    // Single writer (the mux src thread), relaxed readers
+    void add(int64_t ns) {
+        uint64_t us = ns > 0 ? static_cast<uint64_t>(ns) / 1000 : 0;
+        int b = 0;
+        for (uint64_t v = us; v && b < BUCKETS - 1; v >>= 1) b++;
+        buckets[b].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum_us.fetch_add(us, std::memory_order_relaxed);
+        if (us > max_us.load(std::memory_order_relaxed)) max_us.store(us, std::memory_order_relaxed);
+    }
+
+    // Upper bound of the bucket holding the q-th quantile
+    uint64_t quantile_us(double q) const {
+        uint64_t n = count.load(std::memory_order_relaxed);
+        if (!n) return 0;
+        uint64_t target = static_cast<uint64_t>(q * n), seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += buckets[b].load(std::memory_order_relaxed);
+            if (seen > target) return b == 0 ? 1 : (uint64_t(1) << b);
+        }
+        return max_us.load(std::memory_order_relaxed);
+    }
+};
+
+const char* const STAGE_NAMES[STAGE_COUNT] = {
+    "appear", "ready", "read", "push", "parse", "mux", "write"
+};
+
+std::atomic<bool> enabled{false};
+TraceSlot ring[RING_SIZE];
+Histogram stage_hist[STAGE_COUNT - 1];   // stage i -> i+1
+Histogram total_hist;                    // appear -> write
+
+// Highest sequence handed to the mux + 1 (written on the queue1 streaming thread)
+std::atomic<uint64_t> entered_mux{0};
+// Only touched on the mux src thread
+uint64_t next_unmuxed = 0;
+uint64_t next_unwritten = 0;
+
+void finalize(uint64_t seq) {
+    TraceSlot& slot = ring[seq % RING_SIZE];
+    if (slot.seq.load(std::memory_order_acquire) != seq) return;
+    int64_t t[STAGE_COUNT];
+    for (int i = 0; i < STAGE_COUNT; ++i) t[i] = slot.t[i].load(std::memory_order_relaxed);
+    for (int i = 0; i + 1 < STAGE_COUNT; ++i) {
+        if (t[i] && t[i + 1]) stage_hist[i].add(t[i + 1] - t[i]);
+    }
+    if (t[STAGE_APPEAR] && t[STAGE_WRITTEN]) total_hist.add(t[STAGE_WRITTEN] - t[STAGE_APPEAR]);
+}
+
+void print_hist(std::ostream& os, const std::string& name, const Histogram& h) {
+    uint64_t n = h.count.load(std::memory_order_relaxed);
+    os << "[trace] " << std::left << std::setw(14) << name << std::right << " n=" << n;
+    if (n) {
+        os << " mean=" << h.sum_us.load(std::memory_order_relaxed) / n << "us"
+           << " p50<=" << h.quantile_us(0.50) << "us"
+           << " p90<=" << h.quantile_us(0.90) << "us"
+           << " p99<=" << h.quantile_us(0.99) << "us"
+           << " max=" << h.max_us.load(std::memory_order_relaxed) << "us";
+    }
+    os << "\n";
+}
+
+} // namespace
+
+void trace_enable(bool on) { enabled.store(on, std::memory_order_relaxed); }
+bool trace_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+int64_t trace_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void trace_mark(uint64_t seq, TraceStage stage, int64_t t_ns) {
+    if (!trace_enabled()) return;
+    TraceSlot& slot = ring[seq % RING_SIZE];
+    if (stage == STAGE_APPEAR) {
+        // First mark of a frame claims the slot
+        for (int i = 0; i < STAGE_COUNT; ++i) slot.t[i].store(0, std::memory_order_relaxed);
+        slot.t[STAGE_APPEAR].store(t_ns, std::memory_order_relaxed);
+        slot.seq.store(seq, std::memory_order_release);
+        return;
+    }
+    if (slot.seq.load(std::memory_order_acquire) != seq) return;
+    slot.t[stage].store(t_ns, std::memory_order_relaxed);
+}
+
+void trace_mux_input(uint64_t seq) {
+    entered_mux.store(seq + 1, std::memory_order_release);
+}
+
+void trace_mux_output(uint32_t video_pes) {
+    if (!trace_enabled() || !video_pes) return;
+    int64_t now = trace_now_ns();
+    uint64_t entered = entered_mux.load(std::memory_order_acquire);
+    if (entered > next_unmuxed + RING_SIZE) next_unmuxed = entered - RING_SIZE;  // fell behind, drop
+    // The mux writes video PES in the order the frames came in
+    for (; video_pes && next_unmuxed < entered; --video_pes, ++next_unmuxed) {
+        trace_mark(next_unmuxed, STAGE_MUXED, now);
+    }
+}
+
+uint32_t ts_video_pes_starts(const uint8_t* data, size_t size) {
+    uint32_t n = 0;
+    for (size_t at = 0; at + 188 <= size; at += 188) {
+        const uint8_t* p = data + at;
+        int afc = (p[3] >> 4) & 3;
+        if (p[0] != 0x47 || !(p[1] & 0x40) || !(afc & 1)) continue;
+        size_t pl = 4 + ((afc & 2) ? 1 + p[4] : 0);
+        if (pl + 4 <= 188 && p[pl] == 0 && p[pl + 1] == 0 && p[pl + 2] == 1 && (p[pl + 3] & 0xf0) == 0xe0) ++n;
+    }
+    return n;
+}
+
+void trace_written() {
+    if (!trace_enabled()) return;
+    int64_t now = trace_now_ns();
+    if (next_unwritten + RING_SIZE < next_unmuxed) next_unwritten = next_unmuxed - RING_SIZE;
+    for (; next_unwritten < next_unmuxed; ++next_unwritten) {
+        trace_mark(next_unwritten, STAGE_WRITTEN, now);
+        finalize(next_unwritten);
+    }
+}
+
+void trace_dump(std::ostream& os) {
+    if (!trace_enabled()) return;
+    for (int i = 0; i + 1 < STAGE_COUNT; ++i) {
+        print_hist(os, std::string(STAGE_NAMES[i]) + "->" + STAGE_NAMES[i + 1], stage_hist[i]);
+    }
+    print_hist(os, "appear->write", total_hist);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// --trace bookkeeping without GStreamer: stage timestamps in a fixed ring indexed by
+// push sequence number, and log2 histograms of the stage-to-stage deltas of every
+// frame that reaches the file. latency_trace.cpp feeds it from its pad probes;
+// BM_TraceFrame measures what one traced frame costs.
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+enum TraceStage {
+    STAGE_APPEAR,    // file mtime on the RAMdisk (when the receiver finished writing it)
+    STAGE_READY,     // is_file_ready() confirmed the size is stable
+    STAGE_READ,      // file contents read into memory
+    STAGE_PUSHED,    // gst_app_src_push_buffer(_list) returned
+    STAGE_PARSED,    // seen by video_probe (h265parse src, or appsrc src with --no-parse)
+    STAGE_MUXED,     // mpegtsmux output carrying the start of the frame's video PES
+    STAGE_WRITTEN,   // filesink returned from writing that output (the rest of the PES follows)
+    STAGE_COUNT
+};
+
+// Off unless --trace is given; all trace_* calls are cheap no-ops when disabled.
+void trace_enable(bool on);
+bool trace_enabled();
+
+int64_t trace_now_ns();
+void trace_mark(uint64_t seq, TraceStage stage, int64_t t_ns);
+inline void trace_mark(uint64_t seq, TraceStage stage) { trace_mark(seq, stage, trace_now_ns()); }
+
+// Frames through the mux and onto disk, in stream order:
+// - trace_mux_input:  frame seq handed to the mux (queue1 streaming thread)
+// - trace_mux_output: mux output buffer starting video_pes video PES: the oldest frames
+//                     handed in and not yet matched are muxed (audio and PSI start none)
+// - trace_written:    filesink wrote that buffer; every frame muxed so far is on disk
+// The last two must run on the thread that pushes into filesink, one after the other.
+void trace_mux_input(uint64_t seq);
+void trace_mux_output(uint32_t video_pes);
+void trace_written();
+// Video PES (stream id 0xE0-0xEF) starting in whole TS packets of a mux output buffer
+uint32_t ts_video_pes_starts(const uint8_t* data, size_t size);
+
+// Histograms of completed frames, one line per stage pair plus end-to-end
+void trace_dump(std::ostream& os);
@@ -0,0 +1,561 @@
+#include "ts_http.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+using socket_t = SOCKET;
+static void close_socket(socket_t s) { closesocket(s); }
+static bool would_block() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using socket_t = int;
+static constexpr socket_t INVALID_SOCKET = -1;
+static void close_socket(socket_t s) { close(s); }
+static bool would_block() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+constexpr size_t TS = 188;
+constexpr int TICK_MS = 20;
+constexpr size_t MAX_REQUEST = 4096;
+constexpr uint64_t CHUNK = 1 << 20;          // file bytes per HTTP chunk
+constexpr size_t SCAN = 2048 * TS;           // index read size
+constexpr int64_t PTS_WRAP = int64_t(1) << 33;
+constexpr int64_t INDEX_SPACING = 90000 / 4;  // 250 ms of PTS between index entries
+
+socket_t sock(intptr_t fd) { return static_cast<socket_t>(fd); }
+
+void set_nonblocking(socket_t fd) {
+#ifdef _WIN32
+    u_long on = 1;
+    ioctlsocket(fd, FIONBIO, &on);
+#else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+std::string query_value(const std::string& query, const char* key) {
+    std::string k = std::string(key) + "=";
+    size_t at = 0;
+    while (at < query.size()) {
+        size_t end = query.find('&', at);
+        if (end == std::string::npos) end = query.size();
+        if (query.compare(at, k.size(), k) == 0) return query.substr(at + k.size(), end - at - k.size());
+        at = end + 1;
+    }
+    return "";
+}
+
+// HEVC NAL types that start a decodable picture: VPS, or an IRAP slice (BLA/IDR/CRA)
+bool has_hevc_irap(const uint8_t* p, size_t n) {
+    for (size_t i = 0; i + 3 < n; ++i) {
+        if (p[i] != 0 || p[i + 1] != 0 || p[i + 2] != 1) continue;
+        int type = (p[i + 3] >> 1) & 0x3f;
+        if (type == 32 || (type >= 16 && type <= 21)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+struct TsHttpServer::Client {
+    socket_t fd = INVALID_SOCKET;
+    std::string request;
+    bool responding = false;     // request parsed, body streaming
+    bool close_after = false;    // error response: drop once out is flushed
+    bool writable = false;       // waiting for EPOLLOUT / POLLOUT
+    bool dead = false;
+    std::string out;             // response head, PSI, chunk framing (Windows: chunk data too)
+    size_t out_pos = 0;
+    uint64_t pos = 0;            // next file byte
+    uint64_t chunk_left = 0;     // file bytes left in the current chunk (sendfile path)
+};
+
+TsHttpServer::TsHttpServer() = default;
+
+TsHttpServer::~TsHttpServer() { stop(); }
+
+bool TsHttpServer::start(const std::string& addr, const std::string& ts_path) {
+    if (running_.load()) return true;
+    std::string host = "0.0.0.0", port = addr;
+    size_t colon = addr.rfind(':');
+    if (colon != std::string::npos) {
+        if (colon) host = addr.substr(0, colon);
+        port = addr.substr(colon + 1);
+    }
+    char* end = nullptr;
+    unsigned long port_num = port.empty() || !std::isdigit(static_cast<unsigned char>(port[0]))
+                                 ? 0 : std::strtoul(port.c_str(), &end, 10);
+    if (port_num == 0 || port_num > 65535 || *end) {
+        std::cerr << "[http] Bad port '" << port << "' (expected 1-65535)\n";
+        return false;
+    }
+    path_ = ts_path;
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "[http] WSAStartup failed\n";
+        return false;
+    }
+#else
+    // A client hanging up mid-sendfile() must not take the feeder down
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    socket_t fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd == INVALID_SOCKET) {
+        std::cerr << "[http] socket() failed\n";
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(static_cast<unsigned short>(port_num));
+    if (inet_pton(AF_INET, host.c_str(), &sa.sin_addr) != 1 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0 || listen(fd, 64) != 0) {
+        std::cerr << "[http] Cannot listen on " << host << ":" << port << "\n";
+        close_socket(fd);
+        return false;
+    }
+    set_nonblocking(fd);
+    listen_fd_ = static_cast<intptr_t>(fd);
+
+#ifndef _WIN32
+    poll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    if (poll_fd_ < 0 || epoll_ctl(static_cast<int>(poll_fd_), EPOLL_CTL_ADD, fd, &ev) != 0) {
+        std::cerr << "[http] epoll setup failed: " << std::strerror(errno) << "\n";
+        if (poll_fd_ >= 0) close(static_cast<int>(poll_fd_));
+        poll_fd_ = -1;
+        close_socket(fd);
+        listen_fd_ = -1;
+        return false;
+    }
+#endif
+
+    running_ = true;
+    thread_ = std::thread(&TsHttpServer::loop, this);
+    std::cout << "[http] Serving " << ts_path << " at http://" << host << ":" << port << "/live.ts\n";
+    return true;
+}
+
+void TsHttpServer::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) thread_.join();
+    for (auto& c : clients_) {
+        // Best effort end-of-body so players see a clean finish rather than a reset
+        if (c->responding && c->out_pos == c->out.size() && c->chunk_left == 0)
+            send(c->fd, "0\r\n\r\n", 5, MSG_NOSIGNAL);
+        close_socket(c->fd);
+    }
+    clients_.clear();
+    stats_.clients = 0;
+    close_socket(sock(listen_fd_));
+    listen_fd_ = -1;
+    close_file();
+#ifdef _WIN32
+    WSACleanup();
+#else
+    if (poll_fd_ >= 0) close(static_cast<int>(poll_fd_));
+    poll_fd_ = -1;
+#endif
+}
+
+bool TsHttpServer::open_file() {
+    if (file_ != -1) return true;
+#ifdef _WIN32
+    // Share everything so filesink keeps writing (and may replace) the file
+    HANDLE h = CreateFileA(path_.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    file_ = reinterpret_cast<intptr_t>(h);
+#else
+    int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    file_ = fd;
+#endif
+    return true;
+}
+
+void TsHttpServer::close_file() {
+    if (file_ == -1) return;
+#ifdef _WIN32
+    CloseHandle(reinterpret_cast<HANDLE>(file_));
+#else
+    close(static_cast<int>(file_));
+#endif
+    file_ = -1;
+}
+
+bool TsHttpServer::file_replaced() const {
+    // Nothing at the path (between a delete and the new create) keeps the file we have
+#ifdef _WIN32
+    HANDLE h = CreateFileA(path_.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    BY_HANDLE_FILE_INFORMATION now, ours;
+    bool differs = GetFileInformationByHandle(h, &now) &&
+                   GetFileInformationByHandle(reinterpret_cast<HANDLE>(file_), &ours) &&
+                   (now.dwVolumeSerialNumber != ours.dwVolumeSerialNumber ||
+                    now.nFileIndexHigh != ours.nFileIndexHigh || now.nFileIndexLow != ours.nFileIndexLow);
+    CloseHandle(h);
+    return differs;
+#else
+    struct stat now, ours;
+    if (stat(path_.c_str(), &now) != 0 || fstat(static_cast<int>(file_), &ours) != 0) return false;
+    return now.st_ino != ours.st_ino || now.st_dev != ours.st_dev;
+#endif
+}
+
+uint64_t TsHttpServer::file_size() const {
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(reinterpret_cast<HANDLE>(file_), &size)) return 0;
+    return static_cast<uint64_t>(size.QuadPart);
+#else
+    struct stat st;
+    if (fstat(static_cast<int>(file_), &st) != 0) return 0;
+    return static_cast<uint64_t>(st.st_size);
+#endif
+}
+
+size_t TsHttpServer::read_at(uint64_t offset, uint8_t* dst, size_t n) const {
+#ifdef _WIN32
+    OVERLAPPED ov{};
+    ov.Offset = static_cast<DWORD>(offset);
+    ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD got = 0;
+    if (!ReadFile(reinterpret_cast<HANDLE>(file_), dst, static_cast<DWORD>(n), &got, &ov)) return 0;
+    return got;
+#else
+    ssize_t got = pread(static_cast<int>(file_), dst, n, static_cast<off_t>(offset));
+    return got > 0 ? static_cast<size_t>(got) : 0;
+#endif
+}
+
+void TsHttpServer::index_packet(const uint8_t* p, uint64_t offset) {
+    if (p[0] != 0x47) return;
+    bool pusi = p[1] & 0x40;
+    int pid = ((p[1] & 0x1f) << 8) | p[2];
+    int afc = (p[3] >> 4) & 3;
+    if (!pusi || !(afc & 1)) return;
+    size_t at = 4;
+    bool rai = false;
+    if (afc & 2) {
+        rai = p[4] > 0 && (p[5] & 0x40);
+        at += 1 + p[4];
+    }
+    if (at >= TS) return;
+    const uint8_t* pl = p + at;
+    size_t len = TS - at;
+
+    if (pid == 0) {
+        if (pat_.empty()) pat_.assign(reinterpret_cast<const char*>(p), TS);
+        // First program in the PAT names the PMT
+        size_t s = 1 + pl[0];
+        if (pmt_pid_ < 0 && s + 16 <= len && pl[s] == 0x00) {
+            // Program loop runs from after the 8-byte section header up to the CRC
+            size_t end = std::min(len, s + 3 + (((pl[s + 1] & 0x0f) << 8) | pl[s + 2]) - 4);
+            for (size_t e = s + 8; e + 4 <= end; e += 4) {
+                if (((pl[e] << 8) | pl[e + 1]) == 0) continue;
+                pmt_pid_ = ((pl[e + 2] & 0x1f) << 8) | pl[e + 3];
+                break;
+            }
+        }
+        return;
+    }
+    if (pid == pmt_pid_) {
+        if (pmt_.empty()) pmt_.assign(reinterpret_cast<const char*>(p), TS);
+        return;
+    }
+    // Video PES start with a PTS
+    if (len < 14 || pl[0] || pl[1] || pl[2] != 1 || (pl[3] & 0xf0) != 0xe0 || !(pl[7] & 0x80)) return;
+    size_t es = 9 + pl[8];
+    if (!rai && (es >= len || !has_hevc_irap(pl + es, len - es))) return;
+    int64_t pts = (int64_t(pl[9] & 0x0e) << 29) | (int64_t(pl[10]) << 22) | (int64_t(pl[11] & 0xfe) << 14) |
+                  (int64_t(pl[12]) << 7) | (pl[13] >> 1);
+    // Unwrap the 33-bit PTS so the index stays sorted across a wrap
+    if (newest_.pts >= 0) {
+        int64_t last = newest_.pts;
+        pts += last - (last % PTS_WRAP);
+        if (pts < last - PTS_WRAP / 2) pts += PTS_WRAP;
+    }
+    newest_ = {offset, pts};
+    if (!index_.empty() && pts - index_.back().pts < INDEX_SPACING) return;
+    index_.push_back(newest_);
+    stats_.keyframes.store(index_.size(), std::memory_order_relaxed);
+}
+
+void TsHttpServer::reset_index() {
+    index_.clear();
+    newest_ = {0, -1};
+    indexed_ = 0;
+    pmt_pid_ = -1;
+    pat_.clear();
+    pmt_.clear();
+    stats_.keyframes.store(0, std::memory_order_relaxed);
+}
+
+void TsHttpServer::index_to(uint64_t size) {
+    scan_buf_.resize(SCAN);
+    while (indexed_ + TS <= size) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(SCAN, (size - indexed_) / TS * TS));
+        size_t got = read_at(indexed_, scan_buf_.data(), want) / TS * TS;
+        if (!got) return;
+        for (size_t i = 0; i < got; i += TS) index_packet(scan_buf_.data() + i, indexed_ + i);
+        indexed_ += got;
+    }
+}
+
+uint64_t TsHttpServer::start_offset(const std::string& query) const {
+    if (query_value(query, "from") == "start" || index_.empty()) return 0;
+    std::string pts = query_value(query, "pts"), t = query_value(query, "t");
+    if (pts.empty() && t.empty()) return newest_.offset;
+    int64_t want = !pts.empty() ? std::strtoll(pts.c_str(), nullptr, 10)
+                                : index_.front().pts + static_cast<int64_t>(std::atof(t.c_str()) * 90000.0);
+    auto it = std::upper_bound(index_.begin(), index_.end(), want,
+                               [](int64_t v, const Keyframe& k) { return v < k.pts; });
+    return it == index_.begin() ? 0 : std::prev(it)->offset;
+}
+
+void TsHttpServer::set_writable(Client& c, bool on) {
+    if (c.writable == on) return;
+    c.writable = on;
+#ifndef _WIN32
+    epoll_event ev{};
+    ev.events = on ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    ev.data.ptr = &c;
+    epoll_ctl(static_cast<int>(poll_fd_), EPOLL_CTL_MOD, c.fd, &ev);
+#endif
+}
+
+void TsHttpServer::accept_clients() {
+    for (;;) {
+        socket_t fd = accept(sock(listen_fd_), NULL, NULL);
+        if (fd == INVALID_SOCKET) return;
+        set_nonblocking(fd);
+        auto c = std::make_unique<Client>();
+        c->fd = fd;
+#ifndef _WIN32
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = c.get();
+        if (epoll_ctl(static_cast<int>(poll_fd_), EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close_socket(fd);
+            continue;
+        }
+#endif
+        clients_.push_back(std::move(c));
+        stats_.connections.fetch_add(1, std::memory_order_relaxed);
+        stats_.clients.store(clients_.size(), std::memory_order_relaxed);
+    }
+}
+
+bool TsHttpServer::read_request(Client& c) {
+    char buf[1024];
+    for (;;) {
+        int n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n == 0) return false;
+        if (n < 0) return would_block();
+        // Once streaming, anything the client sends is ignored
+        if (c.responding || c.close_after) continue;
+        c.request.append(buf, static_cast<size_t>(n));
+        if (c.request.find("\r\n\r\n") != std::string::npos) break;
+        if (c.request.size() > MAX_REQUEST) return false;
+    }
+
+    std::string method = c.request.substr(0, c.request.find(' '));
+    size_t t0 = c.request.find(' ') + 1, t1 = c.request.find(' ', t0);
+    std::string target = t1 == std::string::npos ? "" : c.request.substr(t0, t1 - t0);
+    std::string path = target.substr(0, target.find('?'));
+    std::string query = path.size() < target.size() ? target.substr(path.size() + 1) : "";
+    c.request.clear();
+
+    if (method != "GET" || (path != "/" && path != "/live.ts")) {
+        bool get = method == "GET";
+        std::string body = get ? "Not found; try /live.ts\n" : "Only GET is supported\n";
+        c.out = std::string(get ? "HTTP/1.1 404 Not Found\r\n" : "HTTP/1.1 405 Method Not Allowed\r\n") +
+                "Content-Type: text/plain\r\nContent-Length: " + std::to_string(body.size()) +
+                "\r\nConnection: close\r\n\r\n" + body;
+        c.close_after = true;
+        return pump(c);
+    }
+
+    c.pos = start_offset(query);
+    c.responding = true;
+    c.out = "HTTP/1.1 200 OK\r\n"
+            "Content-Type: video/mp2t\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "Connection: close\r\n\r\n";
+    if (c.pos > 0 && !pat_.empty() && !pmt_.empty()) {
+        char head[16];
+        std::snprintf(head, sizeof(head), "%zx\r\n", pat_.size() + pmt_.size());
+        c.out += head + pat_ + pmt_ + "\r\n";
+    }
+    return pump(c);
+}
+
+bool TsHttpServer::pump(Client& c) {
+    for (;;) {
+        if (c.out_pos < c.out.size()) {
+            int n = send(c.fd, c.out.data() + c.out_pos, static_cast<int>(c.out.size() - c.out_pos), MSG_NOSIGNAL);
+            if (n < 0 && would_block()) {
+                set_writable(c, true);
+                return true;
+            }
+            if (n <= 0) return false;
+            c.out_pos += static_cast<size_t>(n);
+            continue;
+        }
+        c.out.clear();
+        c.out_pos = 0;
+        if (c.close_after) return false;
+        if (!c.responding) {
+            set_writable(c, false);
+            return true;
+        }
+#ifndef _WIN32
+        if (c.chunk_left) {
+            off_t off = static_cast<off_t>(c.pos);
+            ssize_t n = sendfile(c.fd, static_cast<int>(file_), &off, static_cast<size_t>(c.chunk_left));
+            if (n < 0 && would_block()) {
+                set_writable(c, true);
+                return true;
+            }
+            if (n <= 0) return false;
+            c.pos += static_cast<uint64_t>(n);
+            c.chunk_left -= static_cast<uint64_t>(n);
+            stats_.bytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+            if (!c.chunk_left) c.out = "\r\n";
+            continue;
+        }
+#endif
+        if (c.pos >= size_ || file_ == -1) {
+            // Caught up with the writer; the tick pumps again when the file grows
+            set_writable(c, false);
+            return true;
+        }
+        uint64_t n = std::min<uint64_t>(size_ - c.pos, CHUNK);
+        char head[24];
+#ifdef _WIN32
+        // No sendfile for a plain socket: stage at most 64 KB per chunk through user space
+        n = std::min<uint64_t>(n, 64 * 1024);
+        std::snprintf(head, sizeof(head), "%llx\r\n", static_cast<unsigned long long>(n));
+        c.out = head;
+        size_t at = c.out.size();
+        c.out.resize(at + static_cast<size_t>(n));
+        size_t got = read_at(c.pos, reinterpret_cast<uint8_t*>(&c.out[at]), static_cast<size_t>(n));
+        if (!got) return false;
+        if (got != n) {
+            std::snprintf(head, sizeof(head), "%llx\r\n", static_cast<unsigned long long>(got));
+            c.out = head + c.out.substr(at, got);
+        }
+        c.out += "\r\n";
+        c.pos += got;
+        stats_.bytes.fetch_add(got, std::memory_order_relaxed);
+#else
+        std::snprintf(head, sizeof(head), "%llx\r\n", static_cast<unsigned long long>(n));
+        c.out = head;
+        c.chunk_left = n;
+#endif
+    }
+}
+
+void TsHttpServer::sweep() {
+    size_t before = clients_.size();
+    clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                  [](const std::unique_ptr<Client>& c) {
+                                      if (c->dead) close_socket(c->fd);
+                                      return c->dead;
+                                  }),
+                   clients_.end());
+    if (clients_.size() != before) stats_.clients.store(clients_.size(), std::memory_order_relaxed);
+}
+
+void TsHttpServer::loop() {
+#ifndef _WIN32
+    epoll_event events[64];
+#else
+    std::vector<WSAPOLLFD> fds;
+#endif
+    while (running_.load()) {
+#ifndef _WIN32
+        int n = epoll_wait(static_cast<int>(poll_fd_), events, 64, TICK_MS);
+        for (int i = 0; i < n; ++i) {
+            Client* c = static_cast<Client*>(events[i].data.ptr);
+            if (!c) {
+                accept_clients();
+                continue;
+            }
+            if (c->dead) continue;
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !read_request(*c)) c->dead = true;
+            else if ((events[i].events & EPOLLOUT) && !pump(*c)) c->dead = true;
+        }
+#else
+        fds.clear();
+        fds.push_back({sock(listen_fd_), POLLRDNORM, 0});
+        for (auto& c : clients_) fds.push_back({c->fd, static_cast<SHORT>(POLLRDNORM | (c->writable ? POLLWRNORM : 0)), 0});
+        int n = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), TICK_MS);
+        if (n > 0) {
+            size_t count = clients_.size();
+            for (size_t i = 0; i < count; ++i) {
+                Client& c = *clients_[i];
+                SHORT re = fds[i + 1].revents;
+                if ((re & (POLLRDNORM | POLLHUP | POLLERR)) && !read_request(c)) c.dead = true;
+                else if ((re & POLLWRNORM) && !pump(c)) c.dead = true;
+            }
+            if (fds[0].revents & POLLRDNORM) accept_clients();
+        }
+#endif
+        // Follow the writer: index what it appended, then feed clients that were caught up
+        if (file_ != -1 && file_replaced()) {
+            // A new recording at the path: clients were following the old one
+            std::cout << "[http] " << path_ << " was replaced; re-opening\n";
+            close_file();
+            reset_index();
+            for (auto& c : clients_) c->dead = c->dead || c->responding;
+            size_ = 0;
+        }
+        if (open_file()) {
+            uint64_t size = file_size();
+            if (size < indexed_) {
+                // Truncated under us; re-open and start the index over
+                close_file();
+                reset_index();
+                for (auto& c : clients_) c->dead = c->dead || c->pos > size;
+                size = open_file() ? file_size() : 0;
+            }
+            size_ = size;
+            if (file_ != -1) index_to(size);
+        }
+        for (auto& c : clients_)
+            if (!c->dead && c->responding && !c->writable && c->pos < size_ && !pump(*c)) c->dead = true;
+        sweep();
+    }
+}
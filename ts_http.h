@@ -0,0 +1,97 @@
+#pragma once
+
+// --http: the recording served over HTTP while it is being written.
+//
+//   GET /live.ts               from the newest keyframe, then follows the file as it grows
+//   GET /live.ts?t=S           from the last keyframe at or before S seconds into the recording
+//   GET /live.ts?pts=N         from the last keyframe at or before video PTS N (90 kHz, as
+//                              carried in the TS)
+//   GET /live.ts?from=start    the whole recording, then follows it
+//
+// Responses are chunked and end when the feeder stops. One thread serves every client:
+// epoll plus sendfile() straight from the page cache on Linux, WSAPoll plus ReadFile/send
+// on Windows. The server only reads the file, so the filesink write path is untouched and
+// a slow client just falls further behind on disk instead of buffering anything.
+//
+// Keyframes come from an index the server thread extends every tick over the newly
+// written bytes: packets that start a video PES carrying random_access_indicator or an
+// HEVC VPS/IRAP NAL. The feeder's stream is intra-only, so the index keeps one keyframe
+// per 250 ms of PTS (about 1.6 MB for 7 hours) plus the newest one for the live edge.
+// Clients that start mid-file get the recording's PAT and PMT first so players lock on
+// immediately. A file replaced under the server (new inode) or truncated is re-opened
+// and indexed from the start.
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TsHttpStats {
+    std::atomic<uint64_t> clients{0};        // connected now
+    std::atomic<uint64_t> connections{0};    // accepted so far
+    std::atomic<uint64_t> bytes{0};          // body bytes sent
+    std::atomic<uint64_t> keyframes{0};      // index entries (thinned)
+};
+
+class TsHttpServer {
+public:
+    TsHttpServer();
+    ~TsHttpServer();
+    TsHttpServer(const TsHttpServer&) = delete;
+    TsHttpServer& operator=(const TsHttpServer&) = delete;
+
+    // Serve ts_path on "[host:]port" (host defaults to 0.0.0.0). The file may not exist yet.
+    bool start(const std::string& addr, const std::string& ts_path);
+    void stop();
+    bool running() const { return running_.load(); }
+
+    const TsHttpStats& stats() const { return stats_; }
+
+private:
+    struct Client;
+    struct Keyframe {
+        uint64_t offset;
+        int64_t pts;
+    };
+
+    void loop();
+    void accept_clients();
+    // Request head in; false when the client should be dropped
+    bool read_request(Client& c);
+    // Send what the client can take now; false when it is done or gone
+    bool pump(Client& c);
+    void set_writable(Client& c, bool on);
+    void sweep();
+
+    bool open_file();
+    void close_file();
+    // Another file now at path_ (renamed over, or deleted and recreated)
+    bool file_replaced() const;
+    uint64_t file_size() const;
+    size_t read_at(uint64_t offset, uint8_t* dst, size_t n) const;
+    // Keyframes and PAT/PMT in [indexed_, size)
+    void index_to(uint64_t size);
+    void index_packet(const uint8_t* p, uint64_t offset);
+    void reset_index();
+    uint64_t start_offset(const std::string& query) const;
+
+    std::string path_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    intptr_t listen_fd_ = -1;
+    intptr_t poll_fd_ = -1;                  // epoll instance (Linux)
+    intptr_t file_ = -1;                     // fd, or HANDLE on Windows
+    uint64_t size_ = 0;                      // file size as of this tick
+    std::vector<std::unique_ptr<Client>> clients_;
+
+    std::vector<Keyframe> index_;            // sorted by unwrapped PTS, >= INDEX_SPACING apart
+    Keyframe newest_{0, -1};                 // pts -1: none yet
+    uint64_t indexed_ = 0;
+    int pmt_pid_ = -1;
+    std::string pat_, pmt_;                  // first PAT and PMT packets, prepended mid-file
+    std::vector<uint8_t> scan_buf_;
+
+    TsHttpStats stats_;
+};
@@ -0,0 +1,134 @@
+#include "ts_outputs.h"
+
+#include <cstdlib>
+#include <iostream>
+
+static const guint OUTPUT_QUEUE_BYTES = 4 * 1024 * 1024;   // ~2.5 s at 13 Mbit/s
+
+bool TsOutputs::add(const std::string& uri, std::string& error) {
+    auto o = std::make_unique<Output>();
+    o->uri = uri;
+    size_t sep = uri.find("://");
+    o->scheme = sep == std::string::npos ? "" : uri.substr(0, sep);
+    if (o->scheme != "udp" && o->scheme != "rtp" && o->scheme != "srt") {
+        error = "expected udp://HOST:PORT, rtp://HOST:PORT or srt://[HOST]:PORT";
+        return false;
+    }
+    std::string addr = uri.substr(sep + 3);
+    size_t colon = addr.rfind(':');
+    if (colon == std::string::npos || colon + 1 == addr.size()) {
+        error = "missing port";
+        return false;
+    }
+    o->host = addr.substr(0, colon);
+    o->port = std::atoi(addr.c_str() + colon + 1);
+    if (o->port <= 0 || o->port > 65535 || (o->host.empty() && o->scheme != "srt")) {
+        error = o->host.empty() ? "missing host" : "bad port";
+        return false;
+    }
+    outputs_.push_back(std::move(o));
+    return true;
+}
+
+GstPadProbeReturn TsOutputs::leak_probe(GstPad* pad, GstPadProbeInfo* info, gpointer output) {
+    (void)pad;
+    Output& o = *static_cast<Output*>(output);
+    guint64 n = 1;
+    gsize bytes = 0;
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        GstBufferList* list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        n = gst_buffer_list_length(list);
+        bytes = gst_buffer_list_calculate_size(list);
+    } else {
+        bytes = gst_buffer_get_size(GST_PAD_PROBE_INFO_BUFFER(info));
+    }
+    // Only this thread (the tee's) adds to the queue, so the level can only have gone
+    // down by the time the buffer is queued
+    guint level = 0;
+    g_object_get(G_OBJECT(o.queue), "current-level-bytes", &level, NULL);
+    if (level + bytes <= OUTPUT_QUEUE_BYTES) return GST_PAD_PROBE_OK;
+    o.dropped.fetch_add(n, std::memory_order_relaxed);
+    return GST_PAD_PROBE_DROP;
+}
+
+GstPadProbeReturn TsOutputs::count_probe(GstPad* pad, GstPadProbeInfo* info, gpointer counter) {
+    (void)pad;
+    guint64 n = 1;
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) n = gst_buffer_list_length(GST_PAD_PROBE_INFO_BUFFER_LIST(info));
+    static_cast<std::atomic<guint64>*>(counter)->fetch_add(n, std::memory_order_relaxed);
+    return GST_PAD_PROBE_OK;
+}
+
+bool TsOutputs::link(GstElement* pipeline, GstElement* mux, GstElement* filesink) {
+    GstElement* tee = gst_element_factory_make("tee", "ts-tee");
+    if (!tee) return false;
+    // Whole datagrams of 7 packets for udpsink/srtsink; the file gets the same packets,
+    // plus up to 6 null packets padding the last buffer at EOS
+    g_object_set(G_OBJECT(mux), "alignment", 7, NULL);
+    // The recording stays on the mux streaming thread, no queue added in front of it
+    gst_bin_add(GST_BIN(pipeline), tee);
+    if (!gst_element_link_many(mux, tee, filesink, NULL)) return false;
+
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+        Output& o = *outputs_[i];
+        std::string n = std::to_string(i);
+        GstElement* queue = gst_element_factory_make("queue", ("out-queue" + n).c_str());
+        GstElement* pay = o.scheme == "rtp" ? gst_element_factory_make("rtpmp2tpay", ("out-pay" + n).c_str()) : nullptr;
+        GstElement* sink = gst_element_factory_make(o.scheme == "srt" ? "srtsink" : "udpsink", ("out-sink" + n).c_str());
+        if (!queue || !sink || (o.scheme == "rtp" && !pay)) {
+            std::cerr << "[out] Cannot create the elements for " << o.uri << " (missing plugin?)\n";
+            return false;
+        }
+        // leak_probe keeps the queue under OUTPUT_QUEUE_BYTES (a list larger than that is
+        // dropped whole), so the queue's own limits are off: it never blocks the tee and
+        // never drops a buffer the probe did not count
+        g_object_set(G_OBJECT(queue), "max-size-buffers", 0, "max-size-time", G_GUINT64_CONSTANT(0),
+                     "max-size-bytes", 0, NULL);
+        if (o.scheme == "srt") {
+            std::string srt = "srt://" + o.host + ":" + std::to_string(o.port) + "?mode=listener";
+            g_object_set(G_OBJECT(sink), "uri", srt.c_str(), "wait-for-connection", FALSE, NULL);
+        } else {
+            g_object_set(G_OBJECT(sink), "host", o.host.c_str(), "port", o.port, NULL);
+        }
+        // Send as muxed; a network consumer must not hold up preroll either
+        g_object_set(G_OBJECT(sink), "sync", FALSE, "async", FALSE, NULL);
+
+        gst_bin_add_many(GST_BIN(pipeline), queue, sink, NULL);
+        if (pay) gst_bin_add(GST_BIN(pipeline), pay);
+        bool linked = gst_element_link(tee, queue) &&
+                      (pay ? gst_element_link_many(queue, pay, sink, NULL) : gst_element_link(queue, sink));
+        if (!linked) {
+            std::cerr << "[out] Cannot link " << o.uri << "\n";
+            return false;
+        }
+        const GstPadProbeType types =
+            static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST);
+        o.queue = queue;
+        GstPad* qin = gst_element_get_static_pad(queue, "sink");
+        GstPad* qout = gst_element_get_static_pad(queue, "src");
+        gst_pad_add_probe(qin, types, leak_probe, &o, NULL);
+        gst_pad_add_probe(qout, types, count_probe, &o.out, NULL);
+        gst_object_unref(qin);
+        gst_object_unref(qout);
+        std::cout << "[config] Output: " << o.uri << (o.scheme == "srt" ? " (SRT listener)" : "") << "\n";
+    }
+    return true;
+}
+
+void TsOutputs::collect(std::string& out, const std::string& labels) const {
+    if (outputs_.empty()) return;
+    out += "# TYPE feeder_output_buffers_total counter\n";
+    for (const auto& o : outputs_) {
+        out += "feeder_output_buffers_total{" + labels + ",output=\"" + o->uri + "\",result=\"sent\"} " +
+               std::to_string(o->out.load(std::memory_order_relaxed)) + "\n";
+        out += "feeder_output_buffers_total{" + labels + ",output=\"" + o->uri + "\",result=\"dropped\"} " +
+               std::to_string(o->dropped.load(std::memory_order_relaxed)) + "\n";
+    }
+}
+
+void TsOutputs::report(std::ostream& os) const {
+    for (const auto& o : outputs_) {
+        os << "[out] " << o->uri << ": " << o->out.load(std::memory_order_relaxed) << " buffers sent, "
+           << o->dropped.load(std::memory_order_relaxed) << " dropped\n";
+    }
+}
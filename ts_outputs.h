@@ -0,0 +1,58 @@
+#pragma once
+
+#include <gst/gst.h>
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+// --out: live copies of the muxed TS for graphics / replay systems.
+//
+//   mpegtsmux -> tee -> filesink                                  (the recording, as before)
+//                    -> queue -> udpsink                          udp://HOST:PORT  (unicast or multicast)
+//                    -> queue -> rtpmp2tpay -> udpsink            rtp://HOST:PORT
+//                    -> queue -> srtsink (listener)               srt://[HOST]:PORT
+//
+// Each extra branch sits behind a bounded queue: a consumer that stalls loses TS buffers
+// instead of pushing back on the mux and the recording. The probe on the queue's sink
+// pad is the only leak point: a buffer that would take the queue past its limit is
+// dropped there and counted, so drops are exact and only go up. The queue itself has no
+// limit and never leaks. Buffers leaving the queue are counted as sent.
+//
+// With outputs the mux emits 7 packets (1316 bytes) per buffer: one datagram each that
+// fits the MTU, starts on a packet boundary, and is the payload size SRT live mode takes.
+
+class TsOutputs {
+public:
+    TsOutputs() = default;
+    TsOutputs(const TsOutputs&) = delete;
+    TsOutputs& operator=(const TsOutputs&) = delete;
+
+    // Parse one --out URI; false (and why) if it is not udp://, rtp:// or srt://
+    bool add(const std::string& uri, std::string& error);
+    bool empty() const { return outputs_.empty(); }
+
+    // Instead of linking mux -> filesink; elements are created and added to pipeline
+    bool link(GstElement* pipeline, GstElement* mux, GstElement* filesink);
+
+    // Prometheus lines (feeder_output_buffers_total{output=,result=sent|dropped})
+    void collect(std::string& out, const std::string& labels) const;
+    // "[out] udp://239.1.1.1:5000: 81234 sent, 0 dropped" per output
+    void report(std::ostream& os) const;
+
+private:
+    struct Output {
+        std::string uri;
+        std::string scheme;                  // udp, rtp, srt
+        std::string host;
+        int port = 0;
+        GstElement* queue = nullptr;
+        std::atomic<guint64> out{0};         // buffers out of the queue (to the sink)
+        std::atomic<guint64> dropped{0};     // buffers not let into the full queue
+    };
+    static GstPadProbeReturn leak_probe(GstPad* pad, GstPadProbeInfo* info, gpointer output);
+    static GstPadProbeReturn count_probe(GstPad* pad, GstPadProbeInfo* info, gpointer counter);
+
+    std::vector<std::unique_ptr<Output>> outputs_;
+};
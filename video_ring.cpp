@@ -0,0 +1,134 @@
+#include "video_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace {
+
+constexpr size_t ALIGN = 64;
+
+size_t align_up(size_t n) { return (n + ALIGN - 1) / ALIGN * ALIGN; }
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+VideoRingSlot* VideoRing::slot_at(uint64_t seq) const {
+    uint8_t* base = reinterpret_cast<uint8_t*>(hdr_) + sizeof(VideoRingHeader);
+    return reinterpret_cast<VideoRingSlot*>(base + (seq % hdr_->slot_count) * hdr_->slot_stride);
+}
+
+bool VideoRing::create(const std::string& name, uint32_t slot_count, uint32_t slot_size, uint32_t meta_size) {
+    close();
+    if (!slot_count || !slot_size) return false;
+    meta_size = static_cast<uint32_t>(align_up(meta_size));
+    uint64_t stride = sizeof(VideoRingSlot) + meta_size + align_up(slot_size);
+    if (!shm_.map(name, true, sizeof(VideoRingHeader) + stride * slot_count)) return false;
+    hdr_ = static_cast<VideoRingHeader*>(shm_.data());
+    writer_ = true;
+
+    // Fresh mapping is zeroed; construct the atomics in place, publish the magic last
+    VideoRingHeader* h = new (hdr_) VideoRingHeader();
+    h->version = VIDEO_RING_VERSION;
+    h->slot_count = slot_count;
+    h->slot_size = slot_size;
+    h->meta_size = meta_size;
+    h->slot_stride = stride;
+    for (uint32_t i = 0; i < slot_count; ++i) new (slot_at(i)) VideoRingSlot();
+    h->magic.store(VIDEO_RING_MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool VideoRing::open(const std::string& name) {
+    close();
+    if (!shm_.map(name, false, 0, false)) return false;
+    hdr_ = static_cast<VideoRingHeader*>(shm_.data());
+    bool ok = shm_.size() >= sizeof(VideoRingHeader) &&
+              hdr_->magic.load(std::memory_order_acquire) == VIDEO_RING_MAGIC &&
+              hdr_->version == VIDEO_RING_VERSION && hdr_->slot_count &&
+              sizeof(VideoRingHeader) + hdr_->slot_stride * hdr_->slot_count <= shm_.size();
+    if (!ok) close();
+    return ok;
+}
+
+void VideoRing::close() {
+    shm_.unmap();
+    hdr_ = nullptr;
+    writer_ = false;
+}
+
+uint8_t* VideoRing::reserve(size_t size) {
+    if (!hdr_ || !writer_) return nullptr;
+    if (size > hdr_->slot_size) {
+        hdr_->oversize.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    VideoRingSlot* s = slot_at(hdr_->write_seq.load(std::memory_order_relaxed));
+    // Readers still on the previous occupant see the change and drop it
+    s->seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return reinterpret_cast<uint8_t*>(s) + sizeof(VideoRingSlot) + hdr_->meta_size;
+}
+
+void VideoRing::commit(const VideoRingAu& au, std::string_view meta) {
+    uint64_t seq = hdr_->write_seq.load(std::memory_order_relaxed);
+    VideoRingSlot* s = slot_at(seq);
+    size_t meta_len = std::min<size_t>(meta.size(), hdr_->meta_size);
+    memcpy(reinterpret_cast<uint8_t*>(s) + sizeof(VideoRingSlot), meta.data(), meta_len);
+    s->index = au.index;
+    s->pts_ns = au.pts_ns;
+    s->dts_ns = au.dts_ns;
+    s->duration_ns = au.duration_ns;
+    s->size = au.size;
+    s->flags = au.flags;
+    s->meta_len = static_cast<uint32_t>(meta_len);
+    s->publish_ns = steady_ns();
+    s->seq.store(seq + 1, std::memory_order_release);
+    hdr_->write_seq.store(seq + 1, std::memory_order_release);
+}
+
+bool VideoRing::read(uint64_t seq, VideoRingAu& au, int timeout_ms) const {
+    if (!hdr_) return false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    for (int spins = 0;; ++spins) {
+        uint64_t head = hdr_->write_seq.load(std::memory_order_acquire);
+        if (seq < head) {
+            // Keep one slot of margin: the oldest one may be the writer's next victim
+            if (head - seq >= hdr_->slot_count) seq = head - hdr_->slot_count + 1;
+            VideoRingSlot* s = slot_at(seq);
+            if (s->seq.load(std::memory_order_acquire) != seq + 1) {
+                // Overwritten between the head load and here; retry from the new head
+                continue;
+            }
+            const uint8_t* base = reinterpret_cast<const uint8_t*>(s) + sizeof(VideoRingSlot);
+            au.seq = seq;
+            au.index = s->index;
+            au.pts_ns = s->pts_ns;
+            au.dts_ns = s->dts_ns;
+            au.duration_ns = s->duration_ns;
+            au.flags = s->flags;
+            au.size = static_cast<size_t>(std::min<uint64_t>(s->size, hdr_->slot_size));
+            au.meta = std::string_view(reinterpret_cast<const char*>(base),
+                                       std::min<uint32_t>(s->meta_len, hdr_->meta_size));
+            au.data = base + hdr_->meta_size;
+            au.publish_ns = s->publish_ns;
+            if (intact(au)) return true;
+            continue;
+        }
+        // AUs are due every few ms: spin briefly, then poll
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        if (spins < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+bool VideoRing::intact(const VideoRingAu& au) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return hdr_ && slot_at(au.seq)->seq.load(std::memory_order_relaxed) == au.seq + 1;
+}
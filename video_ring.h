@@ -0,0 +1,116 @@
+#pragma once
+
+// --shm-out: parsed access units for co-located consumers (graphics engine, replay), in
+// shared memory instead of re-reading the TS.
+//
+// The feeder's video probe (after h265parse) copies every AU, its PTS/DTS and the Redis
+// metadata JSON into the next slot of a named ring. There is one writer and any number
+// of readers, and readers never hold the writer up: slots are overwritten in order
+// whatever the readers are doing. A reader sees an AU in place (no copy) and confirms
+// afterwards, seqlock-style, that the slot was not reused under it; a reader that falls
+// more than slot_count AUs behind skips ahead and counts what it lost.
+//
+// Layout (all offsets 64-byte aligned, little-endian, same-host only):
+//   VideoRingHeader | slot 0: VideoRingSlot + meta[meta_size] + payload[slot_size] | slot 1 ...
+// Readers map the ring read-only.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "shm_mapping.h"
+
+static constexpr uint32_t VIDEO_RING_MAGIC = 0x474e5256;   // "VRNG"
+static constexpr uint32_t VIDEO_RING_VERSION = 1;
+
+// AU flags
+enum : uint32_t {
+    VIDEO_AU_DELTA = 1u << 0,     // not a keyframe
+};
+
+struct VideoRingHeader {
+    std::atomic<uint32_t> magic;         // written last by create()
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;                  // AU capacity per slot
+    uint32_t meta_size;                  // metadata capacity per slot
+    uint32_t reserved0;
+    uint64_t slot_stride;                // bytes from one slot header to the next
+    std::atomic<uint64_t> write_seq;     // AUs published so far
+    std::atomic<uint64_t> oversize;      // AUs not published because they exceed slot_size
+    uint8_t reserved[16];
+};
+
+struct VideoRingSlot {
+    std::atomic<uint64_t> seq;           // AU number + 1 once written, 0 while being written
+    uint64_t index;                      // frame index, as in frame_<camera>_<idx>.hevc
+    int64_t pts_ns;                      // running time, -1 = none
+    int64_t dts_ns;
+    int64_t duration_ns;
+    uint64_t size;                       // AU bytes
+    uint32_t flags;
+    uint32_t meta_len;                   // metadata bytes (Redis JSON, empty without Redis)
+    int64_t publish_ns;                  // steady clock when published (system-wide monotonic)
+    uint8_t reserved[64];
+};
+
+static_assert(sizeof(VideoRingHeader) == 64, "ring header is part of the shared layout");
+static_assert(sizeof(VideoRingSlot) == 128, "slot header is part of the shared layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring atomics must be address-free");
+
+// One AU as seen by a reader; data and meta point into the ring and are only
+// trustworthy while VideoRing::intact() says so
+struct VideoRingAu {
+    uint64_t seq = 0;
+    uint64_t index = 0;
+    int64_t pts_ns = -1;
+    int64_t dts_ns = -1;
+    int64_t duration_ns = -1;
+    uint32_t flags = 0;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::string_view meta;
+    int64_t publish_ns = 0;
+};
+
+class VideoRing {
+public:
+    VideoRing() = default;
+    ~VideoRing() { close(); }
+    VideoRing(const VideoRing&) = delete;
+    VideoRing& operator=(const VideoRing&) = delete;
+
+    // Writer: create (or recreate) the ring
+    bool create(const std::string& name, uint32_t slot_count, uint32_t slot_size, uint32_t meta_size = 1024);
+    // Reader: map an existing ring read-only
+    bool open(const std::string& name);
+    void close();
+    bool is_open() const { return hdr_ != nullptr; }
+
+    uint32_t slot_count() const { return hdr_ ? hdr_->slot_count : 0; }
+    uint32_t slot_size() const { return hdr_ ? hdr_->slot_size : 0; }
+    uint64_t published() const { return hdr_ ? hdr_->write_seq.load(std::memory_order_acquire) : 0; }
+    uint64_t oversize() const { return hdr_ ? hdr_->oversize.load(std::memory_order_relaxed) : 0; }
+
+    // Writer: payload area of the next slot, already marked as being written; nullptr
+    // (and counted) if size exceeds slot_size. Fill it, then commit(). Never waits.
+    uint8_t* reserve(size_t size);
+    // au.data is ignored (the payload is already in place); meta is cut to meta_size
+    void commit(const VideoRingAu& au, std::string_view meta);
+
+    // Reader: AU number seq, waiting up to timeout_ms for it to be published. If it was
+    // already overwritten, the oldest AU still in the ring is returned instead, and
+    // au.seq - seq AUs were lost.
+    bool read(uint64_t seq, VideoRingAu& au, int timeout_ms) const;
+    // Reader: true if au's slot still holds it, i.e. everything read from it is valid
+    bool intact(const VideoRingAu& au) const;
+
+private:
+    VideoRingSlot* slot_at(uint64_t seq) const;
+
+    ShmMapping shm_;
+    VideoRingHeader* hdr_ = nullptr;
+    bool writer_ = false;
+};